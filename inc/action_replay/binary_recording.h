@@ -0,0 +1,71 @@
+#ifndef ACTION_REPLAY_BINARY_RECORDING_H__
+# define ACTION_REPLAY_BINARY_RECORDING_H__
+
+# include <action_replay/return.h>
+# include <action_replay/stdbool.h>
+# include <action_replay/stddef.h>
+# include <action_replay/stdint.h>
+
+/*
+ * compact alternative to JSON recordings:
+ * header, NUL terminated device path padded to record alignment,
+ * then fixed-width records until end of file;
+ * fields are in host byte order, a reader of other byte order
+ * sees a foreign version and refuses the file
+ */
+
+# define ACTION_REPLAY_BINARY_RECORDING_MAGIC "\177ARREC\r\n"
+# define ACTION_REPLAY_BINARY_RECORDING_MAGIC_SIZE 8
+# define ACTION_REPLAY_BINARY_RECORDING_VERSION 1
+
+typedef struct
+{
+    char magic[ ACTION_REPLAY_BINARY_RECORDING_MAGIC_SIZE ];
+    uint32_t version;
+    uint32_t path_length; /* without NUL and padding */
+}
+action_replay_binary_recording_header_t;
+
+typedef struct
+{
+    uint64_t delay; /* nanoseconds since previous event */
+    uint16_t type;
+    uint16_t code;
+    int32_t value;
+}
+action_replay_binary_recording_record_t;
+
+typedef struct
+{
+# include <action_replay/return.interface>
+    char const * path;
+    action_replay_binary_recording_record_t const * records;
+    size_t count;
+}
+action_replay_binary_recording_return_t;
+
+/* offset of the first record for given path length */
+static inline size_t
+action_replay_binary_recording_records_offset( size_t const path_length )
+{
+    size_t const alignment = sizeof( action_replay_binary_recording_record_t );
+
+    return sizeof( action_replay_binary_recording_header_t )
+        + (( path_length + alignment ) / alignment ) * alignment;
+}
+
+/* only checks magic, so text recordings can be told apart */
+bool action_replay_binary_recording_is(
+    void const * const buffer,
+    size_t const buffer_length
+);
+/*
+ * validates the header of a recording mapped at suitably aligned buffer,
+ * trailing bytes of a partially written record are ignored
+ */
+action_replay_binary_recording_return_t action_replay_binary_recording_read(
+    void const * const buffer,
+    size_t const buffer_length
+);
+
+#endif /* ACTION_REPLAY_BINARY_RECORDING_H__ */
@@ -2,8 +2,14 @@
 # define ACTION_REPLAY_CLASS_H__
 
 # include <action_replay/args.h>
+# include <action_replay/pool.h>
 # include <action_replay/return.h>
 # include <action_replay/stddef.h>
+# include <action_replay/stdint.h>
+# include <opa_primitives.h>
+
+/* must be a power of two */
+# define ACTION_REPLAY_REFLECTION_CACHE_SIZE 128
 
 typedef action_replay_return_t
 ( * action_replay_constructor_t )(
@@ -31,6 +37,33 @@ typedef action_replay_reflector_return_t
     char const * const restrict type,
     char const * const restrict name
 );
+/*
+ * entries are keyed by addresses of type and name strings,
+ * which ACTION_REPLAY_DYNAMIC always passes as literals
+ */
+typedef struct {
+    OPA_ptr_t name;
+    char const * type;
+    size_t offset;
+} action_replay_reflection_cache_entry_t;
+typedef struct {
+    action_replay_reflection_cache_entry_t
+        entries[ ACTION_REPLAY_REFLECTION_CACHE_SIZE ];
+} action_replay_reflection_cache_t;
+/* classes get ids lazily, on first type check */
+# define ACTION_REPLAY_CLASS_LIMIT 64
+# define ACTION_REPLAY_CLASS_ANCESTRY_WORD_BITS 64
+typedef struct {
+    OPA_int_t id; /* 0 until registered, id + 1 afterwards */
+    /* bitset of ids of class itself and all its ancestors */
+    uint64_t ancestors[
+        ACTION_REPLAY_CLASS_LIMIT / ACTION_REPLAY_CLASS_ANCESTRY_WORD_BITS
+    ];
+} action_replay_class_t_ancestry_t;
+typedef struct {
+# include <action_replay/return.interface>
+    size_t id;
+} action_replay_class_t_id_return_t;
 typedef struct action_replay_class_t action_replay_class_t;
 typedef action_replay_class_t const *
 ( * action_replay_class_t_func_t )( void );
@@ -42,7 +75,11 @@ struct action_replay_class_t
     action_replay_destructor_t destructor;
     action_replay_copier_t copier;
     action_replay_reflector_t reflector;
+    action_replay_reflection_cache_t * reflection_cache;
     action_replay_class_t_func_t const * inheritance;
+    action_replay_class_t_ancestry_t * ancestry;
+    /* optional; objects are calloc'd when NULL */
+    action_replay_pool_t * pool;
 };
 
 action_replay_reflector_return_t
@@ -52,6 +89,15 @@ action_replay_class_t_generic_reflector_logic(
     action_replay_reflection_entry_t const * const restrict map,
     size_t const map_size
 );
+/* reflector lookup memoized in class' reflection_cache */
+action_replay_reflector_return_t action_replay_class_t_cached_reflector_logic(
+    action_replay_class_t const * const restrict _class,
+    char const * const restrict type,
+    char const * const restrict name
+);
+/* assigns id and fills ancestry, parents are registered first */
+action_replay_class_t_id_return_t
+action_replay_class_t_register( action_replay_class_t const * const _class );
 
 #endif /* ACTION_REPLAY_CLASS_H__ */
 
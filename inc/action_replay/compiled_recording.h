@@ -0,0 +1,69 @@
+#ifndef ACTION_REPLAY_COMPILED_RECORDING_H__
+# define ACTION_REPLAY_COMPILED_RECORDING_H__
+
+# include <action_replay/error.h>
+# include <action_replay/return.h>
+# include <action_replay/stddef.h>
+# include <action_replay/stdint.h>
+# include <sys/stat.h>
+
+/*
+ * JSON recording compiled ahead of replay into a sidecar file,
+ * path of the recording followed by suffix below:
+ * header identifying the source, then a binary recording of its events;
+ * source is identified by size and mtime, or by hash if only mtime
+ * differs, e.g. after a fresh checkout; the header then takes the new
+ * mtime, so the source is hashed once
+ */
+
+# define ACTION_REPLAY_COMPILED_RECORDING_SUFFIX ".compiled"
+# define ACTION_REPLAY_COMPILED_RECORDING_MAGIC "\177ARCMP\r\n"
+# define ACTION_REPLAY_COMPILED_RECORDING_MAGIC_SIZE 8
+# define ACTION_REPLAY_COMPILED_RECORDING_VERSION 1
+
+typedef struct
+{
+    char magic[ ACTION_REPLAY_COMPILED_RECORDING_MAGIC_SIZE ];
+    uint32_t version;
+    uint32_t reserved; /* keeps binary recording aligned */
+    uint64_t source_size;
+    int64_t source_mtime_seconds;
+    int64_t source_mtime_nanoseconds;
+    uint64_t source_hash; /* FNV-1a of whole source */
+}
+action_replay_compiled_recording_header_t;
+
+typedef struct
+{
+# include <action_replay/return.interface>
+    void const * mapping; /* whole sidecar, munmap() it */
+    size_t mapping_length;
+    void const * recording; /* binary recording after header */
+    size_t recording_length;
+}
+action_replay_compiled_recording_return_t;
+
+/* ENOENT without sidecar, ESTALE if it's not compiled from source */
+action_replay_compiled_recording_return_t
+action_replay_compiled_recording_open(
+    char const * const restrict path_to_recording,
+    struct stat const * const restrict source_stat,
+    void const * const restrict source,
+    size_t const source_length
+);
+/*
+ * parses mapped source a chunk at a time and replaces its sidecar
+ * with a new one
+ */
+action_replay_error_t action_replay_compiled_recording_write(
+    char const * const restrict path_to_recording,
+    struct stat const * const restrict source_stat,
+    void const * const restrict source,
+    size_t const source_length
+);
+/* maps recording and writes its sidecar, EINVAL if it's binary already */
+action_replay_error_t action_replay_compiled_recording_compile(
+    char const * const path_to_recording
+);
+
+#endif /* ACTION_REPLAY_COMPILED_RECORDING_H__ */
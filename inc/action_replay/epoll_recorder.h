@@ -0,0 +1,49 @@
+#ifndef ACTION_REPLAY_EPOLL_RECORDER_H__
+# define ACTION_REPLAY_EPOLL_RECORDER_H__
+
+# include <action_replay/args.h>
+# include <action_replay/class.h>
+# include <action_replay/class_preparation.h>
+# include <action_replay/object.h>
+# include <action_replay/recorder_io.h>
+# include <action_replay/return.h>
+# include <action_replay/stateful_object.h>
+# include <action_replay/stddef.h>
+# include <action_replay/stdint.h>
+# include <action_replay/stoppable.h>
+# include <action_replay/time.h>
+
+/*
+ * records any number of devices on a single thread,
+ * each one into its own output file, same as recorder_t;
+ * a device failing is closed and the rest keep recording
+ */
+ACTION_REPLAY_CLASS_DECLARATION( action_replay_epoll_recorder_t );
+typedef struct action_replay_epoll_recorder_t_state_t
+    action_replay_epoll_recorder_t_state_t;
+
+# include <action_replay/epoll_recorder.class>
+
+/* totals since creation, read while recorder is stopped */
+typedef struct {
+# include <action_replay/return.interface>
+    uint64_t waits; /* epoll_wait() calls */
+} action_replay_epoll_recorder_t_stats_return_t;
+
+action_replay_args_t action_replay_epoll_recorder_t_start_state(
+    action_replay_time_t const * const zero_time
+);
+action_replay_class_t const * action_replay_epoll_recorder_t_class( void );
+/* i-th input device is recorded into i-th output */
+action_replay_args_t action_replay_epoll_recorder_t_args(
+    size_t const count,
+    char const * const * const restrict paths_to_input_devices,
+    char const * const * const restrict paths_to_outputs,
+    action_replay_recorder_io_format_t const format
+);
+action_replay_epoll_recorder_t_stats_return_t
+action_replay_epoll_recorder_t_stats(
+    action_replay_epoll_recorder_t * const recorder
+);
+
+#endif /* ACTION_REPLAY_EPOLL_RECORDER_H__ */
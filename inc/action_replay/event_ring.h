@@ -0,0 +1,71 @@
+#ifndef ACTION_REPLAY_EVENT_RING_H__
+# define ACTION_REPLAY_EVENT_RING_H__
+
+# include <action_replay/error.h>
+# include <action_replay/return.h>
+# include <action_replay/stdbool.h>
+# include <action_replay/stddef.h>
+# include <action_replay/stdint.h>
+# include <linux/input.h>
+# include <opa_primitives.h>
+# include <pthread.h>
+
+/*
+ * bounded single producer, single consumer queue of input events;
+ * push and pop don't lock, only a consumer going to sleep on empty ring
+ * makes the producer take the mutex to wake it up
+ */
+typedef struct {
+    struct input_event * events;
+    int size; /* capacity + 1, one slot is always left empty */
+    OPA_int_t head; /* next to pop, moved by consumer */
+    OPA_int_t tail; /* next to push, moved by producer */
+    OPA_int_t sleeping;
+    OPA_int_t closed;
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+    /* producer's, read once both sides are stopped */
+    uint64_t pushed;
+    uint64_t dropped;
+    uint64_t high_water_mark;
+    uint64_t wakes; /* of a consumer found sleeping */
+    /* consumer's, read once both sides are stopped */
+    uint64_t sleeps; /* waits which found the ring empty */
+} action_replay_event_ring_t;
+
+action_replay_return_t action_replay_event_ring_t_init(
+    action_replay_event_ring_t * const ring,
+    size_t const capacity
+);
+action_replay_return_t
+action_replay_event_ring_t_destroy( action_replay_event_ring_t * const ring );
+/* producer; events which don't fit are dropped, returns count pushed */
+size_t action_replay_event_ring_t_push(
+    action_replay_event_ring_t * const restrict ring,
+    struct input_event const * const restrict events,
+    size_t const count
+);
+/* producer; no pushes after it, consumer is woken up */
+void action_replay_event_ring_t_close( action_replay_event_ring_t * const ring );
+/* consumer; returns count of events moved to buffer */
+size_t action_replay_event_ring_t_pop(
+    action_replay_event_ring_t * const restrict ring,
+    struct input_event * const restrict buffer,
+    size_t const max_count
+);
+/* consumer; every push is visible to pops once this returns true */
+bool action_replay_event_ring_t_is_closed(
+    action_replay_event_ring_t * const ring
+);
+/*
+ * consumer; sleeps while the ring is empty and open,
+ * negative timeout waits without limit, ETIMEDOUT if it ran out
+ */
+action_replay_error_t action_replay_event_ring_t_wait(
+    action_replay_event_ring_t * const ring,
+    int const timeout_milliseconds
+);
+/* only while neither side runs; empties and reopens the ring */
+void action_replay_event_ring_t_reset( action_replay_event_ring_t * const ring );
+
+#endif /* ACTION_REPLAY_EVENT_RING_H__ */
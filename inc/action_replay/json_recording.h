@@ -0,0 +1,90 @@
+#ifndef ACTION_REPLAY_JSON_RECORDING_H__
+# define ACTION_REPLAY_JSON_RECORDING_H__
+
+# include <action_replay/binary_recording.h>
+# include <action_replay/return.h>
+# include <action_replay/stddef.h>
+# include <action_replay/stdint.h>
+
+/*
+ * JSON recordings: optional comment lines starting with '#', header
+ * { "file": "<path>" }
+ * and event lines
+ * { "time": <num>, "type": <num>, "code": <num>, "value": <num> }
+ */
+
+typedef struct
+{
+# include <action_replay/return.interface>
+    uint64_t delay; /* nanoseconds since previous event */
+    uint16_t type;
+    uint16_t code;
+    int32_t value;
+}
+action_replay_json_recording_return_t;
+
+typedef struct
+{
+# include <action_replay/return.interface>
+    char * path; /* of replayed device, free() it */
+    size_t events_offset; /* first line after header and comments */
+}
+action_replay_json_recording_header_return_t;
+
+typedef struct
+{
+# include <action_replay/return.interface>
+    action_replay_binary_recording_record_t * records; /* free() them */
+    size_t count;
+}
+action_replay_json_recording_lines_return_t;
+
+typedef struct
+{
+# include <action_replay/return.interface>
+    size_t count; /* of records filled */
+    size_t length; /* of buffer parsed, whole lines */
+}
+action_replay_json_recording_chunk_return_t;
+
+/*
+ * line as written by recorder is matched directly, anything else
+ * (other spacing, key order, out of range numbers) goes through jsmn;
+ * trailing newline is allowed, EINVAL if line isn't an event
+ */
+action_replay_json_recording_return_t action_replay_json_recording_parse_line(
+    char const * const buffer,
+    size_t const buffer_length
+);
+/* jsmn only, same results */
+action_replay_json_recording_return_t
+action_replay_json_recording_parse_line_generic(
+    char const * const buffer,
+    size_t const buffer_length
+);
+
+/* path is NULL on failure */
+action_replay_json_recording_header_return_t
+action_replay_json_recording_parse_header(
+    char const * const buffer,
+    size_t const buffer_length
+);
+/*
+ * parses event lines of buffer, which must start at a line, until
+ * either buffer or records run out; comment lines are skipped
+ */
+action_replay_json_recording_chunk_return_t
+action_replay_json_recording_parse_chunk(
+    char const * const restrict buffer,
+    size_t const buffer_length,
+    action_replay_binary_recording_record_t * const restrict records,
+    size_t const records_capacity
+);
+/* parses every event line of buffer, records are NULL on failure */
+action_replay_json_recording_lines_return_t
+action_replay_json_recording_parse_lines(
+    char const * const buffer,
+    size_t const buffer_length
+);
+
+#endif /* ACTION_REPLAY_JSON_RECORDING_H__ */
@@ -0,0 +1,55 @@
+#ifndef ACTION_REPLAY_LINE_SCAN_H__
+# define ACTION_REPLAY_LINE_SCAN_H__
+
+# include <action_replay/error.h>
+# include <action_replay/stdbool.h>
+# include <action_replay/stddef.h>
+
+/*
+ * splits text recordings into lines, many bytes at a time;
+ * best implementation for running CPU is picked on first use
+ */
+
+# define ACTION_REPLAY_LINE_SCAN_COMMENT_SYMBOL '#'
+
+typedef enum
+{
+    ACTION_REPLAY_LINE_SCAN_SCALAR, /* byte by byte */
+    ACTION_REPLAY_LINE_SCAN_SWAR, /* 8 bytes in a 64-bit word */
+    ACTION_REPLAY_LINE_SCAN_SSE2,
+    ACTION_REPLAY_LINE_SCAN_AVX2,
+    ACTION_REPLAY_LINE_SCAN_IMPLEMENTATIONS_COUNT
+}
+action_replay_line_scan_implementation_t;
+
+typedef struct
+{
+    char const * start;
+    size_t length; /* with newline, last line of buffer may have none */
+    bool comment;
+}
+action_replay_line_scan_line_t;
+
+/* ENOTSUP if CPU or compiler can't run it */
+action_replay_error_t action_replay_line_scan_use(
+    action_replay_line_scan_implementation_t const implementation
+);
+action_replay_line_scan_implementation_t
+action_replay_line_scan_implementation( void );
+char const * action_replay_line_scan_implementation_name(
+    action_replay_line_scan_implementation_t const implementation
+);
+/* offset of first newline, buffer_length if there's none */
+size_t action_replay_line_scan_newline(
+    char const * const buffer,
+    size_t const buffer_length
+);
+/* returns count of lines split from start of buffer, at most max_count */
+size_t action_replay_line_scan_lines(
+    char const * const restrict buffer,
+    size_t const buffer_length,
+    action_replay_line_scan_line_t * const restrict lines,
+    size_t const max_count
+);
+
+#endif /* ACTION_REPLAY_LINE_SCAN_H__ */
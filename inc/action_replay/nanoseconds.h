@@ -0,0 +1,119 @@
+#ifndef ACTION_REPLAY_NANOSECONDS_H__
+# define ACTION_REPLAY_NANOSECONDS_H__
+
+# include <action_replay/return.h>
+# include <action_replay/stdint.h>
+# include <errno.h>
+# if HAVE_SYS_TIME_H
+#  include <sys/time.h>
+# endif /* HAVE_SYS_TIME_H */
+# if HAVE_TIME_H
+#  include <time.h>
+# endif /* HAVE_TIME_H */
+
+/*
+ * value API over plain nanosecond counts, for paths which can't afford
+ * creating objects; action_replay_time_t is built on top of it
+ */
+
+# define ACTION_REPLAY_NANOSECONDS_IN_MICROSECOND 1000
+# define ACTION_REPLAY_NANOSECONDS_IN_SECOND 1000000000
+
+typedef struct
+{
+# include <action_replay/return.interface>
+    uint64_t value;
+}
+action_replay_nanoseconds_return_t;
+
+/* 0 if no clock is available */
+uint64_t action_replay_nanoseconds_now( void );
+/* for deadlines; falls back to now() if there's no monotonic clock */
+uint64_t action_replay_nanoseconds_monotonic_now( void );
+/*
+ * sleeps until monotonic_now() reaches deadline, waking up early
+ * only on error; returns at once for deadlines in the past
+ */
+action_replay_error_t
+action_replay_nanoseconds_sleep_until( uint64_t const deadline );
+/*
+ * sleeps until spin_margin before deadline, then busy-polls the clock;
+ * trades CPU time for not depending on timer slack and wakeup latency
+ */
+action_replay_error_t action_replay_nanoseconds_spin_until(
+    uint64_t const deadline,
+    uint64_t const spin_margin
+);
+
+/* on overflow value saturates at UINT64_MAX and status is E2BIG */
+static inline action_replay_nanoseconds_return_t action_replay_nanoseconds_add(
+    uint64_t const augend,
+    uint64_t const addend
+)
+{
+    if(( UINT64_MAX - addend ) < augend )
+    {
+        return ( action_replay_nanoseconds_return_t const )
+        { E2BIG, UINT64_MAX };
+    }
+
+    return ( action_replay_nanoseconds_return_t const )
+    { 0, augend + addend };
+}
+
+/* on underflow value saturates at 0 and status is E2BIG */
+static inline action_replay_nanoseconds_return_t action_replay_nanoseconds_sub(
+    uint64_t const minuend,
+    uint64_t const subtrahend
+)
+{
+    if( subtrahend > minuend )
+    { return ( action_replay_nanoseconds_return_t const ) { E2BIG, 0 }; }
+
+    return ( action_replay_nanoseconds_return_t const )
+    { 0, minuend - subtrahend };
+}
+
+# if HAVE_TIME_H
+static inline uint64_t
+action_replay_nanoseconds_from_timespec( struct timespec const value )
+{
+    return (( uint64_t ) value.tv_sec ) * ACTION_REPLAY_NANOSECONDS_IN_SECOND
+        + (( uint64_t ) value.tv_nsec );
+}
+
+static inline struct timespec
+action_replay_nanoseconds_to_timespec( uint64_t const value )
+{
+    return ( struct timespec const )
+    {
+        ( time_t ) ( value / ACTION_REPLAY_NANOSECONDS_IN_SECOND ),
+        ( long ) ( value % ACTION_REPLAY_NANOSECONDS_IN_SECOND )
+    };
+}
+# endif /* HAVE_TIME_H */
+
+# if HAVE_SYS_TIME_H
+static inline uint64_t
+action_replay_nanoseconds_from_timeval( struct timeval const value )
+{
+    return (( uint64_t ) value.tv_sec ) * ACTION_REPLAY_NANOSECONDS_IN_SECOND
+        + (( uint64_t ) value.tv_usec )
+        * ACTION_REPLAY_NANOSECONDS_IN_MICROSECOND;
+}
+
+static inline struct timeval
+action_replay_nanoseconds_to_timeval( uint64_t const value )
+{
+    return ( struct timeval const )
+    {
+        ( time_t ) ( value / ACTION_REPLAY_NANOSECONDS_IN_SECOND ),
+        ( suseconds_t ) (
+            ( value % ACTION_REPLAY_NANOSECONDS_IN_SECOND )
+            / ACTION_REPLAY_NANOSECONDS_IN_MICROSECOND
+        )
+    };
+}
+# endif /* HAVE_SYS_TIME_H */
+
+#endif /* ACTION_REPLAY_NANOSECONDS_H__ */
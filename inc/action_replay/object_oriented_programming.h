@@ -7,6 +7,7 @@
 # include <action_replay/error.h>
 # include <action_replay/macros.h>
 # include <action_replay/object.h>
+# include <action_replay/pool.h>
 # include <action_replay/stdbool.h>
 # include <action_replay/stdint.h>
 
@@ -21,7 +22,10 @@ bool action_replay_is_type(
     action_replay_object_t const * const restrict object,
     action_replay_class_t const * const restrict _class
 );
-/* use via macro below */
+/* EINVAL for classes which don't allocate from a pool */
+action_replay_pool_t_stats_return_t
+action_replay_allocation_stats( action_replay_class_t const * const _class );
+/* use via macro below; type and name are cached by address */
 void const * action_replay_dynamic_get(
     char const * const restrict type,
     char const * const restrict name,
@@ -7,6 +7,8 @@
 # include <action_replay/object.h>
 # include <action_replay/return.h>
 # include <action_replay/stateful_object.h>
+# include <action_replay/stdbool.h>
+# include <action_replay/stdint.h>
 # include <action_replay/stoppable.h>
 # include <action_replay/time.h>
 
@@ -18,12 +20,30 @@ typedef action_replay_return_t ( * action_replay_player_t_join_func_t )(
 
 # include <action_replay/player.class>
 
+/*
+ * spin_margin: 0 sleeps until each deadline, else sleeps until
+ * that many nanoseconds before it and busy-polls the clock after;
+ * timer_slack: ask for 1 ns timer slack in the thread writing events;
+ * parse_threads: text recordings are split at line boundaries into
+ * parts of at least a MiB, parsed on up to that many threads,
+ * 0 uses one per online CPU, 1 parses on player's thread only
+ */
 action_replay_args_t action_replay_player_t_start_state(
-    action_replay_time_t const * const zero_time
+    action_replay_time_t const * const zero_time,
+    uint64_t const spin_margin,
+    bool const timer_slack,
+    unsigned int const parse_threads
 );
 action_replay_class_t const * action_replay_player_t_class( void );
-action_replay_args_t
-action_replay_player_t_args( char const * const path_to_input );
+/*
+ * uinput: replay into a virtual device created for each replay,
+ * which reports the event types and codes found in the recording,
+ * instead of writing to the device path saved in it
+ */
+action_replay_args_t action_replay_player_t_args(
+    char const * const path_to_input,
+    bool const uinput
+);
 
 #endif /* ACTION_REPLAY_PLAYER_H__ */
 
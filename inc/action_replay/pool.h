@@ -0,0 +1,59 @@
+#ifndef ACTION_REPLAY_POOL_H__
+# define ACTION_REPLAY_POOL_H__
+
+# include <action_replay/return.h>
+# include <action_replay/stddef.h>
+# include <action_replay/stdint.h>
+# include <opa_primitives.h>
+# include <pthread.h>
+
+/*
+ * free-list allocator of fixed size blocks; each thread keeps its own
+ * cache of free blocks and touches the shared list only in batches
+ */
+typedef struct {
+    size_t size;
+    pthread_mutex_t mutex;
+    OPA_int_t key_state;
+    pthread_key_t key;
+    void * free_list;
+    size_t free_count;
+    uint64_t allocations;
+    uint64_t recycled;
+    uint64_t releases;
+} action_replay_pool_t;
+
+/* for static pools; pools are never destroyed, key is created on first use */
+# define ACTION_REPLAY_POOL_T_INITIALIZER( block_size ) \
+    { \
+        .size = ( block_size ), \
+        .mutex = PTHREAD_MUTEX_INITIALIZER, \
+        .key_state = OPA_INT_T_INITIALIZER( 0 ), \
+        .free_list = NULL, \
+        .free_count = 0, \
+        .allocations = 0, \
+        .recycled = 0, \
+        .releases = 0 \
+    }
+
+typedef struct {
+# include <action_replay/return.interface>
+    uint64_t allocations; /* blocks handed out */
+    uint64_t recycled; /* part of allocations served from free lists */
+    uint64_t releases; /* blocks given back */
+} action_replay_pool_t_stats_return_t;
+
+/* zeroed block of pool's size, NULL on failure */
+void * action_replay_pool_t_alloc( action_replay_pool_t * const pool );
+void action_replay_pool_t_free(
+    action_replay_pool_t * const restrict pool,
+    void * const restrict block
+);
+/*
+ * other threads' counters are included once they flush them,
+ * which happens at least every few hundred operations and at thread exit
+ */
+action_replay_pool_t_stats_return_t
+action_replay_pool_t_stats( action_replay_pool_t * const pool );
+
+#endif /* ACTION_REPLAY_POOL_H__ */
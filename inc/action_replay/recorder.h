@@ -5,8 +5,11 @@
 # include <action_replay/class.h>
 # include <action_replay/class_preparation.h>
 # include <action_replay/object.h>
+# include <action_replay/recorder_io.h>
 # include <action_replay/return.h>
 # include <action_replay/stateful_object.h>
+# include <action_replay/stddef.h>
+# include <action_replay/stdint.h>
 # include <action_replay/stoppable.h>
 # include <action_replay/time.h>
 
@@ -16,14 +19,41 @@ typedef struct action_replay_recorder_t_state_t
 
 # include <action_replay/recorder.class>
 
+typedef enum
+{
+    ACTION_REPLAY_RECORDER_T_POLL,
+    /* falls back to poll if kernel doesn't provide io_uring */
+    ACTION_REPLAY_RECORDER_T_IO_URING
+}
+action_replay_recorder_t_backend_t;
+
+/* events buffered between capture and writer threads by default */
+# define ACTION_REPLAY_RECORDER_T_RING_CAPACITY 4096
+
+/*
+ * waits for input or for each other, which read and write syscall
+ * counts miss; totals since creation, read while recorder is stopped
+ */
+typedef struct {
+# include <action_replay/return.interface>
+    uint64_t waits; /* capturing thread's poll() or io_uring_enter() calls */
+    uint64_t writer_sleeps; /* writer thread's waits on an empty ring */
+    uint64_t writer_wakes; /* capturing thread waking writer thread up */
+} action_replay_recorder_t_stats_return_t;
+
 action_replay_args_t action_replay_recorder_t_start_state(
     action_replay_time_t const * const zero_time
 );
 action_replay_class_t const * action_replay_recorder_t_class( void );
 action_replay_args_t action_replay_recorder_t_args(
     char const * const restrict path_to_input_device,
-    char const * const restrict path_to_output
+    char const * const restrict path_to_output,
+    action_replay_recorder_io_format_t const format,
+    size_t const ring_capacity, /* 0 writes on the capturing thread */
+    action_replay_recorder_t_backend_t const backend
 );
+action_replay_recorder_t_stats_return_t
+action_replay_recorder_t_stats( action_replay_recorder_t * const recorder );
 
 #endif /* ACTION_REPLAY_RECORDER_H__ */
 
@@ -0,0 +1,91 @@
+#ifndef ACTION_REPLAY_RECORDER_IO_H__
+# define ACTION_REPLAY_RECORDER_IO_H__
+
+# include <action_replay/error.h>
+# include <action_replay/return.h>
+# include <action_replay/stdbool.h>
+# include <action_replay/stddef.h>
+# include <action_replay/stdint.h>
+# include <linux/input.h>
+
+/* shared by recorder engines */
+
+typedef enum
+{
+    ACTION_REPLAY_RECORDER_IO_JSON, /* human-readable, one event per line */
+    ACTION_REPLAY_RECORDER_IO_BINARY /* see binary_recording.h */
+}
+action_replay_recorder_io_format_t;
+
+/* whole SYN frames of high-rate devices usually fit */
+# define ACTION_REPLAY_RECORDER_IO_EVENTS_PER_READ 64
+# define ACTION_REPLAY_RECORDER_IO_BUFFER_SIZE 65536
+/* longest entry: 20 digit time, 5 digit type and code, signed value */
+# define ACTION_REPLAY_RECORDER_IO_EVENT_MAX_LEN 128
+/* milliseconds without input after which buffered events are flushed */
+# define ACTION_REPLAY_RECORDER_IO_FLUSH_TIMEOUT 100
+# define ACTION_REPLAY_RECORDER_IO_INFINITE_WAIT -1
+
+/*
+ * output of a single recording, bypasses stdio,
+ * so no format parsing or locking per event
+ */
+typedef struct
+{
+    int fd;
+    action_replay_recorder_io_format_t format;
+    size_t length;
+    char buffer[ ACTION_REPLAY_RECORDER_IO_BUFFER_SIZE ];
+}
+action_replay_recorder_io_writer_t;
+
+typedef struct
+{
+# include <action_replay/return.interface>
+    size_t count;
+}
+action_replay_recorder_io_read_return_t;
+
+/* reads at least one, at most max_count whole events */
+action_replay_recorder_io_read_return_t action_replay_recorder_io_read(
+    int const fd,
+    struct input_event * const buf,
+    size_t const max_count
+);
+void action_replay_recorder_io_writer_init(
+    action_replay_recorder_io_writer_t * const writer,
+    int const fd,
+    action_replay_recorder_io_format_t const format
+);
+action_replay_error_t action_replay_recorder_io_writer_flush(
+    action_replay_recorder_io_writer_t * const writer
+);
+/* raw bytes, e.g. records already in binary format */
+action_replay_error_t action_replay_recorder_io_writer_append(
+    action_replay_recorder_io_writer_t * const restrict writer,
+    void const * const restrict data,
+    size_t const length
+);
+
+/* poll timeout which lets idle writer flush */
+static inline int action_replay_recorder_io_writer_timeout(
+    action_replay_recorder_io_writer_t const * const writer
+)
+{
+    return ( 0 == writer->length )
+        ? ACTION_REPLAY_RECORDER_IO_INFINITE_WAIT
+        : ACTION_REPLAY_RECORDER_IO_FLUSH_TIMEOUT;
+}
+
+action_replay_error_t action_replay_recorder_io_write_header(
+    char const * const restrict path_to_input_device,
+    action_replay_recorder_io_writer_t * const restrict writer
+);
+/* writes time passed since zero_time, then moves zero_time to event */
+action_replay_error_t action_replay_recorder_io_write_event(
+    struct input_event const event,
+    uint64_t * const restrict zero_time,
+    action_replay_recorder_io_writer_t * const restrict writer
+);
+
+#endif /* ACTION_REPLAY_RECORDER_IO_H__ */
@@ -0,0 +1,52 @@
+#ifndef ACTION_REPLAY_UINPUT_H__
+# define ACTION_REPLAY_UINPUT_H__
+
+# include <action_replay/error.h>
+# include <action_replay/return.h>
+# include <action_replay/stdbool.h>
+# include <action_replay/stdint.h>
+# include <linux/input.h>
+
+/*
+ * virtual input devices, which replay events without real hardware;
+ * what a device reports is gathered from recorded events beforehand,
+ * absolute axes get the range of values seen for them
+ */
+
+# define ACTION_REPLAY_UINPUT_CODE_BYTES (( KEY_CNT + 7 ) / 8 )
+
+typedef struct {
+    /* bit per code, for each event type */
+    uint8_t codes[ EV_CNT ][ ACTION_REPLAY_UINPUT_CODE_BYTES ];
+    bool types[ EV_CNT ];
+    int32_t abs_min[ ABS_CNT ];
+    int32_t abs_max[ ABS_CNT ];
+    uint64_t ignored; /* events of unknown types or codes */
+} action_replay_uinput_capabilities_t;
+
+typedef struct
+{
+# include <action_replay/return.interface>
+    int fd; /* events are written to it as to evdev nodes, close() it */
+}
+action_replay_uinput_return_t;
+
+void action_replay_uinput_capabilities_init(
+    action_replay_uinput_capabilities_t * const capabilities
+);
+void action_replay_uinput_capabilities_add(
+    action_replay_uinput_capabilities_t * const capabilities,
+    uint16_t const type,
+    uint16_t const code,
+    int32_t const value
+);
+/*
+ * device exists until fd is closed, so readers can open its node
+ * before events are written; ENOSYS without uinput support
+ */
+action_replay_uinput_return_t action_replay_uinput_create(
+    char const * const restrict name,
+    action_replay_uinput_capabilities_t const * const restrict capabilities
+);
+
+#endif /* ACTION_REPLAY_UINPUT_H__ */
@@ -0,0 +1,92 @@
+#ifndef ACTION_REPLAY_URING_H__
+# define ACTION_REPLAY_URING_H__
+
+# include <action_replay/error.h>
+# include <action_replay/return.h>
+# include <action_replay/stddef.h>
+# include <action_replay/stdint.h>
+
+/*
+ * minimal io_uring over raw syscalls, single threaded use only;
+ * operations are queued and handed to the kernel by the next
+ * submit_and_wait, along with waiting for their completions
+ */
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+typedef struct {
+    int fd;
+    /* indices shared with kernel */
+    unsigned int * sq_head;
+    unsigned int * sq_tail;
+    unsigned int * sq_array;
+    unsigned int * cq_head;
+    unsigned int * cq_tail;
+    unsigned int sq_mask;
+    unsigned int sq_entries;
+    unsigned int cq_mask;
+    unsigned int queued; /* not yet published to kernel */
+    struct io_uring_sqe * sqes;
+    struct io_uring_cqe * cqes;
+    void * sq_ring;
+    size_t sq_ring_size;
+    void * cq_ring; /* same as sq_ring if kernel maps both at once */
+    size_t cq_ring_size;
+    size_t sqes_size;
+    /* kernel reads it on submission, so one timeout per submit */
+    struct { int64_t tv_sec; long long int tv_nsec; } timeout;
+    uint64_t enters;
+} action_replay_uring_t;
+
+typedef struct
+{
+# include <action_replay/return.interface>
+    uint64_t user_data;
+    int32_t result; /* negative errno on failure */
+}
+action_replay_uring_t_completion_return_t;
+
+/* ENOSYS or EPERM if kernel doesn't allow io_uring */
+action_replay_return_t action_replay_uring_t_init(
+    action_replay_uring_t * const uring,
+    unsigned int const entries
+);
+action_replay_return_t
+action_replay_uring_t_destroy( action_replay_uring_t * const uring );
+/* EBUSY if submission queue is full; buffer must outlive completion */
+action_replay_error_t action_replay_uring_t_read(
+    action_replay_uring_t * const restrict uring,
+    int const fd,
+    void * const restrict buffer,
+    size_t const length,
+    uint64_t const user_data
+);
+/* at current file position, like write() */
+action_replay_error_t action_replay_uring_t_write(
+    action_replay_uring_t * const restrict uring,
+    int const fd,
+    void const * const restrict buffer,
+    size_t const length,
+    uint64_t const user_data
+);
+/* completes with -ETIME once it expires */
+action_replay_error_t action_replay_uring_t_timeout(
+    action_replay_uring_t * const uring,
+    int const timeout_milliseconds,
+    uint64_t const user_data
+);
+/* target completes with -ECANCELED unless it was already done */
+action_replay_error_t action_replay_uring_t_cancel(
+    action_replay_uring_t * const uring,
+    uint64_t const target_user_data,
+    uint64_t const user_data
+);
+/* one syscall; doesn't wait if completions are already there */
+action_replay_error_t
+action_replay_uring_t_submit_and_wait( action_replay_uring_t * const uring );
+/* EAGAIN if there are no completions left */
+action_replay_uring_t_completion_return_t
+action_replay_uring_t_pop( action_replay_uring_t * const uring );
+
+#endif /* ACTION_REPLAY_URING_H__ */
@@ -6,6 +6,8 @@
 # include <action_replay/class_preparation.h>
 # include <action_replay/object.h>
 # include <action_replay/return.h>
+# include <action_replay/stddef.h>
+# include <opa_queue.h>
 
 ACTION_REPLAY_CLASS_DECLARATION( action_replay_workqueue_t );
 typedef struct action_replay_workqueue_t_state_t
@@ -23,10 +25,81 @@ typedef action_replay_return_t
     void * const state
 );
 
+/*
+ * queued work, put_item() and put_many_items() queue ones owned by
+ * caller, usually kept in payload's state; one can be put again once
+ * its payload started, or once queue was stopped or joined, and right
+ * away with a ring or a pool, which copy payload and state
+ */
+typedef struct {
+    OPA_Queue_element_hdr_t header;
+    action_replay_workqueue_t_work_func_t payload;
+    void * state;
+    void * allocation; /* freed by queue once item is dequeued */
+} action_replay_workqueue_t_item_t;
+
+typedef action_replay_return_t
+( * action_replay_workqueue_t_put_item_func_t )(
+    action_replay_workqueue_t * const self,
+    action_replay_workqueue_t_item_t * const item,
+    action_replay_workqueue_t_work_func_t const payload,
+    void * const state
+);
+/* count items, one per state, all with the same payload; one wakeup */
+typedef action_replay_return_t
+( * action_replay_workqueue_t_put_many_func_t )(
+    action_replay_workqueue_t * const self,
+    action_replay_workqueue_t_work_func_t const payload,
+    void * const * const states,
+    size_t const count
+);
+/* put_many() into count consecutive items of caller, no allocation */
+typedef action_replay_return_t
+( * action_replay_workqueue_t_put_many_items_func_t )(
+    action_replay_workqueue_t * const self,
+    action_replay_workqueue_t_item_t * const items,
+    action_replay_workqueue_t_work_func_t const payload,
+    void * const * const states,
+    size_t const count
+);
+/* items put with the same key run one at a time, in order they were put */
+typedef action_replay_return_t
+( * action_replay_workqueue_t_put_ordered_func_t )(
+    action_replay_workqueue_t * const self,
+    size_t const key,
+    action_replay_workqueue_t_work_func_t const payload,
+    void * const state
+);
+
 # include <action_replay/workqueue.class>
 
+typedef enum
+{
+    /* any number of threads may put */
+    ACTION_REPLAY_WORKQUEUE_T_LOCKED,
+    /*
+     * bounded lock-free ring, all puts from one thread at a time;
+     * put waits while it's full and processing thread runs
+     */
+    ACTION_REPLAY_WORKQUEUE_T_SPSC,
+    /*
+     * threads with a deque each, idle ones steal from the others;
+     * items run in no particular order, except for put_ordered(),
+     * whose items of one key all run on the same thread
+     */
+    ACTION_REPLAY_WORKQUEUE_T_POOL
+}
+action_replay_workqueue_t_backend_t;
+
+/* items a ring holds by default */
+# define ACTION_REPLAY_WORKQUEUE_T_RING_CAPACITY 4096
+
 action_replay_class_t const * action_replay_workqueue_t_class( void );
-action_replay_args_t action_replay_workqueue_t_args( void );
+action_replay_args_t action_replay_workqueue_t_args(
+    action_replay_workqueue_t_backend_t const backend,
+    size_t const ring_capacity, /* ignored unless backend has a ring */
+    unsigned int const threads /* pool's, 0 is one per online CPU */
+);
 
 #endif /* ACTION_REPLAY_WORKER_H__ */
 
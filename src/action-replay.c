@@ -1,12 +1,20 @@
-#define _POSIX_C_SOURCE 1 /* sigaction */
+#define _POSIX_C_SOURCE 200809L /* sigaction, struct timespec */
 
+#include "action_replay/compiled_recording.h"
+#include "action_replay/epoll_recorder.h"
+#include "action_replay/inttypes.h"
+#include "action_replay/limits.h"
 #include "action_replay/log.h"
+#include "action_replay/nanoseconds.h"
 #include "action_replay/object_oriented_programming.h"
 #include "action_replay/player.h"
 #include "action_replay/recorder.h"
 #include "action_replay/stdbool.h"
 #include "action_replay/stddef.h"
+#include "action_replay/stdint.h"
 #include "action_replay/time.h"
+#include "action_replay/time_converter.h"
+#include <errno.h>
 #include <opa_primitives.h>
 #include <signal.h>
 #include <stdio.h>
@@ -31,21 +39,53 @@ static inline void print_debug_options( void )
 static inline void print_record_options( void )
 {
     puts(
-        "\trecord [-t num] <-io /dev/input/event1 /path/to/output/file1>\n"
+        "\trecord [-t num] [-e] [-u] [-b] [-r num]\n"
+        "\t\t<-io /dev/input/event1 /path/to/output/file1>\n"
         "\t\t[-io /dev/input/event2 /path/to/output/file2 ] ...\n"
         "\t\trecords user events from /dev/input/event* nodes\n"
         "\t\tor similar files outputting structures of Linux input system\n"
         "\t\tand saves them to given output files\n"
         "\t\tadditionally -t can set timeout value in seconds\n"
-        "\t\tafter which recording will automatically stop"
+        "\t\tafter which recording will automatically stop\n"
+        "\t\tand -e records all devices on a single epoll thread\n"
+        "\t\tinstead of a thread per device\n"
+        "\t\tand -u reads and writes through io_uring if kernel allows,\n"
+        "\t\tin place of poll and a writer thread, ignored with -e\n"
+        "\t\tand -b saves compact binary records instead of JSON lines\n"
+        "\t\tand -r sets how many events a device can have captured\n"
+        "\t\tbut not yet saved before new ones are dropped,\n"
+        "\t\t0 saves them on the capturing thread, ignored with -e"
     );
 }
 
 static inline void print_replay_options( void )
 {
     puts(
-        "\treplay </path/to/record/file1> [/path/to/record/file2] ...\n"
-        "\t\tplays back previously recorded events from given files"
+        "\treplay [-p num] [-s] [-j num] [-v] </path/to/record/file1>\n"
+        "\t\t[/path/to/record/file2] ...\n"
+        "\t\tplays back previously recorded events from given files\n"
+        "\t\tin either JSON or binary format\n"
+        "\t\tadditionally -p makes playback sleep until num microseconds\n"
+        "\t\tbefore each event and busy-wait the rest for precise timing\n"
+        "\t\tand -s minimizes timer slack of threads writing events\n"
+        "\t\tand -j parses large JSON recordings on up to num threads\n"
+        "\t\teach, 0 (default) uses one per CPU\n"
+        "\t\tand -v replays each file into a new virtual uinput device\n"
+        "\t\twith the event types and codes found in it,\n"
+        "\t\tinstead of the device it was recorded from\n"
+        "\t\ta recording compiled before is replayed from its sidecar,\n"
+        "\t\twhich is rebuilt if the recording changed since"
+    );
+}
+
+static inline void print_compile_options( void )
+{
+    puts(
+        "\tcompile </path/to/record/file1> [/path/to/record/file2] ...\n"
+        "\t\tparses JSON recordings once and saves their events next to\n"
+        "\t\tthem as /path/to/record/file"
+        ACTION_REPLAY_COMPILED_RECORDING_SUFFIX
+        ",\n\t\twhich replay maps instead of parsing again"
     );
 }
 
@@ -58,6 +98,7 @@ static inline int return_full_help( void )
     print_debug_options();
     print_record_options();
     print_replay_options();
+    print_compile_options();
     print_help_options();
     return EXIT_FAILURE;
 }
@@ -70,6 +111,22 @@ static inline bool is_help( char const * const arg )
     );
 }
 
+/* whole of arg is a decimal number no larger than max */
+static bool parse_number(
+    char const * const restrict arg,
+    unsigned long long int const max,
+    unsigned long long int * const restrict number
+)
+{
+    char * end;
+
+    if(( '0' > arg[ 0 ] ) || ( '9' < arg[ 0 ] )) { return false; }
+    errno = 0;
+    * number = strtoull( arg, &end, 10 );
+
+    return ( 0 == errno ) && ( '\0' == * end ) && ( max >= * number );
+}
+
 static inline bool is_io( char const * const arg )
 { return ( 0 == strncmp( arg, "-io\0", 4 )); }
 
@@ -77,12 +134,82 @@ static inline bool is_stop( void )
 { return ( 0 == OPA_load_int( &run_flag )); }
 
 typedef void ( * record_stop_func_t )( unsigned long int const arg );
+typedef action_replay_args_t ( * record_start_state_func_t )(
+    action_replay_time_t const * const zero_time
+);
+
+static inline void log_pool_stats(
+    char const * const name,
+    action_replay_class_t const * const _class
+)
+{
+    action_replay_pool_t_stats_return_t const stats =
+        action_replay_allocation_stats( _class );
+
+    if( 0 != stats.status ) { return; }
+    LOG(
+        "%s allocations: %" PRIu64 ", recycled: %" PRIu64
+        ", releases: %" PRIu64,
+        name,
+        stats.allocations,
+        stats.recycled,
+        stats.releases
+    );
+}
+
+static inline void log_allocation_stats( void )
+{
+    log_pool_stats( "time_t", action_replay_time_t_class() );
+    log_pool_stats(
+        "time_converter_t",
+        action_replay_time_converter_t_class()
+    );
+}
+
+static void * record_new(
+    bool const epoll,
+    action_replay_recorder_t_backend_t const backend,
+    action_replay_recorder_io_format_t const format,
+    size_t const ring_capacity,
+    unsigned int const count,
+    char const * const * const restrict paths_to_input_devices,
+    char const * const * const restrict paths_to_outputs
+)
+{
+    if( epoll )
+    {
+        return action_replay_new(
+            action_replay_epoll_recorder_t_class(),
+            action_replay_epoll_recorder_t_args(
+                count,
+                paths_to_input_devices,
+                paths_to_outputs,
+                format
+            )
+        );
+    }
+
+    return action_replay_new(
+        action_replay_recorder_t_class(),
+        action_replay_recorder_t_args(
+            paths_to_input_devices[ 0 ],
+            paths_to_outputs[ 0 ],
+            format,
+            ring_capacity,
+            backend
+        )
+    );
+}
 
 static int record_internal(
     unsigned int argc,
     char ** args,
     record_stop_func_t const stopper,
-    unsigned long int const stopper_arg
+    unsigned long int const stopper_arg,
+    bool const epoll,
+    action_replay_recorder_t_backend_t const backend,
+    action_replay_recorder_io_format_t const format,
+    size_t const ring_capacity
 )
 {
     if(( 0 != ( argc % 3 )) || ( is_help( args[ 0 ] )))
@@ -92,27 +219,24 @@ static int record_internal(
         return EXIT_FAILURE;
     }
 
-    unsigned int const rec_count = argc / 3;
+    unsigned int const io_count = argc / 3;
+    /* a single epoll recorder handles every device */
+    unsigned int const rec_count = epoll ? 1 : io_count;
+    record_start_state_func_t const start_state = epoll
+        ? action_replay_epoll_recorder_t_start_state
+        : action_replay_recorder_t_start_state;
+    char const ** const paths = calloc( 2 * io_count, sizeof( char * ));
+    void ** recorders = calloc( rec_count, sizeof( void * ));
 
-    action_replay_recorder_t ** recorders =
-        calloc( rec_count, sizeof( action_replay_recorder_t * ));
-
-    if( NULL == recorders )
+    if(( NULL == recorders ) || ( NULL == paths ))
     {
         LOG( "failure allocating recorders list" );
+        free( recorders );
+        free( paths );
         return EXIT_FAILURE;
     }
-    for(
-        unsigned int i = 0, rec = 0;
-        ( i < argc ) && ( rec < rec_count );
-        i += 3, ++rec
-    )
+    for( unsigned int i = 0, io = 0; i < argc; i += 3, ++io )
     {
-        if( is_stop() )
-        {
-            LOG( "ordered to stop through SIGINT" );
-            goto handle_sigint_during_recorder_creation;
-        }
         if( ! is_io( args[ i ] ))
         {
             LOG( "failure parsing program option: %s", args[ i ] );
@@ -120,13 +244,28 @@ static int record_internal(
             print_record_options();
             goto handle_recorder_option_parsing_error;
         }
-        recorders[ rec ] = action_replay_new(
-            action_replay_recorder_t_class(),
-            action_replay_recorder_t_args( args[ i + 1 ], args[ i + 2 ] )
+        paths[ io ] = args[ i + 1 ];
+        paths[ io_count + io ] = args[ i + 2 ];
+    }
+    for( unsigned int rec = 0; rec < rec_count; ++rec )
+    {
+        if( is_stop() )
+        {
+            LOG( "ordered to stop through SIGINT" );
+            goto handle_sigint_during_recorder_creation;
+        }
+        recorders[ rec ] = record_new(
+            epoll,
+            backend,
+            format,
+            ring_capacity,
+            io_count,
+            paths + rec,
+            paths + io_count + rec
         );
         if( NULL == recorders[ rec ] )
         {
-            LOG( "failure allocating recorder #%d, bailing out", i );
+            LOG( "failure allocating recorder #%d, bailing out", rec );
             goto handle_recorder_allocation_error;
         }
     }
@@ -163,10 +302,11 @@ static int record_internal(
             LOG( "ordered to stop through SIGINT" );
             goto handle_sigint_during_recorder_starting;
         }
-        if( 0 != recorders[ i ]->start(
-            ( void * ) ( recorders[ i ] ),
-            action_replay_recorder_t_start_state( zero_time )
-        ).status )
+        if( 0 != ACTION_REPLAY_DYNAMIC(
+            action_replay_stoppable_t_start_func_t,
+            start,
+            recorders[ i ]
+        )( recorders[ i ], start_state( zero_time )).status )
         {
             LOG( "failure starting recorder #%d, bailing out", i );
             goto handle_recorder_start_error;
@@ -177,21 +317,25 @@ static int record_internal(
     stopper( stopper_arg );
 
     for( unsigned int i = 0; i < rec_count; ++i )
-    { action_replay_delete( ( void * ) recorders[ i ] ); }
+    { action_replay_delete( recorders[ i ] ); }
     free( recorders );
+    free( paths );
     action_replay_delete( ( void * ) zero_time );
+    log_allocation_stats();
     return EXIT_SUCCESS;
 
 handle_recorder_start_error:
 handle_sigint_during_recorder_starting:
+    action_replay_delete( ( void * ) zero_time );
 handle_zero_time_allocation_error:
 handle_time_converter_allocation_error:
 handle_recorder_allocation_error:
 handle_recorder_option_parsing_error:
 handle_sigint_during_recorder_creation:
     for( unsigned int i = 0; i < rec_count; ++i )
-    { action_replay_delete( ( void * ) recorders[ i ] ); }
+    { action_replay_delete( recorders[ i ] ); }
     free( recorders );
+    free( paths );
     return EXIT_FAILURE;
 }
 
@@ -242,6 +386,10 @@ static int record( unsigned int argc, char ** args )
 
     record_stop_func_t stopper = default_record_stop;
     unsigned long int stopper_arg = 0;
+    bool epoll = false;
+    action_replay_recorder_t_backend_t backend = ACTION_REPLAY_RECORDER_T_POLL;
+    action_replay_recorder_io_format_t format = ACTION_REPLAY_RECORDER_IO_JSON;
+    size_t ring_capacity = ACTION_REPLAY_RECORDER_T_RING_CAPACITY;
 
     if(
         ( 0 == strncmp( args[ 0 ], "-t\0", 3 ))
@@ -252,12 +400,101 @@ static int record( unsigned int argc, char ** args )
         args += 2;
         stopper = timed_record_stop;
     }
+    while( 0 < argc )
+    {
+        if(( 1 < argc ) && ( 0 == strncmp( args[ 0 ], "-r\0", 3 )))
+        {
+            unsigned long long int capacity;
+
+            /* largest capacity the event ring accepts */
+            if( ! parse_number( args[ 1 ], INT_MAX - 1, &capacity ))
+            {
+                puts( PROGRAM_NAME );
+                print_record_options();
+                return EXIT_FAILURE;
+            }
+            ring_capacity = ( size_t ) capacity;
+            --argc;
+            ++args;
+        }
+        else if( 0 == strncmp( args[ 0 ], "-e\0", 3 )) { epoll = true; }
+        else if( 0 == strncmp( args[ 0 ], "-u\0", 3 ))
+        { backend = ACTION_REPLAY_RECORDER_T_IO_URING; }
+        else if( 0 == strncmp( args[ 0 ], "-b\0", 3 ))
+        { format = ACTION_REPLAY_RECORDER_IO_BINARY; }
+        else { break; }
+        --argc;
+        ++args;
+    }
+    if( 0 == argc )
+    {
+        puts( PROGRAM_NAME );
+        print_record_options();
+        return EXIT_FAILURE;
+    }
 
-    return record_internal( argc, args, stopper, stopper_arg );
+    return record_internal(
+        argc,
+        args,
+        stopper,
+        stopper_arg,
+        epoll,
+        backend,
+        format,
+        ring_capacity
+    );
 }
 
 static int replay( unsigned int argc, char ** args )
 {
+    unsigned long long int spin_margin = 0;
+    bool timer_slack = false;
+    unsigned long long int parse_threads = 0;
+    bool uinput = false;
+
+    while( 0 < argc )
+    {
+        if(( 1 < argc ) && ( 0 == strncmp( args[ 0 ], "-p\0", 3 )))
+        {
+            if( ! parse_number(
+                args[ 1 ],
+                UINT64_MAX / ACTION_REPLAY_NANOSECONDS_IN_MICROSECOND,
+                &spin_margin
+            ))
+            {
+                puts( PROGRAM_NAME );
+                print_replay_options();
+                return EXIT_FAILURE;
+            }
+            spin_margin *= ACTION_REPLAY_NANOSECONDS_IN_MICROSECOND;
+            argc -= 2;
+            args += 2;
+        }
+        else if( 0 == strncmp( args[ 0 ], "-s\0", 3 ))
+        {
+            timer_slack = true;
+            --argc;
+            ++args;
+        }
+        else if(( 1 < argc ) && ( 0 == strncmp( args[ 0 ], "-j\0", 3 )))
+        {
+            if( ! parse_number( args[ 1 ], UINT_MAX, &parse_threads ))
+            {
+                puts( PROGRAM_NAME );
+                print_replay_options();
+                return EXIT_FAILURE;
+            }
+            argc -= 2;
+            args += 2;
+        }
+        else if( 0 == strncmp( args[ 0 ], "-v\0", 3 ))
+        {
+            uinput = true;
+            --argc;
+            ++args;
+        }
+        else { break; }
+    }
     if(( 1 > argc ) || ( is_help( args[ 0 ] )))
     {
         puts( PROGRAM_NAME );
@@ -277,7 +514,7 @@ static int replay( unsigned int argc, char ** args )
     {
         players[ i ] = action_replay_new(
             action_replay_player_t_class(),
-            action_replay_player_t_args( args[ i ] )
+            action_replay_player_t_args( args[ i ], uinput )
         );
         if( NULL == players[ i ] )
         {
@@ -315,7 +552,12 @@ static int replay( unsigned int argc, char ** args )
     {
         if( 0 != players[ i ]->start(
             ( void * ) ( players[ i ] ),
-            action_replay_player_t_start_state( zero_time )
+            action_replay_player_t_start_state(
+                zero_time,
+                spin_margin,
+                timer_slack,
+                ( unsigned int ) parse_threads
+            )
         ).status )
         {
             LOG( "failure starting player #%d, bailing out", i );
@@ -331,6 +573,7 @@ static int replay( unsigned int argc, char ** args )
     }
     free( players );
     action_replay_delete( ( void * ) zero_time );
+    log_allocation_stats();
     return EXIT_SUCCESS;
 
 handle_player_start_error:
@@ -344,6 +587,30 @@ handle_player_allocation_error:
     return EXIT_FAILURE;
 }
 
+static int compile( unsigned int argc, char ** args )
+{
+    if(( 1 > argc ) || ( is_help( args[ 0 ] )))
+    {
+        puts( PROGRAM_NAME );
+        print_compile_options();
+        return EXIT_FAILURE;
+    }
+
+    int result = EXIT_SUCCESS;
+
+    for( unsigned int i = 0; i < argc; ++i )
+    {
+        action_replay_error_t const status =
+            action_replay_compiled_recording_compile( args[ i ] );
+
+        if( 0 == status ) { continue; }
+        LOG( "failure compiling %s, errno = %d", args[ i ], status );
+        result = EXIT_FAILURE;
+    }
+
+    return result;
+}
+
 static inline FILE * fopen_debug_option( char const * const arg )
 {
     if( 0 == strncmp( arg, "stdout\0", 7 )) { return stdout; }
@@ -372,6 +639,7 @@ static int debug( unsigned int argc, char ** args )
     if( is_help( args[ 1 ] )) { return return_full_help(); }
     else if( 0 == strncmp( args[ 1 ], "record\0", 7 )) { func = record; }
     else if( 0 == strncmp( args[ 1 ], "replay\0", 7 )) { func = replay; }
+    else if( 0 == strncmp( args[ 1 ], "compile\0", 8 )) { func = compile; }
 
     FILE * log = fopen_debug_option( args[ 0 ] );
 
@@ -383,7 +651,7 @@ static int debug( unsigned int argc, char ** args )
         return EXIT_FAILURE;
     }
     fclose_debug_option( log );
-    /* skip args: debug argument, record/replay/help option */
+    /* skip args: debug argument, record/replay/compile/help option */
     int const result = func( argc - 2, args + 2 );
     action_replay_log_close();
     return result;
@@ -399,6 +667,7 @@ int main( int argc, char ** args )
     else if( 0 == strncmp( args[ 1 ], "--debug\0", 8 )) { func = debug; }
     else if( 0 == strncmp( args[ 1 ], "record\0", 7 )) { func = record; }
     else if( 0 == strncmp( args[ 1 ], "replay\0", 7 )) { func = replay; }
+    else if( 0 == strncmp( args[ 1 ], "compile\0", 8 )) { func = compile; }
 
     /* skip args[ 0 ] - program name, args[ 1 ] - option */
     return func( argc - 2, args + 2 );
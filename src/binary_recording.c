@@ -0,0 +1,65 @@
+#include "action_replay/binary_recording.h"
+#include "action_replay/log.h"
+#include "action_replay/stdbool.h"
+#include "action_replay/stddef.h"
+#include "action_replay/stdint.h"
+#include <errno.h>
+#include <string.h>
+
+bool action_replay_binary_recording_is(
+    void const * const buffer,
+    size_t const buffer_length
+)
+{
+    return (
+        ( sizeof( action_replay_binary_recording_header_t ) <= buffer_length )
+        && ( 0 == memcmp(
+            buffer,
+            ACTION_REPLAY_BINARY_RECORDING_MAGIC,
+            ACTION_REPLAY_BINARY_RECORDING_MAGIC_SIZE
+        ))
+    );
+}
+
+action_replay_binary_recording_return_t action_replay_binary_recording_read(
+    void const * const buffer,
+    size_t const buffer_length
+)
+{
+    action_replay_binary_recording_return_t result = { EINVAL, NULL, NULL, 0 };
+
+    if( ! action_replay_binary_recording_is( buffer, buffer_length ))
+    { return result; }
+
+    action_replay_binary_recording_header_t const * const header = buffer;
+
+    if( ACTION_REPLAY_BINARY_RECORDING_VERSION != header->version )
+    {
+        LOG(
+            "unsupported binary recording version %u",
+            ( unsigned int ) header->version
+        );
+        result.status = ENOTSUP;
+        return result;
+    }
+
+    size_t const records_offset =
+        action_replay_binary_recording_records_offset( header->path_length );
+    char const * const path = ( char const * ) ( header + 1 );
+
+    if(
+        ( records_offset > buffer_length )
+        || ( '\0' != path[ header->path_length ] )
+    )
+    {
+        LOG( "binary recording header is truncated or corrupted" );
+        return result;
+    }
+    result.status = 0;
+    result.path = path;
+    result.records = ( void const * ) (( char const * ) buffer + records_offset );
+    result.count = ( buffer_length - records_offset )
+        / sizeof( action_replay_binary_recording_record_t );
+
+    return result;
+}
@@ -1,7 +1,13 @@
 #include "action_replay/class.h"
+#include "action_replay/stdint.h"
 #include <errno.h>
+#include <opa_primitives.h>
+#include <pthread.h>
 #include <string.h> /* strcmp */
 
+#define ANCESTRY_WORD_BITS ACTION_REPLAY_CLASS_ANCESTRY_WORD_BITS
+#define ANCESTRY_WORDS ( ACTION_REPLAY_CLASS_LIMIT / ANCESTRY_WORD_BITS )
+
 action_replay_reflector_return_t action_replay_class_t_generic_reflector_logic(
     char const * const restrict type,
     char const * const restrict name,
@@ -24,3 +30,137 @@ action_replay_reflector_return_t action_replay_class_t_generic_reflector_logic(
     return ( action_replay_reflector_return_t const ) { EINVAL, 0 };
 }
 
+/* marks entry claimed by a thread, but not yet filled */
+static char const action_replay_class_t_cache_entry_busy;
+
+static inline size_t action_replay_class_t_cache_hash(
+    char const * const restrict type,
+    char const * const restrict name
+)
+{
+    uintptr_t const hash =
+        (( uintptr_t ) name >> 3 ) ^ (( uintptr_t ) type >> 7 );
+
+    return ( size_t ) ( hash ^ ( hash >> 11 ));
+}
+
+action_replay_reflector_return_t action_replay_class_t_cached_reflector_logic(
+    action_replay_class_t const * const restrict _class,
+    char const * const restrict type,
+    char const * const restrict name
+)
+{
+    action_replay_reflection_cache_t * const cache = _class->reflection_cache;
+
+    if( NULL == cache ) { return _class->reflector( type, name ); }
+
+    size_t const mask = ACTION_REPLAY_REFLECTION_CACHE_SIZE - 1;
+    size_t const hash = action_replay_class_t_cache_hash( type, name );
+    action_replay_reflection_cache_entry_t * empty = NULL;
+
+    for( size_t i = 0; i < ACTION_REPLAY_REFLECTION_CACHE_SIZE; ++i )
+    {
+        action_replay_reflection_cache_entry_t * const entry =
+            cache->entries + (( hash + i ) & mask );
+        char const * const entry_name =
+            OPA_load_acquire_ptr( &( entry->name ));
+
+        if( NULL == entry_name ) { empty = entry; break; }
+        if(( name == entry_name ) && ( type == entry->type ))
+        {
+            return ( action_replay_reflector_return_t const )
+            { 0, entry->offset };
+        }
+    }
+
+    action_replay_reflector_return_t const result =
+        _class->reflector( type, name );
+
+    /* failed lookups aren't cached, full cache degrades to reflector */
+    if(( 0 != result.status ) || ( NULL == empty )) { return result; }
+    if( NULL != OPA_cas_ptr(
+        &( empty->name ),
+        NULL,
+        ( void * ) &action_replay_class_t_cache_entry_busy
+    )) { return result; } /* other thread claimed it, try next time */
+    empty->type = type;
+    empty->offset = result.offset;
+    OPA_store_release_ptr( &( empty->name ), ( void * ) name );
+
+    return result;
+}
+
+/* registration is rare, serializing it keeps ids dense */
+static pthread_mutex_t action_replay_class_t_registry_mutex =
+    PTHREAD_MUTEX_INITIALIZER;
+static size_t action_replay_class_t_registry_count = 0;
+
+static action_replay_class_t_id_return_t
+action_replay_class_t_register_locked(
+    action_replay_class_t const * const _class
+)
+{
+    action_replay_class_t_ancestry_t * const ancestry = _class->ancestry;
+
+    if( NULL == ancestry )
+    { return ( action_replay_class_t_id_return_t const ) { ENOTSUP, 0 }; }
+
+    int const id = OPA_load_int( &( ancestry->id ));
+
+    if( 0 < id )
+    {
+        return ( action_replay_class_t_id_return_t const )
+        { 0, ( size_t ) ( id - 1 ) };
+    }
+
+    uint64_t ancestors[ ANCESTRY_WORDS ] = { 0 };
+    action_replay_class_t_func_t const * const parent_list =
+        _class->inheritance;
+
+    for( unsigned int index = 0; parent_list[ index ] != NULL; ++index )
+    {
+        action_replay_class_t const * const parent = parent_list[ index ]();
+        action_replay_class_t_id_return_t const result =
+            action_replay_class_t_register_locked( parent );
+
+        if( 0 != result.status ) { return result; }
+        for( size_t word = 0; word < ANCESTRY_WORDS; ++word )
+        { ancestors[ word ] |= parent->ancestry->ancestors[ word ]; }
+    }
+    if( ACTION_REPLAY_CLASS_LIMIT == action_replay_class_t_registry_count )
+    { return ( action_replay_class_t_id_return_t const ) { ENOSPC, 0 }; }
+
+    size_t const new_id = action_replay_class_t_registry_count++;
+
+    ancestors[ new_id / ANCESTRY_WORD_BITS ] |=
+        (( uint64_t ) 1 ) << ( new_id % ANCESTRY_WORD_BITS );
+    for( size_t word = 0; word < ANCESTRY_WORDS; ++word )
+    { ancestry->ancestors[ word ] = ancestors[ word ]; }
+    /* readers check id first, bitset must be visible by then */
+    OPA_store_release_int( &( ancestry->id ), ( int ) new_id + 1 );
+
+    return ( action_replay_class_t_id_return_t const ) { 0, new_id };
+}
+
+action_replay_class_t_id_return_t
+action_replay_class_t_register( action_replay_class_t const * const _class )
+{
+    if(( NULL == _class ) || ( NULL == _class->ancestry ))
+    { return ( action_replay_class_t_id_return_t const ) { EINVAL, 0 }; }
+
+    int const id = OPA_load_acquire_int( &( _class->ancestry->id ));
+
+    if( 0 < id )
+    {
+        return ( action_replay_class_t_id_return_t const )
+        { 0, ( size_t ) ( id - 1 ) };
+    }
+
+    action_replay_class_t_id_return_t result;
+
+    pthread_mutex_lock( &action_replay_class_t_registry_mutex );
+    result = action_replay_class_t_register_locked( _class );
+    pthread_mutex_unlock( &action_replay_class_t_registry_mutex );
+
+    return result;
+}
@@ -0,0 +1,449 @@
+#define _POSIX_C_SOURCE 200809L /* st_mtim */
+
+#include "action_replay/binary_recording.h"
+#include "action_replay/compiled_recording.h"
+#include "action_replay/error.h"
+#include "action_replay/json_recording.h"
+#include "action_replay/log.h"
+#include "action_replay/recorder_io.h"
+#include "action_replay/stdbool.h"
+#include "action_replay/stddef.h"
+#include "action_replay/stdint.h"
+#include "action_replay/sys/types.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+/* ".<pid>.tmp" */
+#define TEMPORARY_SUFFIX_MAX_LEN 32
+#define START_OF_FILE 0
+/* parsed between writes, so sidecars are written in constant memory */
+#define RECORDS_PER_CHUNK 256
+
+static uint64_t action_replay_compiled_recording_hash(
+    unsigned char const * const buffer,
+    size_t const buffer_length
+)
+{
+    uint64_t result = FNV_OFFSET_BASIS;
+
+    for( size_t i = 0; i < buffer_length; ++i )
+    {
+        result ^= buffer[ i ];
+        result *= FNV_PRIME;
+    }
+
+    return result;
+}
+
+/* NULL on allocation failure */
+static char * action_replay_compiled_recording_path(
+    char const * const path_to_recording
+)
+{
+    size_t const length = strlen( path_to_recording );
+    char * const result = malloc(
+        length + sizeof( ACTION_REPLAY_COMPILED_RECORDING_SUFFIX )
+    );
+
+    if( NULL == result ) { return NULL; }
+    memcpy( result, path_to_recording, length );
+    memcpy(
+        result + length,
+        ACTION_REPLAY_COMPILED_RECORDING_SUFFIX,
+        sizeof( ACTION_REPLAY_COMPILED_RECORDING_SUFFIX )
+    );
+
+    return result;
+}
+
+static bool action_replay_compiled_recording_mtime_matches(
+    action_replay_compiled_recording_header_t const * const restrict header,
+    struct stat const * const restrict source_stat
+)
+{
+    return ( source_stat->st_mtim.tv_sec == header->source_mtime_seconds )
+        && (
+            source_stat->st_mtim.tv_nsec
+            == header->source_mtime_nanoseconds
+        );
+}
+
+static bool action_replay_compiled_recording_matches(
+    action_replay_compiled_recording_header_t const * const restrict header,
+    struct stat const * const restrict source_stat,
+    void const * const restrict source,
+    size_t const source_length
+)
+{
+    if(
+        ( 0 != memcmp(
+            header->magic,
+            ACTION_REPLAY_COMPILED_RECORDING_MAGIC,
+            ACTION_REPLAY_COMPILED_RECORDING_MAGIC_SIZE
+        ))
+        || ( ACTION_REPLAY_COMPILED_RECORDING_VERSION != header->version )
+        || ( source_length != header->source_size )
+    ) { return false; }
+    if( action_replay_compiled_recording_mtime_matches( header, source_stat ))
+    { return true; }
+    LOG( "source of compiled recording was touched, comparing hashes" );
+
+    return header->source_hash
+        == action_replay_compiled_recording_hash( source, source_length );
+}
+
+/* so that later opens of a touched source don't hash it again */
+static void action_replay_compiled_recording_update_mtime(
+    char const * const restrict path,
+    struct stat const * const restrict source_stat
+)
+{
+    int64_t const mtime[ 2 ] = {
+        source_stat->st_mtim.tv_sec,
+        source_stat->st_mtim.tv_nsec
+    };
+    int const fd = open( path, O_WRONLY );
+
+    /* sidecar stays valid without it, it's only slower to open */
+    if(
+        ( -1 == fd )
+        || (( ssize_t ) sizeof( mtime ) != pwrite(
+            fd,
+            mtime,
+            sizeof( mtime ),
+            offsetof(
+                action_replay_compiled_recording_header_t,
+                source_mtime_seconds
+            )
+        ))
+    )
+    {
+        LOG( "failure updating mtime of %s, errno = %d", path, errno );
+    }
+    if( -1 != fd ) { close( fd ); }
+}
+
+action_replay_compiled_recording_return_t
+action_replay_compiled_recording_open(
+    char const * const restrict path_to_recording,
+    struct stat const * const restrict source_stat,
+    void const * const restrict source,
+    size_t const source_length
+)
+{
+    action_replay_compiled_recording_return_t result =
+        { ENOMEM, NULL, 0, NULL, 0 };
+    char * const path =
+        action_replay_compiled_recording_path( path_to_recording );
+
+    if( NULL == path ) { return result; }
+
+    int const fd = open( path, O_RDONLY );
+
+    if( -1 == fd )
+    {
+        result.status = errno;
+        goto handle_open_error;
+    }
+
+    struct stat compiled_stat;
+
+    if( -1 == fstat( fd, &compiled_stat ))
+    {
+        result.status = errno;
+        goto handle_stat_error;
+    }
+    /* interrupted compilation leaves no sidecar, but a copy may be cut */
+    if(
+        ( off_t ) sizeof( action_replay_compiled_recording_header_t )
+        > compiled_stat.st_size
+    )
+    {
+        result.status = ESTALE;
+        goto handle_stat_error;
+    }
+    result.mapping_length = ( size_t ) compiled_stat.st_size;
+    result.mapping = mmap(
+        NULL,
+        result.mapping_length,
+        PROT_READ,
+        MAP_SHARED,
+        fd,
+        START_OF_FILE
+    );
+    if( MAP_FAILED == result.mapping )
+    {
+        result.status = errno;
+        goto handle_map_error;
+    }
+    if( ! action_replay_compiled_recording_matches(
+        result.mapping,
+        source_stat,
+        source,
+        source_length
+    ))
+    {
+        result.status = ESTALE;
+        goto handle_stale_error;
+    }
+    if( ! action_replay_compiled_recording_mtime_matches(
+        result.mapping,
+        source_stat
+    )) { action_replay_compiled_recording_update_mtime( path, source_stat ); }
+    result.status = 0;
+    result.recording = ( char const * ) result.mapping
+        + sizeof( action_replay_compiled_recording_header_t );
+    result.recording_length = result.mapping_length
+        - sizeof( action_replay_compiled_recording_header_t );
+    close( fd );
+    free( path );
+
+    return result;
+
+handle_stale_error:
+    /* we control the mapping, const can be dropped */
+    munmap( ( void * ) result.mapping, result.mapping_length );
+handle_map_error:
+    result.mapping = NULL;
+    result.mapping_length = 0;
+handle_stat_error:
+    close( fd );
+handle_open_error:
+    free( path );
+    return result;
+}
+
+/* events are parsed a chunk at a time straight into the writer */
+static action_replay_error_t action_replay_compiled_recording_write_file(
+    int const fd,
+    action_replay_compiled_recording_header_t const * const restrict header,
+    char const * const restrict path_to_device,
+    char const * const restrict events,
+    size_t const events_length
+)
+{
+    action_replay_recorder_io_writer_t * const writer =
+        malloc( sizeof( action_replay_recorder_io_writer_t ));
+
+    if( NULL == writer ) { return ENOMEM; }
+    action_replay_recorder_io_writer_init(
+        writer,
+        fd,
+        ACTION_REPLAY_RECORDER_IO_BINARY
+    );
+
+    action_replay_binary_recording_record_t records[ RECORDS_PER_CHUNK ];
+    action_replay_error_t result;
+
+    if(
+        ( 0 != ( result = action_replay_recorder_io_writer_append(
+            writer,
+            header,
+            sizeof( action_replay_compiled_recording_header_t )
+        )))
+        || ( 0 != ( result = action_replay_recorder_io_write_header(
+            path_to_device,
+            writer
+        )))
+    ) { goto handle_write_error; }
+    for( size_t offset = 0; events_length > offset; )
+    {
+        action_replay_json_recording_chunk_return_t const chunk =
+            action_replay_json_recording_parse_chunk(
+                events + offset,
+                events_length - offset,
+                records,
+                RECORDS_PER_CHUNK
+            );
+
+        if( 0 != ( result = chunk.status ))
+        {
+            LOG( "failure parsing events of %s", path_to_device );
+            goto handle_write_error;
+        }
+        if( 0 != ( result = action_replay_recorder_io_writer_append(
+            writer,
+            records,
+            chunk.count * sizeof( action_replay_binary_recording_record_t )
+        ))) { goto handle_write_error; }
+        offset += chunk.length;
+    }
+    result = action_replay_recorder_io_writer_flush( writer );
+handle_write_error:
+    free( writer );
+
+    return result;
+}
+
+action_replay_error_t action_replay_compiled_recording_write(
+    char const * const restrict path_to_recording,
+    struct stat const * const restrict source_stat,
+    void const * const restrict source,
+    size_t const source_length
+)
+{
+    if( action_replay_binary_recording_is( source, source_length ))
+    {
+        LOG( "%s is a binary recording already", path_to_recording );
+        return EINVAL;
+    }
+
+    action_replay_error_t result;
+    action_replay_json_recording_header_return_t const header =
+        action_replay_json_recording_parse_header( source, source_length );
+
+    if( 0 != ( result = header.status )) { return result; }
+
+    char * const path =
+        action_replay_compiled_recording_path( path_to_recording );
+
+    if( NULL == path )
+    {
+        result = ENOMEM;
+        goto handle_path_error;
+    }
+
+    size_t const temporary_path_size =
+        strlen( path ) + TEMPORARY_SUFFIX_MAX_LEN;
+    char * const temporary_path = malloc( temporary_path_size );
+
+    if( NULL == temporary_path )
+    {
+        result = ENOMEM;
+        goto handle_temporary_path_error;
+    }
+    /* concurrent replays of the same recording write their own */
+    snprintf(
+        temporary_path,
+        temporary_path_size,
+        "%s.%ld.tmp",
+        path,
+        ( long int ) getpid()
+    );
+
+    int const fd = open(
+        temporary_path,
+        O_WRONLY | O_CREAT | O_TRUNC,
+        S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH
+    );
+
+    if( -1 == fd )
+    {
+        result = errno;
+        LOG(
+            "failure to open %s, errno = %d",
+            temporary_path,
+            result
+        );
+        goto handle_open_error;
+    }
+
+    action_replay_compiled_recording_header_t compiled_header =
+    {
+        ACTION_REPLAY_COMPILED_RECORDING_MAGIC,
+        ACTION_REPLAY_COMPILED_RECORDING_VERSION,
+        0,
+        source_length,
+        source_stat->st_mtim.tv_sec,
+        source_stat->st_mtim.tv_nsec,
+        action_replay_compiled_recording_hash( source, source_length )
+    };
+
+    result = action_replay_compiled_recording_write_file(
+        fd,
+        &compiled_header,
+        header.path,
+        ( char const * ) source + header.events_offset,
+        source_length - header.events_offset
+    );
+    if(( -1 == close( fd )) && ( 0 == result )) { result = errno; }
+    if( 0 != result )
+    {
+        LOG( "failure writing %s, errno = %d", temporary_path, result );
+        goto handle_write_error;
+    }
+    /* readers see either old sidecar or the whole new one */
+    if( -1 == rename( temporary_path, path ))
+    {
+        result = errno;
+        LOG( "failure renaming %s, errno = %d", temporary_path, result );
+        goto handle_write_error;
+    }
+    LOG( "compiled %s into %s", path_to_recording, path );
+    free( temporary_path );
+    free( path );
+    free( header.path );
+
+    return 0;
+
+handle_write_error:
+    unlink( temporary_path );
+handle_open_error:
+    free( temporary_path );
+handle_temporary_path_error:
+    free( path );
+handle_path_error:
+    free( header.path );
+    return result;
+}
+
+action_replay_error_t action_replay_compiled_recording_compile(
+    char const * const path_to_recording
+)
+{
+    action_replay_error_t result;
+    int const fd = open( path_to_recording, O_RDONLY );
+
+    if( -1 == fd )
+    {
+        result = errno;
+        LOG( "failure to open %s, errno = %d", path_to_recording, result );
+        return result;
+    }
+
+    struct stat source_stat;
+
+    if( -1 == fstat( fd, &source_stat ))
+    {
+        result = errno;
+        LOG( "failure to stat %s, errno = %d", path_to_recording, result );
+        close( fd );
+        return result;
+    }
+
+    size_t const length = ( size_t ) source_stat.st_size;
+    void const * const source = mmap(
+        NULL,
+        length,
+        PROT_READ,
+        MAP_SHARED,
+        fd,
+        START_OF_FILE
+    );
+
+    close( fd );
+    if( MAP_FAILED == source )
+    {
+        result = errno;
+        LOG( "failure to map %s, errno = %d", path_to_recording, result );
+        return result;
+    }
+    result = action_replay_compiled_recording_write(
+        path_to_recording,
+        &source_stat,
+        source,
+        length
+    );
+    /* we control the mapping, const can be dropped */
+    munmap( ( void * ) source, length );
+
+    return result;
+}
@@ -0,0 +1,1042 @@
+#define _POSIX_C_SOURCE 200809L /* fileno */
+#define __STDC_FORMAT_MACROS
+
+#include "action_replay/args.h"
+#include "action_replay/class.h"
+#include "action_replay/epoll_recorder.h"
+#include "action_replay/error.h"
+#include "action_replay/inttypes.h"
+#include "action_replay/log.h"
+#include "action_replay/object_oriented_programming.h"
+#include "action_replay/object_oriented_programming_super.h"
+#include "action_replay/recorder_io.h"
+#include "action_replay/return.h"
+#include "action_replay/stateful_return.h"
+#include "action_replay/stddef.h"
+#include "action_replay/stdint.h"
+#include "action_replay/stoppable.h"
+#include "action_replay/strndup.h"
+#include "action_replay/time.h"
+#include "action_replay/time_converter.h"
+#include <errno.h>
+#include <linux/input.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#define INPUT_MAX_LEN 1024
+/* ready descriptors handled per wakeup, rest are reported by next wait */
+#define EPOLL_EVENTS_COUNT 32
+
+typedef struct {
+    action_replay_time_t * zero_time;
+} action_replay_epoll_recorder_t_start_state_t;
+
+typedef struct {
+    size_t count;
+    char ** paths_to_input_devices;
+    char ** paths_to_outputs;
+    action_replay_recorder_io_format_t format;
+} action_replay_epoll_recorder_t_args_t;
+
+typedef struct {
+    FILE * input;
+    FILE * output;
+    uint64_t zero_time;
+    uint64_t reads;
+    uint64_t events_read;
+    action_replay_recorder_io_writer_t writer;
+} action_replay_epoll_recorder_t_device_t;
+
+typedef struct {
+    action_replay_epoll_recorder_t_state_t * recorder_state;
+    struct input_event events[ ACTION_REPLAY_RECORDER_IO_EVENTS_PER_READ ];
+    struct epoll_event ready[ EPOLL_EVENTS_COUNT ];
+} action_replay_epoll_recorder_t_worker_state_t;
+
+struct action_replay_epoll_recorder_t_state_t
+{
+    action_replay_epoll_recorder_t_worker_state_t * worker_state;
+    action_replay_stoppable_t_start_func_t stoppable_start;
+    action_replay_stoppable_t_stop_func_t stoppable_stop;
+    action_replay_epoll_recorder_t_device_t * devices;
+    size_t device_count;
+    size_t open_count; /* devices not yet dropped after a failure */
+    int epoll_fd;
+    int stop_fd; /* eventfd, registered in epoll with NULL data */
+    uint64_t waits; /* worker's, read while it's stopped */
+};
+
+static action_replay_error_t action_replay_epoll_recorder_t_devices_close(
+    action_replay_epoll_recorder_t_device_t * const devices,
+    size_t const count
+)
+{
+    action_replay_error_t result = 0;
+
+    for( size_t i = 0; i < count; ++i )
+    {
+        if( NULL != devices[ i ].output )
+        {
+            action_replay_error_t const flush_result =
+                action_replay_recorder_io_writer_flush(
+                    &( devices[ i ].writer )
+                );
+
+            if( 0 != flush_result ) { result = flush_result; }
+            if( EOF == fclose( devices[ i ].output )) { result = errno; }
+        }
+        if(
+            ( NULL != devices[ i ].input )
+            && ( EOF == fclose( devices[ i ].input ))
+        ) { result = errno; }
+    }
+
+    return result;
+}
+
+static action_replay_error_t action_replay_epoll_recorder_t_device_open(
+    action_replay_epoll_recorder_t_device_t * const restrict device,
+    char const * const restrict path_to_input_device,
+    char const * const restrict path_to_output,
+    action_replay_recorder_io_format_t const format,
+    int const epoll_fd
+)
+{
+    action_replay_error_t result;
+
+    device->input = fopen( path_to_input_device, "r" );
+    if( NULL == device->input )
+    {
+        result = errno;
+        LOG(
+            "failure opening %s, errno = %d",
+            path_to_input_device,
+            result
+        );
+        return result;
+    }
+    device->output = fopen( path_to_output, "w" );
+    if( NULL == device->output )
+    {
+        result = errno;
+        LOG( "failure opening %s, errno = %d", path_to_output, result );
+        return result;
+    }
+    action_replay_recorder_io_writer_init(
+        &( device->writer ),
+        fileno( device->output ),
+        format
+    );
+
+    struct epoll_event registration = { .events = EPOLLIN };
+
+    registration.data.ptr = device;
+    if( -1 == epoll_ctl(
+        epoll_fd,
+        EPOLL_CTL_ADD,
+        fileno( device->input ),
+        &registration
+    ))
+    {
+        result = errno;
+        LOG(
+            "failure adding %s to epoll set, errno = %d",
+            path_to_input_device,
+            result
+        );
+        return result;
+    }
+    result = action_replay_recorder_io_write_header(
+        path_to_input_device,
+        &( device->writer )
+    );
+    if( 0 == result )
+    {
+        LOG( "%s opened as %p", path_to_input_device, device->input );
+    }
+
+    return result;
+}
+
+static action_replay_stateful_return_t
+action_replay_epoll_recorder_t_state_t_new(
+    action_replay_args_t const args,
+    action_replay_stoppable_t_start_func_t const start,
+    action_replay_stoppable_t_stop_func_t const stop
+)
+{
+    action_replay_stateful_return_t result;
+
+    result.state =
+        calloc( 1, sizeof( action_replay_epoll_recorder_t_state_t ));
+    if( NULL == result.state )
+    {
+        result.status = ENOMEM;
+        return result;
+    }
+
+    action_replay_epoll_recorder_t_args_t * const recorder_args = args.state;
+    action_replay_epoll_recorder_t_state_t * const recorder_state =
+        result.state;
+
+    recorder_state->devices = calloc(
+        recorder_args->count,
+        sizeof( action_replay_epoll_recorder_t_device_t )
+    );
+    if( NULL == recorder_state->devices )
+    {
+        result.status = ENOMEM;
+        goto handle_devices_alloc_error;
+    }
+    recorder_state->device_count = recorder_args->count;
+    recorder_state->epoll_fd = epoll_create1( 0 );
+    if( -1 == recorder_state->epoll_fd )
+    {
+        result.status = errno;
+        goto handle_epoll_create_error;
+    }
+    recorder_state->stop_fd = eventfd( 0, EFD_NONBLOCK );
+    if( -1 == recorder_state->stop_fd )
+    {
+        result.status = errno;
+        goto handle_eventfd_error;
+    }
+
+    struct epoll_event stop_registration = { .events = EPOLLIN };
+
+    stop_registration.data.ptr = NULL;
+    if( -1 == epoll_ctl(
+        recorder_state->epoll_fd,
+        EPOLL_CTL_ADD,
+        recorder_state->stop_fd,
+        &stop_registration
+    ))
+    {
+        result.status = errno;
+        goto handle_devices_open_error;
+    }
+    for( size_t i = 0; i < recorder_args->count; ++i )
+    {
+        result.status = action_replay_epoll_recorder_t_device_open(
+            recorder_state->devices + i,
+            recorder_args->paths_to_input_devices[ i ],
+            recorder_args->paths_to_outputs[ i ],
+            recorder_args->format,
+            recorder_state->epoll_fd
+        );
+        if( 0 != result.status ) { goto handle_devices_open_error; }
+    }
+    recorder_state->open_count = recorder_args->count;
+
+    recorder_state->stoppable_start = start;
+    recorder_state->stoppable_stop = stop;
+    recorder_state->worker_state = NULL;
+    return result;
+
+handle_devices_open_error:
+    action_replay_epoll_recorder_t_devices_close(
+        recorder_state->devices,
+        recorder_state->device_count
+    );
+    close( recorder_state->stop_fd );
+handle_eventfd_error:
+    close( recorder_state->epoll_fd );
+handle_epoll_create_error:
+    free( recorder_state->devices );
+handle_devices_alloc_error:
+    free( result.state );
+    result.state = NULL;
+    return result;
+}
+
+static action_replay_return_t action_replay_epoll_recorder_t_state_t_delete(
+    action_replay_epoll_recorder_t_state_t * const recorder_state
+)
+{
+    action_replay_return_t result;
+
+    if(
+        ( -1 == close( recorder_state->stop_fd ))
+        || ( -1 == close( recorder_state->epoll_fd ))
+    ) { return ( action_replay_return_t const ) { errno }; }
+    result.status = action_replay_epoll_recorder_t_devices_close(
+        recorder_state->devices,
+        recorder_state->device_count
+    );
+    if( 0 != result.status ) { return result; }
+    /* worker_state known to be cleaned up */
+    free( recorder_state->devices );
+    free( recorder_state );
+
+    return result;
+}
+
+action_replay_class_t const * action_replay_epoll_recorder_t_class( void );
+
+static action_replay_return_t action_replay_epoll_recorder_t_internal(
+    action_replay_object_oriented_programming_super_operation_t const
+        operation,
+    action_replay_epoll_recorder_t * const restrict recorder,
+    action_replay_epoll_recorder_t const * const restrict original_recorder,
+    action_replay_args_t const args,
+    action_replay_stoppable_t_start_func_t const start,
+    action_replay_stoppable_t_stop_func_t const stop
+)
+{
+    if( NULL == args.state )
+    { return ( action_replay_return_t const ) { EINVAL }; }
+    SUPER(
+        operation,
+        action_replay_epoll_recorder_t_class,
+        recorder,
+        original_recorder,
+        args
+    );
+
+    action_replay_stateful_return_t result;
+
+    result = action_replay_epoll_recorder_t_state_t_new(
+        args,
+        ACTION_REPLAY_DYNAMIC(
+            action_replay_stoppable_t_start_func_t,
+            start,
+            recorder
+        ), /* set in super */
+        ACTION_REPLAY_DYNAMIC(
+            action_replay_stoppable_t_stop_func_t,
+            stop,
+            recorder
+        ) /* set in super */
+    );
+    if( 0 != result.status )
+    {
+        SUPER(
+            DESTRUCT,
+            action_replay_epoll_recorder_t_class,
+            recorder,
+            NULL,
+            args
+        );
+        return ( action_replay_return_t const ) { result.status };
+    }
+    ACTION_REPLAY_DYNAMIC(
+        action_replay_epoll_recorder_t_state_t *,
+        epoll_recorder_state,
+        recorder
+    ) = result.state;
+    ACTION_REPLAY_DYNAMIC(
+        action_replay_stoppable_t_start_func_t,
+        start,
+        recorder
+    ) = start;
+    ACTION_REPLAY_DYNAMIC(
+        action_replay_stoppable_t_stop_func_t,
+        stop,
+        recorder
+    ) = stop;
+
+    return ( action_replay_return_t const ) { result.status };
+}
+
+static action_replay_return_t action_replay_epoll_recorder_t_start_func_t_start(
+    action_replay_stoppable_t * const self,
+    action_replay_args_t const start_state
+);
+static action_replay_return_t action_replay_epoll_recorder_t_stop_func_t_stop(
+    action_replay_stoppable_t * const self
+);
+
+static inline action_replay_return_t
+action_replay_epoll_recorder_t_constructor(
+    void * const object,
+    action_replay_args_t const args
+)
+{
+    return action_replay_epoll_recorder_t_internal(
+        CONSTRUCT,
+        object,
+        NULL,
+        args,
+        action_replay_epoll_recorder_t_start_func_t_start,
+        action_replay_epoll_recorder_t_stop_func_t_stop
+    );
+}
+
+static action_replay_return_t
+action_replay_epoll_recorder_t_destructor( void * const object )
+{
+    action_replay_epoll_recorder_t_state_t * const recorder_state =
+        ACTION_REPLAY_DYNAMIC(
+            action_replay_epoll_recorder_t_state_t *,
+            epoll_recorder_state,
+            object
+        );
+    action_replay_return_t result = { 0 };
+
+    if( NULL == recorder_state ) { return result; }
+    result = ACTION_REPLAY_DYNAMIC(
+            action_replay_stoppable_t_stop_func_t,
+            stop,
+            object
+        )( object );
+    if(( 0 != result.status ) && ( EALREADY != result.status ))
+    { return result; }
+    /* super calls stoppable_t destructor, which expects stoppable funcs */
+    ACTION_REPLAY_DYNAMIC(
+        action_replay_stoppable_t_start_func_t,
+        start,
+        object
+    ) = recorder_state->stoppable_start;
+    ACTION_REPLAY_DYNAMIC(
+        action_replay_stoppable_t_stop_func_t,
+        stop,
+        object
+    ) = recorder_state->stoppable_stop;
+    SUPER(
+        DESTRUCT,
+        action_replay_epoll_recorder_t_class,
+        object,
+        NULL,
+        action_replay_args_t_default_args()
+    );
+    result = action_replay_epoll_recorder_t_state_t_delete( recorder_state );
+    if( 0 == result.status )
+    {
+        ACTION_REPLAY_DYNAMIC(
+            action_replay_epoll_recorder_t_state_t *,
+            epoll_recorder_state,
+            object
+        ) = NULL;
+    }
+
+    return result;
+}
+
+static action_replay_return_t action_replay_epoll_recorder_t_copier(
+    void * const restrict copy,
+    void const * const restrict original
+)
+{
+    ( void ) copy;
+    ( void ) original;
+    return ( action_replay_return_t const ) { ENOSYS };
+}
+
+static action_replay_reflector_return_t
+action_replay_epoll_recorder_t_reflector(
+    char const * const restrict type,
+    char const * const restrict name
+)
+{
+#define ACTION_REPLAY_CURRENT_CLASS action_replay_epoll_recorder_t
+#include "action_replay/reflection_preparation.h"
+
+    static action_replay_reflection_entry_t const map[] =
+#include "action_replay/epoll_recorder.class"
+
+#undef ACTION_REPLAY_CLASS_DEFINITION
+#undef ACTION_REPLAY_CLASS_FIELD
+#undef ACTION_REPLAY_CLASS_METHOD
+#undef ACTION_REPLAY_CURRENT_CLASS
+
+    return action_replay_class_t_generic_reflector_logic(
+        type,
+        name,
+        map,
+        sizeof( map ) / sizeof( action_replay_reflection_entry_t )
+    );
+}
+
+static action_replay_error_t
+action_replay_epoll_recorder_t_worker( void * state );
+
+static action_replay_return_t action_replay_epoll_recorder_t_start_func_t_start(
+    action_replay_stoppable_t * const self,
+    action_replay_args_t const start_state
+)
+{
+    if(
+        ( NULL == self )
+        || ( NULL == start_state.state )
+        || ( ! action_replay_is_type(
+            ( void * ) self,
+            action_replay_epoll_recorder_t_class()
+        ))
+    ) { return ( action_replay_return_t const ) { EINVAL }; }
+
+    action_replay_epoll_recorder_t_state_t * const recorder_state =
+        ACTION_REPLAY_DYNAMIC(
+            action_replay_epoll_recorder_t_state_t *,
+            epoll_recorder_state,
+            self
+        );
+    action_replay_epoll_recorder_t_worker_state_t * const worker_state =
+        calloc( 1, sizeof( action_replay_epoll_recorder_t_worker_state_t ));
+
+    if( NULL == worker_state )
+    { return ( action_replay_return_t const ) { ENOMEM }; }
+
+    action_replay_epoll_recorder_t_start_state_t * const
+        recorder_start_state = start_state.state;
+    action_replay_time_t_converter_return_t const zero_time =
+        ACTION_REPLAY_DYNAMIC(
+            action_replay_time_t_converter_func_t,
+            converter,
+            recorder_start_state->zero_time
+        )( recorder_start_state->zero_time );
+    action_replay_return_t result;
+
+    if( 0 != ( result.status = zero_time.status ))
+    { goto handle_zero_time_conversion_error; }
+
+    action_replay_time_converter_t_return_t const zero_nanoseconds =
+        zero_time.converter->nanoseconds( zero_time.converter );
+
+    action_replay_delete( ( void * ) zero_time.converter );
+    if( 0 != ( result.status = zero_nanoseconds.status ))
+    { goto handle_zero_time_conversion_error; }
+    /* zero time is all that's needed of start_state, devices keep it */
+    result = action_replay_args_t_delete( start_state );
+    if( 0 != result.status )
+    {
+        free( worker_state );
+        return result;
+    }
+    for( size_t i = 0; i < recorder_state->device_count; ++i )
+    { recorder_state->devices[ i ].zero_time = zero_nanoseconds.value; }
+    worker_state->recorder_state = recorder_state;
+
+    result = recorder_state->stoppable_start(
+        self,
+        action_replay_stoppable_t_start_state(
+            action_replay_epoll_recorder_t_worker,
+            worker_state
+        )
+    );
+
+    /* at most one thread can succeed */
+    if( 0 == result.status )
+    {
+        recorder_state->worker_state = worker_state;
+        return result;
+    }
+    free( worker_state );
+    return result;
+
+handle_zero_time_conversion_error:
+    free( worker_state );
+    action_replay_args_t_delete( start_state );
+    return result;
+}
+
+/* flushes every device, keeps going past failures */
+static action_replay_error_t action_replay_epoll_recorder_t_flush(
+    action_replay_epoll_recorder_t_state_t * const recorder_state
+)
+{
+    action_replay_error_t result = 0;
+
+    for( size_t i = 0; i < recorder_state->device_count; ++i )
+    {
+        if( NULL == recorder_state->devices[ i ].output ) { continue; }
+
+        action_replay_error_t const flush_result =
+            action_replay_recorder_io_writer_flush(
+                &( recorder_state->devices[ i ].writer )
+            );
+
+        if( 0 != flush_result )
+        {
+            LOG(
+                "failure flushing events to %p",
+                recorder_state->devices[ i ].output
+            );
+            result = flush_result;
+        }
+    }
+
+    return result;
+}
+
+/* the shortest of device timeouts */
+static int action_replay_epoll_recorder_t_timeout(
+    action_replay_epoll_recorder_t_state_t const * const recorder_state
+)
+{
+    for( size_t i = 0; i < recorder_state->device_count; ++i )
+    {
+        if( NULL == recorder_state->devices[ i ].output ) { continue; }
+
+        int const timeout = action_replay_recorder_io_writer_timeout(
+            &( recorder_state->devices[ i ].writer )
+        );
+
+        if( ACTION_REPLAY_RECORDER_IO_INFINITE_WAIT != timeout )
+        { return timeout; }
+    }
+
+    return ACTION_REPLAY_RECORDER_IO_INFINITE_WAIT;
+}
+
+static action_replay_return_t action_replay_epoll_recorder_t_stop_func_t_stop(
+    action_replay_stoppable_t * const self
+)
+{
+    if(
+        ( NULL == self )
+        || ( ! action_replay_is_type(
+            ( void * ) self,
+            action_replay_epoll_recorder_t_class()
+        ))
+    ) { return ( action_replay_return_t const ) { EINVAL }; }
+
+    action_replay_epoll_recorder_t_state_t * const recorder_state =
+        ACTION_REPLAY_DYNAMIC(
+            action_replay_epoll_recorder_t_state_t *,
+            epoll_recorder_state,
+            self
+        );
+    action_replay_return_t result;
+    uint64_t value = 1;
+
+    /* force exit from epoll_wait */
+    if(( ssize_t ) sizeof( value ) > write(
+        recorder_state->stop_fd,
+        &value,
+        sizeof( value )
+    ))
+    {
+        LOG(
+            "failure forcing the worker %p thread to wake up",
+            recorder_state->worker_state
+        );
+        result.status = errno;
+        return result;
+    }
+    result = recorder_state->stoppable_stop( self );
+    /* so that a later start isn't stopped at once */
+    ( void ) ( read( recorder_state->stop_fd, &value, sizeof( value )));
+    /* at most one thread can succeed */
+    if( 0 != result.status ) { return result; }
+    /* not an error of stop(), later delete() flushes again */
+    action_replay_epoll_recorder_t_flush( recorder_state );
+    for( size_t i = 0; i < recorder_state->device_count; ++i )
+    {
+        LOG(
+            "device %p read %" PRIu64 " events in %" PRIu64 " reads",
+            recorder_state->devices[ i ].input,
+            recorder_state->devices[ i ].events_read,
+            recorder_state->devices[ i ].reads
+        );
+    }
+    free( recorder_state->worker_state );
+    recorder_state->worker_state = NULL;
+
+    return result;
+}
+
+static action_replay_error_t action_replay_epoll_recorder_t_device_record(
+    action_replay_epoll_recorder_t_device_t * const restrict device,
+    struct input_event * const restrict events
+)
+{
+    action_replay_recorder_io_read_return_t const read_result =
+        action_replay_recorder_io_read(
+            fileno( device->input ),
+            events,
+            ACTION_REPLAY_RECORDER_IO_EVENTS_PER_READ
+        );
+
+    if( 0 != read_result.status )
+    {
+        LOG( "failed read from %p", device->input );
+        return read_result.status;
+    }
+    ++( device->reads );
+    device->events_read += read_result.count;
+    for( size_t i = 0; i < read_result.count; ++i )
+    {
+        action_replay_error_t const result =
+            action_replay_recorder_io_write_event(
+                events[ i ],
+                &( device->zero_time ),
+                &( device->writer )
+            );
+
+        if( 0 != result )
+        {
+            LOG( "failure writing entry to %p", device->output );
+            return result;
+        }
+    }
+
+    return 0;
+}
+
+/* drops a failed device, what it recorded so far is kept */
+static void action_replay_epoll_recorder_t_device_drop(
+    action_replay_epoll_recorder_t_state_t * const restrict recorder_state,
+    action_replay_epoll_recorder_t_device_t * const restrict device
+)
+{
+    if( -1 == epoll_ctl(
+        recorder_state->epoll_fd,
+        EPOLL_CTL_DEL,
+        fileno( device->input ),
+        NULL
+    ))
+    {
+        LOG(
+            "failure removing device %p from epoll set, errno = %d",
+            device->input,
+            errno
+        );
+    }
+    LOG(
+        "dropping device %p after %" PRIu64 " events",
+        device->input,
+        device->events_read
+    );
+    if( 0 != action_replay_epoll_recorder_t_devices_close( device, 1 ))
+    { LOG( "failure closing device %p", device->input ); }
+    device->input = NULL;
+    device->output = NULL;
+    --( recorder_state->open_count );
+}
+
+static action_replay_error_t
+action_replay_epoll_recorder_t_worker( void * state )
+{
+    action_replay_epoll_recorder_t_worker_state_t * const worker_state =
+        state;
+    action_replay_epoll_recorder_t_state_t * const recorder_state =
+        worker_state->recorder_state;
+
+    ++( recorder_state->waits );
+
+    int const ready_count = epoll_wait(
+        recorder_state->epoll_fd,
+        worker_state->ready,
+        EPOLL_EVENTS_COUNT,
+        action_replay_epoll_recorder_t_timeout( recorder_state )
+    );
+
+    if( -1 == ready_count ) { return ( EINTR == errno ) ? EAGAIN : errno; }
+    /* inputs went idle, buffered events shouldn't wait for more */
+    if( 0 == ready_count )
+    {
+        action_replay_error_t const result =
+            action_replay_epoll_recorder_t_flush( recorder_state );
+
+        return ( 0 == result ) ? EAGAIN : result;
+    }
+    for( int i = 0; i < ready_count; ++i )
+    {
+        if( NULL == worker_state->ready[ i ].data.ptr )
+        {
+            LOG( "worker %p ordered to stop polling for events", worker_state );
+            return ECANCELED;
+        }
+    }
+    for( int i = 0; i < ready_count; ++i )
+    {
+        action_replay_epoll_recorder_t_device_t * const device =
+            worker_state->ready[ i ].data.ptr;
+        uint32_t const events = worker_state->ready[ i ].events;
+        action_replay_error_t result = EBADF;
+
+        if( 0 == ( events & EPOLLIN ))
+        {
+            LOG(
+                "failure polling for device %p in worker %p",
+                device->input,
+                worker_state
+            );
+        }
+        else
+        {
+            result = action_replay_epoll_recorder_t_device_record(
+                device,
+                worker_state->events
+            );
+        }
+        /* one failed device doesn't stop recording the others */
+        if( 0 != result )
+        {
+            action_replay_epoll_recorder_t_device_drop(
+                recorder_state,
+                device
+            );
+            if( 0 == recorder_state->open_count ) { return result; }
+        }
+    }
+
+    return EAGAIN;
+}
+
+static action_replay_return_t
+action_replay_epoll_recorder_t_start_state_destructor( void * const state )
+{
+    action_replay_epoll_recorder_t_start_state_t * const start_state = state;
+    action_replay_return_t result;
+
+    result.status = action_replay_delete( ( void * ) start_state->zero_time );
+    if( 0 == result.status ) { free( state ); }
+
+    return result;
+}
+
+static action_replay_stateful_return_t
+action_replay_epoll_recorder_t_start_state_copier( void * const state )
+{
+    action_replay_stateful_return_t result;
+
+    result.state =
+        calloc( 1, sizeof( action_replay_epoll_recorder_t_start_state_t ));
+    if( NULL == result.state )
+    {
+        result.status = ENOMEM;
+        return result;
+    }
+    result.status = 0;
+
+    action_replay_epoll_recorder_t_start_state_t * const copy = result.state;
+    action_replay_epoll_recorder_t_start_state_t const * const original =
+        state;
+
+    copy->zero_time = action_replay_copy(
+        ( void const * const ) original->zero_time
+    );
+    if( NULL != copy->zero_time ) { return result; }
+
+    result.status = errno;
+    free( result.state );
+    result.state = NULL;
+    return result;
+}
+
+action_replay_args_t action_replay_epoll_recorder_t_start_state(
+    action_replay_time_t const * const zero_time
+)
+{
+    action_replay_args_t result = action_replay_args_t_default_args();
+
+    action_replay_epoll_recorder_t_start_state_t start_state =
+    { action_replay_copy( ( void const * const ) zero_time ) };
+
+    if( NULL == start_state.zero_time ) { return result; }
+
+    action_replay_stateful_return_t copy =
+        action_replay_epoll_recorder_t_start_state_copier( &start_state );
+
+    copy.status =
+        action_replay_delete( ( void * const ) start_state.zero_time );
+    if( 0 == copy.status )
+    {
+        result = ( action_replay_args_t const ) {
+            copy.state,
+            action_replay_epoll_recorder_t_start_state_destructor,
+            action_replay_epoll_recorder_t_start_state_copier
+        };
+    }
+
+    return result;
+}
+
+action_replay_class_t const * action_replay_epoll_recorder_t_class( void )
+{
+    static action_replay_class_t_func_t const inheritance[] =
+    {
+        action_replay_stateful_object_t_class,
+        action_replay_stoppable_t_class,
+        NULL
+    };
+    static action_replay_reflection_cache_t reflection_cache;
+    static action_replay_class_t_ancestry_t ancestry;
+    static action_replay_class_t const result =
+    {
+        sizeof( action_replay_epoll_recorder_t ),
+        action_replay_epoll_recorder_t_constructor,
+        action_replay_epoll_recorder_t_destructor,
+        action_replay_epoll_recorder_t_copier,
+        action_replay_epoll_recorder_t_reflector,
+        &reflection_cache,
+        inheritance,
+        &ancestry,
+        NULL
+    };
+
+    return &result;
+}
+
+static void action_replay_epoll_recorder_t_paths_free(
+    char ** const paths,
+    size_t const count
+)
+{
+    if( NULL == paths ) { return; }
+    for( size_t i = 0; i < count; ++i ) { free( paths[ i ] ); }
+    free( paths );
+}
+
+static char ** action_replay_epoll_recorder_t_paths_copy(
+    char const * const * const paths,
+    size_t const count
+)
+{
+    char ** const result = calloc( count, sizeof( char * ));
+
+    if( NULL == result ) { return NULL; }
+    for( size_t i = 0; i < count; ++i )
+    {
+        result[ i ] = action_replay_strndup( paths[ i ], INPUT_MAX_LEN );
+        if( NULL == result[ i ] )
+        {
+            action_replay_epoll_recorder_t_paths_free( result, count );
+            return NULL;
+        }
+    }
+
+    return result;
+}
+
+static action_replay_return_t
+action_replay_epoll_recorder_t_args_t_destructor( void * const state )
+{
+    action_replay_epoll_recorder_t_args_t * const recorder_args = state;
+
+    action_replay_epoll_recorder_t_paths_free(
+        recorder_args->paths_to_input_devices,
+        recorder_args->count
+    );
+    action_replay_epoll_recorder_t_paths_free(
+        recorder_args->paths_to_outputs,
+        recorder_args->count
+    );
+    free( recorder_args );
+    return ( action_replay_return_t const ) { 0 };
+}
+
+static action_replay_stateful_return_t
+action_replay_epoll_recorder_t_args_t_copier( void * const state )
+{
+    action_replay_stateful_return_t result;
+
+    result.state =
+        calloc( 1, sizeof( action_replay_epoll_recorder_t_args_t ));
+    if( NULL == result.state )
+    {
+        result.status = ENOMEM;
+        return result;
+    }
+
+    action_replay_epoll_recorder_t_args_t * const recorder_args =
+        result.state;
+    action_replay_epoll_recorder_t_args_t const * const
+        original_recorder_args = state;
+
+    recorder_args->count = original_recorder_args->count;
+    recorder_args->format = original_recorder_args->format;
+    recorder_args->paths_to_input_devices =
+        action_replay_epoll_recorder_t_paths_copy(
+            ( char const * const * ) (
+                original_recorder_args->paths_to_input_devices
+            ),
+            original_recorder_args->count
+        );
+    if( NULL == recorder_args->paths_to_input_devices )
+    {
+        result.status = errno;
+        goto handle_paths_to_input_devices_copy_error;
+    }
+    recorder_args->paths_to_outputs =
+        action_replay_epoll_recorder_t_paths_copy(
+            ( char const * const * ) original_recorder_args->paths_to_outputs,
+            original_recorder_args->count
+        );
+    if( NULL != recorder_args->paths_to_outputs )
+    {
+        result.status = 0;
+        return result;
+    }
+
+    result.status = errno;
+    action_replay_epoll_recorder_t_paths_free(
+        recorder_args->paths_to_input_devices,
+        recorder_args->count
+    );
+handle_paths_to_input_devices_copy_error:
+    free( result.state );
+    result.state = NULL;
+    return result;
+}
+
+action_replay_args_t action_replay_epoll_recorder_t_args(
+    size_t const count,
+    char const * const * const restrict paths_to_input_devices,
+    char const * const * const restrict paths_to_outputs,
+    action_replay_recorder_io_format_t const format
+)
+{
+    action_replay_args_t result = action_replay_args_t_default_args();
+
+    if(
+        ( 0 == count )
+        || ( NULL == paths_to_input_devices )
+        || ( NULL == paths_to_outputs )
+    ) { return result; }
+
+    /* copier doesn't modify the paths */
+    action_replay_epoll_recorder_t_args_t args =
+    {
+        count,
+        ( char ** ) paths_to_input_devices,
+        ( char ** ) paths_to_outputs,
+        format
+    };
+    action_replay_stateful_return_t const copy =
+        action_replay_epoll_recorder_t_args_t_copier( &args );
+
+    if( 0 == copy.status )
+    {
+        result = ( action_replay_args_t const )
+        {
+            copy.state,
+            action_replay_epoll_recorder_t_args_t_destructor,
+            action_replay_epoll_recorder_t_args_t_copier
+        };
+    }
+
+    return result;
+}
+
+action_replay_epoll_recorder_t_stats_return_t
+action_replay_epoll_recorder_t_stats(
+    action_replay_epoll_recorder_t * const recorder
+)
+{
+    if(
+        ( NULL == recorder )
+        || ( ! action_replay_is_type(
+            ( void * ) recorder,
+            action_replay_epoll_recorder_t_class()
+        ))
+    )
+    {
+        return ( action_replay_epoll_recorder_t_stats_return_t const )
+        { EINVAL, 0 };
+    }
+
+    return ( action_replay_epoll_recorder_t_stats_return_t const )
+    {
+        0,
+        ACTION_REPLAY_DYNAMIC(
+            action_replay_epoll_recorder_t_state_t *,
+            epoll_recorder_state,
+            recorder
+        )->waits
+    };
+}
@@ -0,0 +1,229 @@
+#define _POSIX_C_SOURCE 200809L /* pthread_condattr_setclock */
+
+#include "action_replay/event_ring.h"
+#include "action_replay/limits.h"
+#include "action_replay/nanoseconds.h"
+#include "action_replay/return.h"
+#include "action_replay/stdbool.h"
+#include "action_replay/stddef.h"
+#include "action_replay/stdint.h"
+#include <errno.h>
+#include <linux/input.h>
+#include <opa_primitives.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NANOSECONDS_IN_MILLISECOND 1000000
+
+/* timed waits are measured with nanoseconds_monotonic_now() */
+#if HAVE_CLOCK_GETTIME && defined( CLOCK_MONOTONIC )
+# define RING_CLOCK CLOCK_MONOTONIC
+#else /* no monotonic clock */
+# define RING_CLOCK CLOCK_REALTIME
+#endif /* HAVE_CLOCK_GETTIME && CLOCK_MONOTONIC */
+
+static inline size_t action_replay_event_ring_t_used(
+    action_replay_event_ring_t const * const ring,
+    int const head,
+    int const tail
+)
+{ return ( size_t ) (( tail - head + ring->size ) % ring->size ); }
+
+action_replay_return_t action_replay_event_ring_t_init(
+    action_replay_event_ring_t * const ring,
+    size_t const capacity
+)
+{
+    action_replay_return_t result = { EINVAL };
+
+    if(( 0 == capacity ) || ( INT_MAX - 1 < capacity )) { return result; }
+    ring->events = calloc( capacity + 1, sizeof( struct input_event ));
+    if( NULL == ring->events )
+    {
+        result.status = ENOMEM;
+        return result;
+    }
+    ring->size = ( int ) ( capacity + 1 );
+
+    pthread_condattr_t attributes;
+
+    if( 0 != ( result.status = pthread_condattr_init( &attributes )))
+    { goto handle_condattr_init_error; }
+    result.status = pthread_condattr_setclock( &attributes, RING_CLOCK );
+    if( 0 == result.status )
+    {
+        result.status =
+            pthread_cond_init( &( ring->condition ), &attributes );
+    }
+    pthread_condattr_destroy( &attributes );
+    if( 0 != result.status ) { goto handle_cond_init_error; }
+    result.status = pthread_mutex_init( &( ring->mutex ), NULL );
+    if( 0 != result.status ) { goto handle_mutex_init_error; }
+    action_replay_event_ring_t_reset( ring );
+    ring->pushed = 0;
+    ring->dropped = 0;
+    ring->high_water_mark = 0;
+    ring->wakes = 0;
+    ring->sleeps = 0;
+
+    return result;
+
+handle_mutex_init_error:
+    pthread_cond_destroy( &( ring->condition ));
+handle_cond_init_error:
+handle_condattr_init_error:
+    free( ring->events );
+    ring->events = NULL;
+    return result;
+}
+
+action_replay_return_t
+action_replay_event_ring_t_destroy( action_replay_event_ring_t * const ring )
+{
+    action_replay_return_t result;
+
+    result.status = pthread_cond_destroy( &( ring->condition ));
+    if( 0 != result.status ) { return result; }
+    result.status = pthread_mutex_destroy( &( ring->mutex ));
+    if( 0 != result.status ) { return result; }
+    free( ring->events );
+    ring->events = NULL;
+
+    return result;
+}
+
+static inline void
+action_replay_event_ring_t_wake( action_replay_event_ring_t * const ring )
+{
+    pthread_mutex_lock( &( ring->mutex ));
+    pthread_cond_signal( &( ring->condition ));
+    pthread_mutex_unlock( &( ring->mutex ));
+}
+
+size_t action_replay_event_ring_t_push(
+    action_replay_event_ring_t * const restrict ring,
+    struct input_event const * const restrict events,
+    size_t const count
+)
+{
+    int const tail = OPA_load_int( &( ring->tail ));
+    size_t const used = action_replay_event_ring_t_used(
+        ring,
+        OPA_load_acquire_int( &( ring->head )),
+        tail
+    );
+    size_t const free_slots = ( size_t ) ring->size - 1 - used;
+    size_t const pushed = ( count < free_slots ) ? count : free_slots;
+
+    for( size_t i = 0; i < pushed; ++i )
+    { ring->events[ ( tail + ( int ) i ) % ring->size ] = events[ i ]; }
+    ring->pushed += pushed;
+    ring->dropped += count - pushed;
+    if( used + pushed > ring->high_water_mark )
+    { ring->high_water_mark = used + pushed; }
+    if( 0 == pushed ) { return pushed; }
+    OPA_store_release_int(
+        &( ring->tail ),
+        ( tail + ( int ) pushed ) % ring->size
+    );
+    /* pairs with the barrier in wait(), one side sees the other's store */
+    OPA_read_write_barrier();
+    if( 0 != OPA_load_int( &( ring->sleeping )))
+    {
+        ++( ring->wakes );
+        action_replay_event_ring_t_wake( ring );
+    }
+
+    return pushed;
+}
+
+void action_replay_event_ring_t_close( action_replay_event_ring_t * const ring )
+{
+    OPA_store_release_int( &( ring->closed ), 1 );
+    OPA_read_write_barrier();
+    action_replay_event_ring_t_wake( ring );
+}
+
+size_t action_replay_event_ring_t_pop(
+    action_replay_event_ring_t * const restrict ring,
+    struct input_event * const restrict buffer,
+    size_t const max_count
+)
+{
+    int const head = OPA_load_int( &( ring->head ));
+    size_t const used = action_replay_event_ring_t_used(
+        ring,
+        head,
+        OPA_load_acquire_int( &( ring->tail ))
+    );
+    size_t const popped = ( max_count < used ) ? max_count : used;
+
+    for( size_t i = 0; i < popped; ++i )
+    { buffer[ i ] = ring->events[ ( head + ( int ) i ) % ring->size ]; }
+    if( 0 < popped )
+    {
+        OPA_store_release_int(
+            &( ring->head ),
+            ( head + ( int ) popped ) % ring->size
+        );
+    }
+
+    return popped;
+}
+
+bool action_replay_event_ring_t_is_closed(
+    action_replay_event_ring_t * const ring
+)
+{ return ( 0 != OPA_load_acquire_int( &( ring->closed ))); }
+
+action_replay_error_t action_replay_event_ring_t_wait(
+    action_replay_event_ring_t * const ring,
+    int const timeout_milliseconds
+)
+{
+    action_replay_error_t result = 0;
+
+    pthread_mutex_lock( &( ring->mutex ));
+    OPA_store_int( &( ring->sleeping ), 1 );
+    OPA_read_write_barrier();
+    if(
+        ( OPA_load_int( &( ring->head )) == OPA_load_int( &( ring->tail )))
+        && ( 0 == OPA_load_int( &( ring->closed )))
+    )
+    {
+        ++( ring->sleeps );
+        if( 0 > timeout_milliseconds )
+        {
+            result =
+                pthread_cond_wait( &( ring->condition ), &( ring->mutex ));
+        }
+        else
+        {
+            struct timespec const deadline =
+                action_replay_nanoseconds_to_timespec(
+                    action_replay_nanoseconds_monotonic_now()
+                    + ( uint64_t ) timeout_milliseconds
+                    * NANOSECONDS_IN_MILLISECOND
+                );
+
+            result = pthread_cond_timedwait(
+                &( ring->condition ),
+                &( ring->mutex ),
+                &deadline
+            );
+        }
+    }
+    OPA_store_int( &( ring->sleeping ), 0 );
+    pthread_mutex_unlock( &( ring->mutex ));
+
+    return result;
+}
+
+void action_replay_event_ring_t_reset( action_replay_event_ring_t * const ring )
+{
+    OPA_store_int( &( ring->head ), 0 );
+    OPA_store_int( &( ring->tail ), 0 );
+    OPA_store_int( &( ring->sleeping ), 0 );
+    OPA_store_int( &( ring->closed ), 0 );
+}
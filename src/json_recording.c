@@ -0,0 +1,421 @@
+#define JSMN_STRICT /* jsmn parses only valid JSON */
+
+#include "action_replay/json_recording.h"
+#include "action_replay/line_scan.h"
+#include "action_replay/log.h"
+#include "action_replay/return.h"
+#include "action_replay/stdbool.h"
+#include "action_replay/stddef.h"
+#include "action_replay/stdint.h"
+#include "action_replay/strndup.h"
+#include <errno.h>
+#include <jsmn.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* header must be JSON: { "file": "<path>" } */
+#define HEADER_JSON_TOKENS_COUNT 3
+
+#define INPUT_JSON_TOKENS_COUNT 9
+#define INPUT_JSON_TIME_TOKEN 2
+#define INPUT_JSON_TYPE_TOKEN 4
+#define INPUT_JSON_CODE_TOKEN 6
+#define INPUT_JSON_VALUE_TOKEN 8
+
+/* lines split by one scan */
+#define LINES_PER_SCAN 256
+#define INITIAL_RECORDS_CAPACITY 4096
+
+/* most digits which can't overflow, longer numbers go through jsmn */
+#define TIME_MAX_DIGITS 19
+#define UINT16_MAX_DIGITS 5
+#define INT32_MAX_DIGITS 10
+
+static inline bool action_replay_json_recording_literal(
+    char const ** const restrict cursor,
+    char const * const restrict end,
+    char const * const restrict literal,
+    size_t const length
+)
+{
+    if(
+        (( size_t ) ( end - *cursor ) < length )
+        || ( 0 != memcmp( *cursor, literal, length ))
+    ) { return false; }
+    *cursor += length;
+
+    return true;
+}
+
+#define LITERAL( cursor, end, literal ) \
+    action_replay_json_recording_literal( \
+        cursor, \
+        end, \
+        literal, \
+        sizeof( literal ) - 1 \
+    )
+
+static inline bool action_replay_json_recording_digits(
+    char const ** const restrict cursor,
+    char const * const restrict end,
+    unsigned int const max_digits,
+    uint64_t * const restrict value
+)
+{
+    char const * const start = *cursor;
+    uint64_t result = 0;
+
+    while(( end > *cursor ) && ( '0' <= **cursor ) && ( '9' >= **cursor ))
+    {
+        if( max_digits == ( unsigned int ) ( *cursor - start )) { return false; }
+        result = result * 10 + ( uint64_t ) ( **cursor - '0' );
+        ++( *cursor );
+    }
+    *value = result;
+
+    return start != *cursor;
+}
+
+/* false if line isn't exactly in recorder's format */
+static bool action_replay_json_recording_parse_line_fast(
+    char const * const restrict buffer,
+    size_t const buffer_length,
+    action_replay_json_recording_return_t * const restrict result
+)
+{
+    char const * cursor = buffer;
+    char const * const end = buffer + buffer_length;
+    uint64_t delay;
+    uint64_t type;
+    uint64_t code;
+    uint64_t value;
+
+    if(
+        ( ! LITERAL( &cursor, end, "{ \"time\": " ))
+        || ( ! action_replay_json_recording_digits(
+            &cursor,
+            end,
+            TIME_MAX_DIGITS,
+            &delay
+        ))
+        || ( ! LITERAL( &cursor, end, ", \"type\": " ))
+        || ( ! action_replay_json_recording_digits(
+            &cursor,
+            end,
+            UINT16_MAX_DIGITS,
+            &type
+        ))
+        || ( UINT16_MAX < type )
+        || ( ! LITERAL( &cursor, end, ", \"code\": " ))
+        || ( ! action_replay_json_recording_digits(
+            &cursor,
+            end,
+            UINT16_MAX_DIGITS,
+            &code
+        ))
+        || ( UINT16_MAX < code )
+        || ( ! LITERAL( &cursor, end, ", \"value\": " ))
+    ) { return false; }
+
+    bool const negative = LITERAL( &cursor, end, "-" );
+
+    if(
+        ( ! action_replay_json_recording_digits(
+            &cursor,
+            end,
+            INT32_MAX_DIGITS,
+            &value
+        ))
+        || ( ! LITERAL( &cursor, end, " }" ))
+        || ( value > ( negative
+            ? ( uint64_t ) INT32_MAX + 1
+            : ( uint64_t ) INT32_MAX
+        ))
+    ) { return false; }
+    if(( end > cursor ) && ( '\n' == *cursor )) { ++cursor; }
+    if( end != cursor ) { return false; }
+
+    result->status = 0;
+    result->delay = delay;
+    result->type = ( uint16_t ) type;
+    result->code = ( uint16_t ) code;
+    result->value = negative
+        ? ( int32_t ) ( -( int64_t ) value )
+        : ( int32_t ) value;
+
+    return true;
+}
+
+action_replay_json_recording_return_t
+action_replay_json_recording_parse_line_generic(
+    char const * const buffer,
+    size_t const buffer_length
+)
+{
+    action_replay_json_recording_return_t result = { EINVAL, 0, 0, 0, 0 };
+    jsmntok_t tokens[ INPUT_JSON_TOKENS_COUNT ];
+    jsmn_parser parser;
+
+    jsmn_init( &parser );
+
+    jsmnerr_t const parse_result = jsmn_parse(
+        &parser,
+        buffer,
+        buffer_length,
+        tokens,
+        INPUT_JSON_TOKENS_COUNT
+    );
+
+    if( INPUT_JSON_TOKENS_COUNT != parse_result ) { return result; }
+    result.status = 0;
+    result.delay = strtoull(
+        buffer + tokens[ INPUT_JSON_TIME_TOKEN ].start,
+        NULL,
+        10
+    );
+    result.type = ( uint16_t ) strtoul(
+        buffer + tokens[ INPUT_JSON_TYPE_TOKEN ].start,
+        NULL,
+        10
+    );
+    result.code = ( uint16_t ) strtoul(
+        buffer + tokens[ INPUT_JSON_CODE_TOKEN ].start,
+        NULL,
+        10
+    );
+    result.value = ( int32_t ) strtol(
+        buffer + tokens[ INPUT_JSON_VALUE_TOKEN ].start,
+        NULL,
+        10
+    );
+
+    return result;
+}
+
+action_replay_json_recording_return_t action_replay_json_recording_parse_line(
+    char const * const buffer,
+    size_t const buffer_length
+)
+{
+    action_replay_json_recording_return_t result;
+
+    if( action_replay_json_recording_parse_line_fast(
+        buffer,
+        buffer_length,
+        &result
+    )) { return result; }
+
+    return action_replay_json_recording_parse_line_generic(
+        buffer,
+        buffer_length
+    );
+}
+
+action_replay_json_recording_chunk_return_t
+action_replay_json_recording_parse_chunk(
+    char const * const restrict buffer,
+    size_t const buffer_length,
+    action_replay_binary_recording_record_t * const restrict records,
+    size_t const records_capacity
+)
+{
+    action_replay_json_recording_chunk_return_t result = { 0, 0, 0 };
+    action_replay_line_scan_line_t lines[ LINES_PER_SCAN ];
+
+    while(
+        ( buffer_length > result.length )
+        && ( records_capacity > result.count )
+    )
+    {
+        /* comments take no record, so records can't overflow */
+        size_t const room = records_capacity - result.count;
+        size_t const lines_count = action_replay_line_scan_lines(
+            buffer + result.length,
+            buffer_length - result.length,
+            lines,
+            ( LINES_PER_SCAN > room ) ? room : LINES_PER_SCAN
+        );
+
+        for( size_t i = 0; i < lines_count; ++i )
+        {
+            if( lines[ i ].comment ) { continue; }
+
+            action_replay_json_recording_return_t const line =
+                action_replay_json_recording_parse_line(
+                    lines[ i ].start,
+                    lines[ i ].length
+                );
+
+            if( 0 != ( result.status = line.status )) { return result; }
+            records[ result.count++ ] =
+                ( action_replay_binary_recording_record_t const )
+                { line.delay, line.type, line.code, line.value };
+        }
+        result.length = ( size_t ) (
+            lines[ lines_count - 1 ].start
+            + lines[ lines_count - 1 ].length
+            - buffer
+        );
+    }
+
+    return result;
+}
+
+action_replay_json_recording_lines_return_t
+action_replay_json_recording_parse_lines(
+    char const * const buffer,
+    size_t const buffer_length
+)
+{
+    action_replay_json_recording_lines_return_t result = { 0, NULL, 0 };
+    size_t capacity = 0;
+    size_t offset = 0;
+
+    while( buffer_length > offset )
+    {
+        if( capacity == result.count )
+        {
+            size_t const new_capacity = ( 0 == capacity )
+                ? INITIAL_RECORDS_CAPACITY
+                : capacity * 2;
+            action_replay_binary_recording_record_t * const records =
+                realloc(
+                    result.records,
+                    new_capacity
+                        * sizeof( action_replay_binary_recording_record_t )
+                );
+
+            if( NULL == records )
+            {
+                result.status = ENOMEM;
+                goto handle_error;
+            }
+            result.records = records;
+            capacity = new_capacity;
+        }
+
+        action_replay_json_recording_chunk_return_t const chunk =
+            action_replay_json_recording_parse_chunk(
+                buffer + offset,
+                buffer_length - offset,
+                result.records + result.count,
+                capacity - result.count
+            );
+
+        if( 0 != ( result.status = chunk.status )) { goto handle_error; }
+        result.count += chunk.count;
+        offset += chunk.length;
+    }
+
+    return result;
+
+handle_error:
+    free( result.records );
+    result.records = NULL;
+    result.count = 0;
+    return result;
+}
+
+/* with newline, last line of buffer may have none */
+static inline size_t action_replay_json_recording_line_length(
+    char const * const buffer,
+    size_t const buffer_length
+)
+{
+    size_t const newline =
+        action_replay_line_scan_newline( buffer, buffer_length );
+
+    return ( buffer_length == newline ) ? buffer_length : newline + 1;
+}
+
+/* returns offset of first line which isn't a comment */
+static size_t action_replay_json_recording_skip_comments(
+    char const * const buffer,
+    size_t const buffer_length
+)
+{
+    size_t offset = 0;
+
+    while(
+        ( buffer_length > offset + 1 )
+        && ( ACTION_REPLAY_LINE_SCAN_COMMENT_SYMBOL == buffer[ offset ] )
+    )
+    {
+        offset += action_replay_json_recording_line_length(
+            buffer + offset,
+            buffer_length - offset
+        );
+    }
+
+    return offset;
+}
+
+action_replay_json_recording_header_return_t
+action_replay_json_recording_parse_header(
+    char const * const buffer,
+    size_t const buffer_length
+)
+{
+    action_replay_json_recording_header_return_t result = { EINVAL, NULL, 0 };
+    size_t const header_offset =
+        action_replay_json_recording_skip_comments( buffer, buffer_length );
+
+    if( buffer_length == header_offset )
+    {
+        LOG( "failure reading header from input file" );
+        return result;
+    }
+
+    char const * const header = buffer + header_offset;
+    size_t const header_length = action_replay_json_recording_line_length(
+        header,
+        buffer_length - header_offset
+    );
+    jsmn_parser parser;
+    jsmntok_t tokens[ HEADER_JSON_TOKENS_COUNT ];
+
+    jsmn_init( &parser );
+
+    jsmnerr_t const parse_result = jsmn_parse(
+        &parser,
+        header,
+        header_length,
+        tokens,
+        HEADER_JSON_TOKENS_COUNT
+    );
+
+    if( HEADER_JSON_TOKENS_COUNT != parse_result )
+    {
+        LOG(
+            "failure parsing JSON, buffer = %.*s",
+            ( int ) header_length,
+            header
+        );
+        return result;
+    }
+
+    jsmntok_t const path_token = tokens[ HEADER_JSON_TOKENS_COUNT - 1 ];
+
+    if( JSMN_STRING != path_token.type )
+    {
+        LOG( "path has wrong token type" );
+        return result;
+    }
+    result.path = action_replay_strndup(
+        header + path_token.start,
+        ( size_t ) ( path_token.end - path_token.start )
+    );
+    if( NULL == result.path )
+    {
+        result.status = ENOMEM;
+        return result;
+    }
+    result.status = 0;
+    result.events_offset = header_offset + header_length
+        + action_replay_json_recording_skip_comments(
+            header + header_length,
+            buffer_length - header_offset - header_length
+        );
+
+    return result;
+}
@@ -0,0 +1,394 @@
+#include "action_replay/error.h"
+#include "action_replay/line_scan.h"
+#include "action_replay/stdbool.h"
+#include "action_replay/stddef.h"
+#include "action_replay/stdint.h"
+#include <errno.h>
+#include <opa_primitives.h>
+#include <string.h>
+
+#if defined( __GNUC__ ) \
+    && ( defined( __x86_64__ ) || defined( __i386__ )) \
+    && HAVE_IMMINTRIN_H
+# define LINE_SCAN_X86 1
+# include <immintrin.h>
+#else /* no x86 intrinsics */
+# define LINE_SCAN_X86 0
+#endif /* __GNUC__ && x86 && HAVE_IMMINTRIN_H */
+
+/* SWAR masks assume first byte in memory is the lowest one */
+#if defined( __BYTE_ORDER__ ) && ( __ORDER_LITTLE_ENDIAN__ == __BYTE_ORDER__ )
+# define LINE_SCAN_SWAR 1
+#else /* unknown or big endian */
+# define LINE_SCAN_SWAR 0
+#endif /* __BYTE_ORDER__ */
+
+#define NEWLINES 0x0a0a0a0a0a0a0a0aULL
+#define LOW_SEVEN_BITS 0x7f7f7f7f7f7f7f7fULL
+#define BITS_IN_BYTE 8
+/* newline offsets found per call of an implementation */
+#define ENDS_PER_FIND 64
+#define NOT_SELECTED -1
+
+typedef size_t ( * action_replay_line_scan_find_func_t )(
+    char const * const restrict buffer,
+    size_t const buffer_length,
+    size_t * const restrict ends,
+    size_t const max_count
+);
+
+static inline unsigned int action_replay_line_scan_ctz( uint64_t const mask )
+{
+#if defined( __GNUC__ )
+    return ( unsigned int ) __builtin_ctzll( mask );
+#else /* ! __GNUC__ */
+    unsigned int result = 0;
+
+    while( 0 == (( mask >> result ) & 1 )) { ++result; }
+    return result;
+#endif /* __GNUC__ */
+}
+
+/* stores offsets of set bits, one bit per byte_width bytes from base */
+static inline size_t action_replay_line_scan_mask(
+    uint64_t mask,
+    unsigned int const byte_width,
+    size_t const base,
+    size_t * const restrict ends,
+    size_t count,
+    size_t const max_count
+)
+{
+    while(( 0 != mask ) && ( max_count > count ))
+    {
+        ends[ count++ ] =
+            base + action_replay_line_scan_ctz( mask ) / byte_width;
+        mask &= mask - 1;
+    }
+
+    return count;
+}
+
+static size_t action_replay_line_scan_find_scalar(
+    char const * const restrict buffer,
+    size_t const buffer_length,
+    size_t * const restrict ends,
+    size_t const max_count
+)
+{
+    size_t count = 0;
+
+    for( size_t i = 0; ( buffer_length > i ) && ( max_count > count ); ++i )
+    { if( '\n' == buffer[ i ] ) { ends[ count++ ] = i; } }
+
+    return count;
+}
+
+/* continues byte by byte from offset, after wide loads ran out */
+static inline size_t action_replay_line_scan_find_tail(
+    char const * const restrict buffer,
+    size_t const buffer_length,
+    size_t const offset,
+    size_t * const restrict ends,
+    size_t count,
+    size_t const max_count
+)
+{
+    for( size_t i = offset; ( buffer_length > i ) && ( max_count > count ); ++i )
+    { if( '\n' == buffer[ i ] ) { ends[ count++ ] = i; } }
+
+    return count;
+}
+
+#if LINE_SCAN_SWAR
+static size_t action_replay_line_scan_find_swar(
+    char const * const restrict buffer,
+    size_t const buffer_length,
+    size_t * const restrict ends,
+    size_t const max_count
+)
+{
+    size_t count = 0;
+    size_t i = 0;
+
+    for(
+        ;
+        ( buffer_length >= i + sizeof( uint64_t ) ) && ( max_count > count );
+        i += sizeof( uint64_t )
+    )
+    {
+        uint64_t word;
+
+        memcpy( &word, buffer + i, sizeof( word ));
+        word ^= NEWLINES;
+
+        /* high bit of each byte which was a newline, exact per byte */
+        uint64_t const mask = ~(
+            (( word & LOW_SEVEN_BITS ) + LOW_SEVEN_BITS )
+            | word
+            | LOW_SEVEN_BITS
+        );
+
+        count = action_replay_line_scan_mask(
+            mask,
+            BITS_IN_BYTE,
+            i,
+            ends,
+            count,
+            max_count
+        );
+    }
+
+    return action_replay_line_scan_find_tail(
+        buffer,
+        buffer_length,
+        i,
+        ends,
+        count,
+        max_count
+    );
+}
+#endif /* LINE_SCAN_SWAR */
+
+#if LINE_SCAN_X86
+__attribute__(( target( "sse2" )))
+static size_t action_replay_line_scan_find_sse2(
+    char const * const restrict buffer,
+    size_t const buffer_length,
+    size_t * const restrict ends,
+    size_t const max_count
+)
+{
+    __m128i const newlines = _mm_set1_epi8( '\n' );
+    size_t count = 0;
+    size_t i = 0;
+
+    for(
+        ;
+        ( buffer_length >= i + sizeof( __m128i )) && ( max_count > count );
+        i += sizeof( __m128i )
+    )
+    {
+        __m128i const bytes =
+            _mm_loadu_si128(( __m128i const * ) ( buffer + i ));
+
+        count = action_replay_line_scan_mask(
+            ( uint32_t ) _mm_movemask_epi8(
+                _mm_cmpeq_epi8( bytes, newlines )
+            ),
+            1,
+            i,
+            ends,
+            count,
+            max_count
+        );
+    }
+
+    return action_replay_line_scan_find_tail(
+        buffer,
+        buffer_length,
+        i,
+        ends,
+        count,
+        max_count
+    );
+}
+
+__attribute__(( target( "avx2" )))
+static size_t action_replay_line_scan_find_avx2(
+    char const * const restrict buffer,
+    size_t const buffer_length,
+    size_t * const restrict ends,
+    size_t const max_count
+)
+{
+    __m256i const newlines = _mm256_set1_epi8( '\n' );
+    size_t count = 0;
+    size_t i = 0;
+
+    for(
+        ;
+        ( buffer_length >= i + sizeof( __m256i )) && ( max_count > count );
+        i += sizeof( __m256i )
+    )
+    {
+        __m256i const bytes =
+            _mm256_loadu_si256(( __m256i const * ) ( buffer + i ));
+
+        count = action_replay_line_scan_mask(
+            ( uint32_t ) _mm256_movemask_epi8(
+                _mm256_cmpeq_epi8( bytes, newlines )
+            ),
+            1,
+            i,
+            ends,
+            count,
+            max_count
+        );
+    }
+
+    return action_replay_line_scan_find_tail(
+        buffer,
+        buffer_length,
+        i,
+        ends,
+        count,
+        max_count
+    );
+}
+#endif /* LINE_SCAN_X86 */
+
+/* NULL where compiler can't build it */
+static action_replay_line_scan_find_func_t const
+    implementations[ ACTION_REPLAY_LINE_SCAN_IMPLEMENTATIONS_COUNT ] =
+{
+    action_replay_line_scan_find_scalar,
+#if LINE_SCAN_SWAR
+    action_replay_line_scan_find_swar,
+#else /* ! LINE_SCAN_SWAR */
+    NULL,
+#endif /* LINE_SCAN_SWAR */
+#if LINE_SCAN_X86
+    action_replay_line_scan_find_sse2,
+    action_replay_line_scan_find_avx2
+#else /* ! LINE_SCAN_X86 */
+    NULL,
+    NULL
+#endif /* LINE_SCAN_X86 */
+};
+
+static char const * const
+    names[ ACTION_REPLAY_LINE_SCAN_IMPLEMENTATIONS_COUNT ] =
+{ "scalar", "swar", "sse2", "avx2" };
+
+/* any thread may pick it first, they all pick the same */
+static OPA_int_t selected = OPA_INT_T_INITIALIZER( NOT_SELECTED );
+
+static bool action_replay_line_scan_supported(
+    action_replay_line_scan_implementation_t const implementation
+)
+{
+    if( NULL == implementations[ implementation ] ) { return false; }
+#if LINE_SCAN_X86
+    __builtin_cpu_init();
+    if( ACTION_REPLAY_LINE_SCAN_SSE2 == implementation )
+    { return __builtin_cpu_supports( "sse2" ); }
+    if( ACTION_REPLAY_LINE_SCAN_AVX2 == implementation )
+    { return __builtin_cpu_supports( "avx2" ); }
+#endif /* LINE_SCAN_X86 */
+
+    return true;
+}
+
+action_replay_error_t action_replay_line_scan_use(
+    action_replay_line_scan_implementation_t const implementation
+)
+{
+    if(
+        ( 0 > ( int ) implementation )
+        || ( ACTION_REPLAY_LINE_SCAN_IMPLEMENTATIONS_COUNT <= implementation )
+    ) { return EINVAL; }
+    if( ! action_replay_line_scan_supported( implementation ))
+    { return ENOTSUP; }
+    OPA_store_int( &selected, ( int ) implementation );
+
+    return 0;
+}
+
+action_replay_line_scan_implementation_t
+action_replay_line_scan_implementation( void )
+{
+    int const current = OPA_load_int( &selected );
+
+    if( NOT_SELECTED != current )
+    { return ( action_replay_line_scan_implementation_t ) current; }
+
+    /* widest first, scalar always works */
+    int best = ACTION_REPLAY_LINE_SCAN_IMPLEMENTATIONS_COUNT - 1;
+
+    while( ! action_replay_line_scan_supported(
+        ( action_replay_line_scan_implementation_t ) best
+    )) { --best; }
+    OPA_store_int( &selected, best );
+
+    return ( action_replay_line_scan_implementation_t ) best;
+}
+
+char const * action_replay_line_scan_implementation_name(
+    action_replay_line_scan_implementation_t const implementation
+)
+{
+    if(
+        ( 0 > ( int ) implementation )
+        || ( ACTION_REPLAY_LINE_SCAN_IMPLEMENTATIONS_COUNT <= implementation )
+    ) { return NULL; }
+
+    return names[ implementation ];
+}
+
+static inline action_replay_line_scan_find_func_t
+action_replay_line_scan_find( void )
+{ return implementations[ action_replay_line_scan_implementation() ]; }
+
+size_t action_replay_line_scan_newline(
+    char const * const buffer,
+    size_t const buffer_length
+)
+{
+    size_t end;
+
+    return ( 0 == action_replay_line_scan_find()(
+        buffer,
+        buffer_length,
+        &end,
+        1
+    )) ? buffer_length : end;
+}
+
+size_t action_replay_line_scan_lines(
+    char const * const restrict buffer,
+    size_t const buffer_length,
+    action_replay_line_scan_line_t * const restrict lines,
+    size_t const max_count
+)
+{
+    action_replay_line_scan_find_func_t const find =
+        action_replay_line_scan_find();
+    size_t ends[ ENDS_PER_FIND ];
+    size_t count = 0;
+    size_t offset = 0;
+
+    while(( max_count > count ) && ( buffer_length > offset ))
+    {
+        size_t const wanted = ( ENDS_PER_FIND < max_count - count )
+            ? ENDS_PER_FIND
+            : max_count - count;
+        size_t const base = offset;
+        size_t const found =
+            find( buffer + base, buffer_length - base, ends, wanted );
+
+        for( size_t i = 0; i < found; ++i, ++count )
+        {
+            size_t const end = base + ends[ i ] + 1;
+
+            lines[ count ].start = buffer + offset;
+            lines[ count ].length = end - offset;
+            lines[ count ].comment =
+                ( ACTION_REPLAY_LINE_SCAN_COMMENT_SYMBOL == buffer[ offset ] );
+            offset = end;
+        }
+        if( wanted == found ) { continue; }
+        /* no newline left, rest of buffer is the last line */
+        if( buffer_length > offset )
+        {
+            lines[ count ].start = buffer + offset;
+            lines[ count ].length = buffer_length - offset;
+            lines[ count ].comment =
+                ( ACTION_REPLAY_LINE_SCAN_COMMENT_SYMBOL == buffer[ offset ] );
+            ++count;
+        }
+        break;
+    }
+
+    return count;
+}
@@ -0,0 +1,119 @@
+#define _POSIX_C_SOURCE 200112L /* clock_gettime, clock_nanosleep */
+
+#include "action_replay/error.h"
+#include "action_replay/nanoseconds.h"
+#include "action_replay/stddef.h"
+#include "action_replay/stdint.h"
+#include <errno.h>
+#if HAVE_SYS_TIME_H
+# include <sys/select.h>
+# include <sys/time.h>
+#endif /* HAVE_SYS_TIME_H */
+#if HAVE_TIME_H
+# include <time.h>
+#endif /* HAVE_TIME_H */
+
+#if HAVE_TIME_H && HAVE_CLOCK_GETTIME && defined( CLOCK_MONOTONIC )
+# define MONOTONIC_CLOCK 1
+#else /* no monotonic clock */
+# define MONOTONIC_CLOCK 0
+#endif /* HAVE_TIME_H && HAVE_CLOCK_GETTIME && CLOCK_MONOTONIC */
+
+uint64_t action_replay_nanoseconds_now( void )
+{
+#if HAVE_TIME_H && HAVE_CLOCK_GETTIME
+    struct timespec result;
+
+    if( 0 == clock_gettime( CLOCK_REALTIME, &result ))
+    { return action_replay_nanoseconds_from_timespec( result ); }
+#endif /* HAVE_TIME_H && HAVE_CLOCK_GETTIME */
+#if HAVE_SYS_TIME_H && HAVE_GETTIMEOFDAY
+    struct timeval fallback;
+
+    if( 0 == gettimeofday( &fallback, NULL ))
+    { return action_replay_nanoseconds_from_timeval( fallback ); }
+#endif /* HAVE_SYS_TIME_H && HAVE_GETTIMEOFDAY */
+
+    return 0;
+}
+
+uint64_t action_replay_nanoseconds_monotonic_now( void )
+{
+#if MONOTONIC_CLOCK
+    struct timespec result;
+
+    if( 0 == clock_gettime( CLOCK_MONOTONIC, &result ))
+    { return action_replay_nanoseconds_from_timespec( result ); }
+#endif /* MONOTONIC_CLOCK */
+
+    return action_replay_nanoseconds_now();
+}
+
+action_replay_error_t
+action_replay_nanoseconds_sleep_until( uint64_t const deadline )
+{
+#if MONOTONIC_CLOCK && HAVE_CLOCK_NANOSLEEP
+    struct timespec const value =
+        action_replay_nanoseconds_to_timespec( deadline );
+    int result;
+
+    /* absolute deadline, so restarting after a signal doesn't drift */
+    while( EINTR == ( result = clock_nanosleep(
+        CLOCK_MONOTONIC,
+        TIMER_ABSTIME,
+        &value,
+        NULL
+    )));
+
+    return result;
+#else /* ! ( MONOTONIC_CLOCK && HAVE_CLOCK_NANOSLEEP ) */
+    for( ;; )
+    {
+        action_replay_nanoseconds_return_t const remaining =
+            action_replay_nanoseconds_sub(
+                deadline,
+                action_replay_nanoseconds_monotonic_now()
+            );
+
+        if(( 0 != remaining.status ) || ( 0 == remaining.value ))
+        { return 0; }
+# if HAVE_TIME_H
+        struct timespec const value =
+            action_replay_nanoseconds_to_timespec( remaining.value );
+
+        if(( 0 != nanosleep( &value, NULL )) && ( EINTR != errno ))
+        { return errno; }
+# elif HAVE_SYS_TIME_H
+        struct timeval value =
+            action_replay_nanoseconds_to_timeval( remaining.value );
+
+        if(
+            ( 0 != select( 0, NULL, NULL, NULL, &value ))
+            && ( EINTR != errno )
+        ) { return errno; }
+# else /* no way to sleep */
+        return ENOTSUP;
+# endif /* HAVE_TIME_H */
+    }
+#endif /* MONOTONIC_CLOCK && HAVE_CLOCK_NANOSLEEP */
+}
+
+action_replay_error_t action_replay_nanoseconds_spin_until(
+    uint64_t const deadline,
+    uint64_t const spin_margin
+)
+{
+    action_replay_nanoseconds_return_t const wakeup =
+        action_replay_nanoseconds_sub( deadline, spin_margin );
+
+    if( 0 == wakeup.status )
+    {
+        action_replay_error_t const result =
+            action_replay_nanoseconds_sleep_until( wakeup.value );
+
+        if( 0 != result ) { return result; }
+    }
+    while( action_replay_nanoseconds_monotonic_now() < deadline );
+
+    return 0;
+}
@@ -60,6 +60,8 @@ static action_replay_reflector_return_t action_replay_object_t_reflector(
 action_replay_class_t const * action_replay_object_t_class( void )
 {
     static action_replay_class_t_func_t const inheritance[] = { NULL };
+    static action_replay_reflection_cache_t reflection_cache;
+    static action_replay_class_t_ancestry_t ancestry;
     static action_replay_class_t const result =
     {
         sizeof( action_replay_object_t ),
@@ -67,7 +69,10 @@ action_replay_class_t const * action_replay_object_t_class( void )
         action_replay_object_t_destructor,
         action_replay_object_t_copier,
         action_replay_object_t_reflector,
-        inheritance
+        &reflection_cache,
+        inheritance,
+        &ancestry,
+        NULL
     };
 
     return &result;
@@ -4,12 +4,31 @@
 #include "action_replay/error.h"
 #include "action_replay/object.h"
 #include "action_replay/object_oriented_programming.h"
+#include "action_replay/pool.h"
 #include "action_replay/return.h"
 #include "action_replay/stdbool.h"
 #include "action_replay/stddef.h"
+#include "action_replay/stdint.h"
 #include <errno.h>
 #include <stdlib.h>
 
+static inline void *
+action_replay_object_alloc( action_replay_class_t const * const _class )
+{
+    return ( NULL == _class->pool )
+        ? calloc( 1, _class->size )
+        : action_replay_pool_t_alloc( _class->pool );
+}
+
+static inline void action_replay_object_free(
+    action_replay_class_t const * const restrict _class,
+    void * const restrict object
+)
+{
+    if( NULL == _class->pool ) { free( object ); }
+    else { action_replay_pool_t_free( _class->pool, object ); }
+}
+
 void * action_replay_new(
     action_replay_class_t const * const _class,
     action_replay_args_t const args
@@ -21,7 +40,7 @@ void * action_replay_new(
         return NULL;
     }
 
-    void * object = calloc( 1, _class->size );
+    void * object = action_replay_object_alloc( _class );
 
     if( NULL == object )
     {
@@ -41,7 +60,7 @@ void * action_replay_new(
     action_replay_args_t_delete( args );
     if( 0 != ( errno = error ))
     {
-        free( object );
+        action_replay_object_free( _class, object );
         object = NULL;
     }
 
@@ -53,10 +72,11 @@ action_replay_delete( action_replay_object_t * const object )
 {
     if( NULL == object ) { return 0; }
 
+    action_replay_class_t const * const _class = object->_class;
     action_replay_error_t const result =
-        object->_class->destructor( object ).status;
+        _class->destructor( object ).status;
 
-    if( 0 == result ) { free( object ); }
+    if( 0 == result ) { action_replay_object_free( _class, object ); }
 
     return result;
 }
@@ -69,7 +89,7 @@ void * action_replay_copy( action_replay_object_t const * const object )
         return NULL;
     }
 
-    void * copy = calloc( 1, object->_class->size );
+    void * copy = action_replay_object_alloc( object->_class );
 
     if( NULL == copy )
     {
@@ -85,14 +105,14 @@ void * action_replay_copy( action_replay_object_t const * const object )
 
     if( 0 != ( errno = object->_class->copier( copy, object ).status ))
     {
-        free( copy );
+        action_replay_object_free( object->_class, copy );
         copy = NULL;
     }
 
     return copy;
 }
 
-/* not tail-recursive */
+/* not tail-recursive; used only for classes which couldn't be registered */
 static bool action_replay_is_type_internal(
     action_replay_class_t const * const object_class,
     action_replay_class_t const * const type_class
@@ -120,8 +140,24 @@ bool action_replay_is_type(
 )
 {
     if(( NULL == object ) || ( NULL == _class )) { return false; }
-
-    return action_replay_is_type_internal( object->_class, _class );
+    if( object->_class == _class ) { return true; }
+
+    action_replay_class_t_id_return_t const object_class =
+        action_replay_class_t_register( object->_class );
+    action_replay_class_t_id_return_t const type_class =
+        action_replay_class_t_register( _class );
+
+    if(( 0 != object_class.status ) || ( 0 != type_class.status ))
+    { return action_replay_is_type_internal( object->_class, _class ); }
+
+    return 0 != (
+        object->_class->ancestry->ancestors[
+            type_class.id / ACTION_REPLAY_CLASS_ANCESTRY_WORD_BITS
+        ]
+        & (( uint64_t ) 1 << (
+            type_class.id % ACTION_REPLAY_CLASS_ANCESTRY_WORD_BITS
+        ))
+    );
 }
 
 void const * action_replay_dynamic_get(
@@ -132,7 +168,11 @@ void const * action_replay_dynamic_get(
 {
     action_replay_object_t const * const object = pointer;
     action_replay_reflector_return_t const result =
-        object->_class->reflector( type, name );
+        action_replay_class_t_cached_reflector_logic(
+            object->_class,
+            type,
+            name
+        );
 
     assert( 0 == result.status );
 
@@ -141,3 +181,14 @@ void const * action_replay_dynamic_get(
     return base + result.offset;
 }
 
+action_replay_pool_t_stats_return_t
+action_replay_allocation_stats( action_replay_class_t const * const _class )
+{
+    if( NULL == _class )
+    {
+        return ( action_replay_pool_t_stats_return_t const )
+        { EINVAL, 0, 0, 0 };
+    }
+
+    return action_replay_pool_t_stats( _class->pool );
+}
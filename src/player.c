@@ -1,26 +1,32 @@
-#define JSMN_STRICT /* jsmn parses only valid JSON */
-#define _POSIX_C_SOURCE 200809L /* strntol, fileno */
+#define _POSIX_C_SOURCE 200809L /* strntol, fileno, fdopen */
+#define _DEFAULT_SOURCE /* madvise */
 
 #include "action_replay/args.h"
+#include "action_replay/binary_recording.h"
 #include "action_replay/class.h"
+#include "action_replay/compiled_recording.h"
 #include "action_replay/error.h"
 #include "action_replay/inttypes.h"
+#include "action_replay/json_recording.h"
+#include "action_replay/line_scan.h"
 #include "action_replay/log.h"
+#include "action_replay/nanoseconds.h"
 #include "action_replay/object_oriented_programming.h"
 #include "action_replay/object_oriented_programming_super.h"
 #include "action_replay/player.h"
 #include "action_replay/return.h"
 #include "action_replay/stateful_return.h"
+#include "action_replay/stdbool.h"
 #include "action_replay/stddef.h"
 #include "action_replay/stdint.h"
 #include "action_replay/stoppable.h"
 #include "action_replay/strndup.h"
 #include "action_replay/sys/types.h"
 #include "action_replay/time.h"
+#include "action_replay/uinput.h"
 #include "action_replay/workqueue.h"
 #include <errno.h>
 #include <fcntl.h>
-#include <jsmn.h>
 #include <linux/input.h>
 #include <linux/types.h>
 #include <opa_primitives.h>
@@ -29,52 +35,131 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
+#if HAVE_SYS_PRCTL_H
+# include <sys/prctl.h>
+#endif /* HAVE_SYS_PRCTL_H */
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <time.h>
 #include <unistd.h>
 
-#define COMMENT_SYMBOL '#'
+#define INPUT_MAX_LEN 1024
+#define UINPUT_NAME_PREFIX "action-replay "
+#define START_OF_FILE 0
 
-/* header must be JSON: { "file": "<path>" } */
-#define HEADER_JSON_TOKENS_COUNT 3
 /*
- * input line must be JSON:
- * { "time": <num>, "type": <num>, "code": <num>, "value": <num> }
+ * frames and events parsed ahead of queue's thread, parsing waits
+ * for it to write older ones when either runs out; powers of two,
+ * so ring positions survive counters wrapping around
+ */
+#define FRAMES_IN_FLIGHT 4096
+/* complete frames handed to queue together, with one wakeup */
+#define FRAMES_PER_PUT 64
+#define EVENTS_IN_FLIGHT ( 32 * 1024 )
+/* waits for room are short, so stop() isn't held up */
+#define ROOM_WAIT_MIN_NANOSECONDS 50000
+#define ROOM_WAIT_MAX_NANOSECONDS 10000000
+/* parsed input is dropped from memory in steps of this */
+#define RELEASE_LENGTH ( 4 * 1024 * 1024 )
+/*
+ * zero-delay events up to SYN_REPORT are written at once,
+ * longer runs are split
  */
-#define INPUT_JSON_TOKENS_COUNT 9
-#define INPUT_JSON_TIME_TOKEN 2
-#define INPUT_JSON_TYPE_TOKEN 4
-#define INPUT_JSON_CODE_TOKEN 6
-#define INPUT_JSON_VALUE_TOKEN 8
+#define FRAME_MAX_EVENTS 64
+/* lines split ahead of parsing by one scan */
+#define LINES_PER_SCAN 256
+/*
+ * text recordings are split into parts at least this long,
+ * but no longer than the other, which bounds what's parsed ahead
+ */
+#define PARSE_PART_MIN_LENGTH ( 1024 * 1024 )
+#define PARSE_PART_MAX_LENGTH ( 8 * 1024 * 1024 )
 
-#define INPUT_MAX_LEN 1024
-#define START_OF_FILE 0
+/* bucket n counts events later than 2^(n-1) us, but not 2^n us */
+#define LATENESS_HISTOGRAM_BUCKETS 16
+#define NANOSECONDS_IN_MICROSECOND 1000
 
 typedef struct {
     action_replay_time_t * zero_time;
+    uint64_t spin_margin;
+    bool timer_slack;
+    unsigned int parse_threads;
 } action_replay_player_t_start_state_t;
 
-typedef struct { char * path_to_input; } action_replay_player_t_args_t;
-
 typedef struct {
-    action_replay_time_t * zero_time;
-    action_replay_time_t_func_t add;
-    action_replay_time_t_func_t sub;
-    action_replay_time_t_converter_func_t converter;
-    FILE * output;
-    action_replay_time_converter_t const * sleep;
-    struct input_event event;
-} action_replay_player_t_worker_parse_state_t;
+    char * path_to_input;
+    bool uinput; /* replays into a virtual device instead of recorded one */
+} action_replay_player_t_args_t;
 
+/* only touched by queue's thread until it's joined or stopped */
 typedef struct {
+    uint64_t spin_margin; /* 0 sleeps straight until deadline */
+    bool timer_slack; /* minimal slack requested for queue's thread */
+    bool timer_slack_set;
+    uint64_t events;
+    uint64_t lateness; /* of last event, i.e. drift at the end of replay */
+    uint64_t max_lateness;
+    /* only events which waited for their deadline */
+    uint64_t lateness_histogram[ LATENESS_HISTOGRAM_BUCKETS ];
+} action_replay_player_t_timing_t;
+
+/* part of a text recording parsed ahead on its own thread */
+typedef struct {
+    pthread_t thread;
+    bool started; /* and not joined yet */
+    bool parsed;
+    char const * buffer;
+    size_t buffer_length;
+    action_replay_json_recording_lines_return_t lines;
+} action_replay_player_t_parse_job_t;
+
+typedef struct
+{
     action_replay_player_t_state_t * player_state;
-    action_replay_time_t * zero_time;
+    /* cumulative recording time, rebased onto the monotonic clock */
+    uint64_t deadline;
+    action_replay_player_t_timing_t timing;
     char const * buffer;
     size_t buffer_length;
-    uint64_t line;
-    action_replay_player_t_worker_parse_state_t * parse_states;
-    jsmntok_t tokens[ INPUT_JSON_TOKENS_COUNT ];
+    uint64_t frames; /* complete, queued in batches */
+    uint64_t items; /* queued */
+    uint64_t record; /* of binary recording, next to queue */
+    /* split from buffer, but not yet parsed */
+    action_replay_line_scan_line_t lines[ LINES_PER_SCAN ];
+    size_t lines_count;
+    size_t lines_next;
+    /* text after worker's own part of buffer, parsed by jobs in turns */
+    unsigned int parse_threads; /* 0 is one per online CPU */
+    bool split;
+    char const * rest; /* not handed to any job yet */
+    size_t rest_length;
+    size_t part_length;
+    action_replay_player_t_parse_job_t * jobs;
+    unsigned int jobs_count;
+    unsigned int job; /* being queued, jobs in file order follow it */
+    size_t job_record; /* next to queue */
+    /* input before it is parsed and dropped from memory */
+    char const * released;
+    /*
+     * frames shared with queue's thread, column by column; events of
+     * a frame follow those of the one before, slots are reused once
+     * queue's thread wrote them
+     */
+    uint64_t deadlines[ FRAMES_IN_FLIGHT ]; /* monotonic */
+    bool waits[ FRAMES_IN_FLIGHT ];
+    unsigned int events_ends[ FRAMES_IN_FLIGHT ]; /* events_reserved */
+    action_replay_workqueue_t_item_t queue_items[ FRAMES_IN_FLIGHT ];
+    uint16_t types[ EVENTS_IN_FLIGHT ];
+    uint16_t codes[ EVENTS_IN_FLIGHT ];
+    int32_t values[ EVENTS_IN_FLIGHT ];
+    unsigned int events_reserved; /* wraps around */
+    unsigned int frame_count; /* events of frame not complete yet */
+    OPA_int_t frames_done; /* stored by queue's thread */
+    OPA_int_t events_done; /* events_end of last frame written */
+    /* all this state, for put_many_items */
+    void * queue_states[ FRAMES_PER_PUT ];
+    /* queue's thread only, frame is put together in it for write() */
+    struct input_event frame_events[ FRAME_MAX_EVENTS ];
 } action_replay_player_t_worker_state_t;
 
 struct action_replay_player_t_state_t
@@ -86,18 +171,19 @@ struct action_replay_player_t_state_t
     action_replay_workqueue_t * queue;
     void const * input;
     FILE * output;
+    /* set for binary recordings, which need no parsing */
+    action_replay_binary_recording_record_t const * records;
+    size_t records_count;
+    bool binary;
+    /* replayed in place of text recording, mapping is NULL without it */
+    action_replay_compiled_recording_return_t compiled;
     OPA_ptr_t input_flag;
     pthread_cond_t condition;
     pthread_mutex_t mutex;
     size_t input_length;
+    size_t events_offset; /* of text recordings */
 };
 
-typedef struct {
-    action_replay_error_t status;
-    char const * buffer;
-    size_t buffer_length;
-} action_replay_player_t_skip_t;
-
 typedef enum {
     INPUT_IDLE,
     INPUT_PROCESSING,
@@ -108,11 +194,100 @@ static action_replay_player_t_input_flag_t input_idle = INPUT_IDLE;
 static action_replay_player_t_input_flag_t input_processing = INPUT_PROCESSING;
 static action_replay_player_t_input_flag_t input_finished = INPUT_FINISHED;
 
+/*
+ * parsed input isn't read again, so pages from the one holding start
+ * up to the one holding end leave memory; reading them later only
+ * maps them in again, returns where next release should start
+ */
+static char const * action_replay_player_t_release_input(
+    char const * const start,
+    char const * const end
+)
+{
+    uintptr_t const page_size = ( uintptr_t ) sysconf( _SC_PAGESIZE );
+    uintptr_t const first = ( uintptr_t ) start / page_size * page_size;
+    uintptr_t const last = ( uintptr_t ) end / page_size * page_size;
+
+    if( first >= last ) { return start; }
+    if( 0 != madvise(( void * ) first, last - first, MADV_DONTNEED ))
+    { LOG( "failure releasing parsed input, errno = %d", errno ); }
+
+    return ( char const * ) last;
+}
+
+/* readahead is worth it, parsing goes through input once */
+static void action_replay_player_t_advise_sequential(
+    void const * const mapping,
+    size_t const mapping_length
+)
+{
+    if( 0 != madvise(( void * ) mapping, mapping_length, MADV_SEQUENTIAL ))
+    { LOG( "failure advising sequential input, errno = %d", errno ); }
+}
+
 static FILE * action_replay_player_t_open_output_from_header(
-    char const * const buffer,
-    size_t const buffer_length
+    action_replay_player_t_state_t * const player_state,
+    bool const uinput
+);
+static FILE * action_replay_player_t_open_output_from_binary_header(
+    action_replay_player_t_state_t * const player_state,
+    bool const uinput
 );
 
+/* sidecar compiled from text recording is replayed instead, if valid */
+static void action_replay_player_t_open_compiled(
+    action_replay_player_t_state_t * const restrict player_state,
+    char const * const restrict path_to_input,
+    struct stat const * const restrict input_stat
+)
+{
+    action_replay_compiled_recording_return_t compiled =
+        action_replay_compiled_recording_open(
+            path_to_input,
+            input_stat,
+            player_state->input,
+            player_state->input_length
+        );
+
+    if( ESTALE == compiled.status )
+    {
+        LOG( "compiled %s is stale, rebuilding it", path_to_input );
+        if( 0 == action_replay_compiled_recording_write(
+            path_to_input,
+            input_stat,
+            player_state->input,
+            player_state->input_length
+        ))
+        {
+            compiled = action_replay_compiled_recording_open(
+                path_to_input,
+                input_stat,
+                player_state->input,
+                player_state->input_length
+            );
+        }
+    }
+    if( 0 != compiled.status )
+    {
+        if( ENOENT != compiled.status )
+        {
+            LOG(
+                "failure opening compiled %s, errno = %d, parsing it",
+                path_to_input,
+                compiled.status
+            );
+        }
+        return;
+    }
+    LOG( "replaying compiled %s", path_to_input );
+    action_replay_player_t_advise_sequential(
+        compiled.mapping,
+        compiled.mapping_length
+    );
+    player_state->compiled = compiled;
+    player_state->binary = true;
+}
+
 static action_replay_stateful_return_t action_replay_player_t_state_t_new(
     action_replay_args_t const args,
     action_replay_stoppable_t_start_func_t const start,
@@ -135,7 +310,11 @@ static action_replay_stateful_return_t action_replay_player_t_state_t_new(
     /* we control creation, so no reflection necessary */
     player_state->queue = action_replay_new(
         action_replay_workqueue_t_class(),
-        action_replay_workqueue_t_args()
+        action_replay_workqueue_t_args(
+            ACTION_REPLAY_WORKQUEUE_T_LOCKED,
+            ACTION_REPLAY_WORKQUEUE_T_RING_CAPACITY,
+            1
+        )
     );
 
     if( NULL == player_state->queue )
@@ -195,10 +374,31 @@ static action_replay_stateful_return_t action_replay_player_t_state_t_new(
         player_args->path_to_input,
         player_state->input
     );
-    player_state->output = action_replay_player_t_open_output_from_header(
+    action_replay_player_t_advise_sequential(
         player_state->input,
         player_state->input_length
     );
+    player_state->binary = action_replay_binary_recording_is(
+        player_state->input,
+        player_state->input_length
+    );
+    if( ! player_state->binary )
+    {
+        action_replay_player_t_open_compiled(
+            player_state,
+            player_args->path_to_input,
+            &input_stat
+        );
+    }
+    player_state->output = player_state->binary
+        ? action_replay_player_t_open_output_from_binary_header(
+            player_state,
+            player_args->uinput
+        )
+        : action_replay_player_t_open_output_from_header(
+            player_state,
+            player_args->uinput
+        );
     if( NULL == player_state->output )
     {
         result.status = EIO;
@@ -222,7 +422,14 @@ handle_pthread_mutex_error:
 handle_pthread_cond_error:
     fclose( player_state->output );
 handle_output_open_error:
-    /* we control the buffer, const can be dropped */
+    /* we control the buffers, const can be dropped */
+    if( NULL != player_state->compiled.mapping )
+    {
+        munmap(
+            ( void * ) player_state->compiled.mapping,
+            player_state->compiled.mapping_length
+        );
+    }
     munmap( ( void * ) player_state->input, player_state->input_length );
 handle_input_map_error:
 handle_input_stat_error:
@@ -248,6 +455,17 @@ static action_replay_return_t action_replay_player_t_state_t_delete(
     /* stop() called, mutex known to be unlocked */
     result.status = pthread_mutex_destroy( &( player_state->mutex ));
     if( 0 != result.status ) { return result; }
+    if(
+        ( NULL != player_state->compiled.mapping )
+        && ( -1 == munmap(
+            ( void * ) player_state->compiled.mapping,
+            player_state->compiled.mapping_length
+        ))
+    )
+    {
+        result.status = errno;
+        return result;
+    }
     if(
         -1 == munmap(
             ( void * ) player_state->input,
@@ -449,14 +667,10 @@ static action_replay_reflector_return_t action_replay_player_t_reflector(
 }
 
 static action_replay_error_t action_replay_player_t_worker( void * state );
-static action_replay_player_t_skip_t action_replay_player_t_skip_header(
-    char const * const input,
-    size_t const input_length
-);
-static action_replay_player_t_worker_parse_state_t *
-action_replay_player_t_prealloc_parse_states(
-    char const * const buffer,
-    size_t const buffer_length
+static action_replay_error_t
+action_replay_player_t_binary_worker( void * state );
+static void action_replay_player_t_worker_free_jobs(
+    action_replay_player_t_worker_state_t * const worker_state
 );
 
 static action_replay_return_t action_replay_player_t_start_func_t_start(
@@ -484,23 +698,40 @@ static action_replay_return_t action_replay_player_t_start_func_t_start(
     if( NULL == worker_state )
     { return ( action_replay_return_t const ) { ENOMEM }; }
 
-    worker_state->parse_states = action_replay_player_t_prealloc_parse_states(
-            player_state->input,
-            player_state->input_length
-        );
-
     action_replay_return_t result;
-
-    if( NULL == worker_state->parse_states )
-    {
-        result.status = ENOMEM;
-        goto handle_parse_states_alloc_error;
-    }
-
     action_replay_player_t_start_state_t * const player_start_state =
         start_state.state;
 
-    worker_state->zero_time = player_start_state->zero_time;
+    action_replay_time_t_converter_return_t const zero_time =
+        ACTION_REPLAY_DYNAMIC(
+            action_replay_time_t_converter_func_t,
+            converter,
+            player_start_state->zero_time
+        )( player_start_state->zero_time );
+
+    if( 0 != ( result.status = zero_time.status ))
+    { goto handle_zero_time_conversion_error; }
+
+    action_replay_time_converter_t_return_t const zero_nanoseconds =
+        zero_time.converter->nanoseconds( zero_time.converter );
+
+    action_replay_delete( ( void * ) zero_time.converter );
+    if( 0 != ( result.status = zero_nanoseconds.status ))
+    { goto handle_zero_time_conversion_error; }
+
+    /* zero_time is wall clock, but may be already behind us */
+    uint64_t const elapsed = action_replay_nanoseconds_sub(
+        action_replay_nanoseconds_now(),
+        zero_nanoseconds.value
+    ).value;
+
+    worker_state->deadline = action_replay_nanoseconds_sub(
+        action_replay_nanoseconds_monotonic_now(),
+        elapsed
+    ).value;
+    worker_state->timing.spin_margin = player_start_state->spin_margin;
+    worker_state->timing.timer_slack = player_start_state->timer_slack;
+    worker_state->parse_threads = player_start_state->parse_threads;
 
     result = player_state->queue->start( player_state->queue );
     if( 0 != result.status )
@@ -509,26 +740,34 @@ static action_replay_return_t action_replay_player_t_start_func_t_start(
         goto handle_queue_start_error;
     }
 
-    action_replay_player_t_skip_t skip = action_replay_player_t_skip_header(
-            player_state->input,
-            player_state->input_length
-        );
+    action_replay_stoppable_t_loop_iteration_func_t worker =
+        action_replay_player_t_binary_worker;
 
-    if( 0 != ( result.status = skip.status ))
+    worker_state->released = ( char const * ) player_state->records;
+    if( ! player_state->binary )
     {
-        LOG( "failure skipping header" );
-        goto handle_skip_header_error;
+        worker_state->buffer =
+            ( char const * ) player_state->input + player_state->events_offset;
+        worker_state->buffer_length =
+            player_state->input_length - player_state->events_offset;
+        worker_state->released = worker_state->buffer;
+        worker = action_replay_player_t_worker;
     }
     worker_state->player_state = player_state;
-    worker_state->buffer = skip.buffer;
-    worker_state->buffer_length = skip.buffer_length;
-    worker_state->line = 0;
+    worker_state->frames = 0;
+    worker_state->items = 0;
+    for( unsigned int i = 0; i < FRAMES_PER_PUT; ++i )
+    { worker_state->queue_states[ i ] = worker_state; }
+    worker_state->record = 0;
+    worker_state->lines_count = 0;
+    worker_state->lines_next = 0;
+    worker_state->events_reserved = 0;
+    worker_state->frame_count = 0;
+    OPA_store_int( &( worker_state->frames_done ), 0 );
+    OPA_store_int( &( worker_state->events_done ), 0 );
     result = player_state->stoppable_start(
         self,
-        action_replay_stoppable_t_start_state(
-            action_replay_player_t_worker,
-            worker_state
-        )
+        action_replay_stoppable_t_start_state( worker, worker_state )
     );
 
     /* at most one can succeed */
@@ -542,16 +781,42 @@ static action_replay_return_t action_replay_player_t_start_func_t_start(
         return result;
     }
 
-handle_skip_header_error:
     player_state->queue->stop( player_state->queue );
 handle_queue_start_error:
+handle_zero_time_conversion_error:
     /* XXX: possible leak */
     action_replay_args_t_delete( start_state );
-handle_parse_states_alloc_error:
     free( worker_state );
     return result;
 }
 
+static void action_replay_player_t_log_lateness_histogram(
+    action_replay_stoppable_t const * const restrict self,
+    action_replay_player_t_timing_t const * const restrict timing
+)
+{
+    for( unsigned int i = 0; i < LATENESS_HISTOGRAM_BUCKETS; ++i )
+    {
+        if( 0 == timing->lateness_histogram[ i ] ) { continue; }
+        if(( LATENESS_HISTOGRAM_BUCKETS - 1 ) == i )
+        {
+            LOG(
+                "player %p events late by %lu us or more: %" PRIu64,
+                ( void * ) self,
+                1UL << ( i - 1 ),
+                timing->lateness_histogram[ i ]
+            );
+            continue;
+        }
+        LOG(
+            "player %p events late by less than %lu us: %" PRIu64,
+            ( void * ) self,
+            1UL << i,
+            timing->lateness_histogram[ i ]
+        );
+    }
+}
+
 static action_replay_return_t action_replay_player_t_stop_func_t_internal(
     action_replay_stoppable_t * const self,
     action_replay_workqueue_t_func_t const queue_operation
@@ -575,10 +840,23 @@ static action_replay_return_t action_replay_player_t_stop_func_t_internal(
     result = player_state->stoppable_stop( self );
     /* at most one thread can succeed */
     if( 0 != result.status ) { return result; }
+
+    action_replay_player_t_timing_t const * const timing =
+        &( player_state->worker_state->timing );
+
+    LOG(
+        "player %p replayed %" PRIu64 " events, drift at end: %" PRIu64
+        " ns, max lateness: %" PRIu64 " ns",
+        ( void * ) self,
+        timing->events,
+        timing->lateness,
+        timing->max_lateness
+    );
+    action_replay_player_t_log_lateness_histogram( self, timing );
     /* XXX: possible leak */
     action_replay_args_t_delete( player_state->start_state );
     player_state->start_state = action_replay_args_t_default_args();
-    free( player_state->worker_state->parse_states );
+    action_replay_player_t_worker_free_jobs( player_state->worker_state );
     free( player_state->worker_state );
     player_state->worker_state = NULL;
 
@@ -665,399 +943,864 @@ action_replay_player_t_join_func_t_join( action_replay_player_t * const self )
     );
 }
 
-static action_replay_error_t
-action_replay_player_t_parse_line(
-    char const * const restrict buffer,
-    size_t const size,
-    uint64_t const line,
-    action_replay_player_t_worker_parse_state_t * const restrict parse_states,
-    action_replay_time_t * const restrict zero_time,
-    FILE * const restrict output,
-    jsmntok_t * const restrict tokens
-);
 static void action_replay_player_t_process_item( void * const state );
-static action_replay_player_t_skip_t action_replay_player_t_get_line(
-    char const * const buffer,
-    size_t const buffer_length
-);
-static action_replay_player_t_skip_t action_replay_player_t_skip_comments(
-    char const * const buffer,
-    size_t const buffer_length
-);
 
-static action_replay_error_t action_replay_player_t_worker( void * state )
+static action_replay_error_t action_replay_player_t_worker_finished(
+    action_replay_player_t_worker_state_t * const worker_state,
+    action_replay_error_t const result
+)
 {
-    action_replay_error_t result;
-    action_replay_player_t_worker_state_t * const worker_state = state;
-    action_replay_player_t_skip_t const skip =
-        action_replay_player_t_skip_comments(
-            worker_state->buffer,
-            worker_state->buffer_length
-        );
+    OPA_store_ptr(
+        &( worker_state->player_state->input_flag ),
+        &input_finished
+    );
+    pthread_cond_broadcast( &( worker_state->player_state->condition ));
+    return result;
+}
+
+/*
+ * queues complete frames, each item writes the oldest one; items are
+ * free again with their frames' slots, a batch stops at end of them
+ */
+static action_replay_error_t action_replay_player_t_worker_put_frames(
+    action_replay_player_t_worker_state_t * const worker_state
+)
+{
+    while( worker_state->frames > worker_state->items )
+    {
+        size_t const frame = worker_state->items % FRAMES_IN_FLIGHT;
+        uint64_t const count = worker_state->frames - worker_state->items;
+        size_t batch =
+            ( FRAMES_PER_PUT < count ) ? FRAMES_PER_PUT : ( size_t ) count;
+
+        if( FRAMES_IN_FLIGHT - frame < batch )
+        { batch = FRAMES_IN_FLIGHT - frame; }
+
+        action_replay_workqueue_t * const queue =
+            worker_state->player_state->queue;
+        action_replay_error_t const result = queue->put_many_items(
+            queue,
+            worker_state->queue_items + frame,
+            action_replay_player_t_process_item,
+            worker_state->queue_states,
+            batch
+        ).status;
 
-    if( 0 != ( result = skip.status )) { goto handle_do_not_repeat; }
-    worker_state->buffer = skip.buffer;
-    worker_state->buffer_length = skip.buffer_length;
+        if( 0 != result ) { return result; }
+        worker_state->items += batch;
+    }
 
-    if( 0 == worker_state->buffer_length )
-    { LOG( "parsing finished"); goto handle_do_not_repeat; }
+    return 0;
+}
 
-    action_replay_player_t_skip_t const line = action_replay_player_t_get_line(
-            worker_state->buffer,
-            worker_state->buffer_length
-        );
+/*
+ * EAGAIN after a short sleep if a new frame wouldn't fit,
+ * next event may start one, queue's thread frees oldest ones
+ */
+static action_replay_error_t action_replay_player_t_worker_wait_for_room(
+    action_replay_player_t_worker_state_t * const worker_state
+)
+{
+    unsigned int const frames_done =
+        ( unsigned int ) OPA_load_acquire_int( &( worker_state->frames_done ));
+    unsigned int const events_done =
+        ( unsigned int ) OPA_load_acquire_int( &( worker_state->events_done ));
+    /* frame being filled takes a slot once queued */
+    unsigned int const frames_in_flight = ( unsigned int ) worker_state->frames
+        + ( 0 < worker_state->frame_count )
+        - frames_done;
+    unsigned int const events_needed =
+        worker_state->events_reserved + FRAME_MAX_EVENTS;
 
-    if( 0 != ( result = line.status )) { goto handle_do_not_repeat; }
-
-    action_replay_error_t const parse_result =
-        action_replay_player_t_parse_line(
-            line.buffer,
-            line.buffer_length,
-            worker_state->line,
-            worker_state->parse_states,
-            worker_state->zero_time,
-            worker_state->player_state->output,
-            worker_state->tokens
-        );
+    if(
+        ( FRAMES_IN_FLIGHT > frames_in_flight )
+        && ( EVENTS_IN_FLIGHT >= events_needed - events_done )
+    ) { return 0; }
+
+    /* room is made by frames written, those not queued yet never are */
+    action_replay_error_t const result =
+        action_replay_player_t_worker_put_frames( worker_state );
+
+    if( 0 != result ) { return result; }
 
-    worker_state->buffer += line.buffer_length;
-    worker_state->buffer_length -= line.buffer_length;
-    if( 0 != parse_result )
+    /* oldest frame is written at its deadline at the earliest */
+    uint64_t const oldest_deadline =
+        worker_state->deadlines[ frames_done % FRAMES_IN_FLIGHT ];
+    uint64_t const now = action_replay_nanoseconds_monotonic_now();
+    uint64_t deadline = now + ROOM_WAIT_MIN_NANOSECONDS;
+
+    if( oldest_deadline > deadline )
     {
-        LOG( "allocation failure for parse_state in worker %p", worker_state );
-        result = parse_result;
-        goto handle_do_not_repeat;
+        deadline = ( oldest_deadline - now > ROOM_WAIT_MAX_NANOSECONDS )
+            ? now + ROOM_WAIT_MAX_NANOSECONDS
+            : oldest_deadline;
     }
+    if( 0 != action_replay_nanoseconds_sleep_until( deadline ))
+    { LOG( "failure sleeping until %" PRIu64, deadline ); }
 
-    action_replay_return_t const put_result =
-        worker_state->player_state->queue->put(
-            worker_state->player_state->queue,
-            action_replay_player_t_process_item,
-            worker_state->parse_states + worker_state->line
-        );
-    
-    ++( worker_state->line );
-    if( 0 == ( result = put_result.status )) { return EAGAIN; }
-
-    result = put_result.status;
-handle_do_not_repeat:
-    OPA_store_ptr(
-        &( worker_state->player_state->input_flag ),
-        &input_finished
-    );
-    pthread_cond_broadcast( &( worker_state->player_state->condition ));
-    return result;
+    return EAGAIN;
 }
 
-static action_replay_error_t
-action_replay_player_t_parse_line(
-    char const * const restrict buffer,
-    size_t const size,
-    uint64_t const line,
-    action_replay_player_t_worker_parse_state_t * const restrict parse_states,
-    action_replay_time_t * const restrict zero_time,
-    FILE * const restrict output,
-    jsmntok_t * const restrict tokens
+/*
+ * completes frame being filled, if any; frames are queued once
+ * a batch is full, or right away if queue's thread ran out of them
+ */
+static action_replay_error_t action_replay_player_t_worker_put_frame(
+    action_replay_player_t_worker_state_t * const worker_state
 )
 {
-    jsmn_parser parser;
+    if( 0 == worker_state->frame_count ) { return 0; }
+
+    size_t const frame = worker_state->frames % FRAMES_IN_FLIGHT;
 
-    jsmn_init( &parser );
+    worker_state->events_ends[ frame ] = worker_state->events_reserved;
+    worker_state->frame_count = 0;
+    ++( worker_state->frames );
+    if(
+        ( FRAMES_PER_PUT > worker_state->frames - worker_state->items )
+        && (( unsigned int ) worker_state->items != ( unsigned int )
+            OPA_load_acquire_int( &( worker_state->frames_done )))
+    ) { return 0; }
 
-    jsmnerr_t const parse_result =
-        jsmn_parse( &parser, buffer, size, tokens, INPUT_JSON_TOKENS_COUNT );
+    return action_replay_player_t_worker_put_frames( worker_state );
+}
 
-    if( INPUT_JSON_TOKENS_COUNT != parse_result )
+/*
+ * appends event to current frame, queued once it's complete;
+ * worker_wait_for_room() must have made room for a new frame
+ */
+static action_replay_error_t action_replay_player_t_worker_add_event(
+    action_replay_player_t_worker_state_t * const worker_state,
+    uint64_t const delay,
+    uint16_t const type,
+    uint16_t const code,
+    int32_t const value
+)
+{
+    action_replay_error_t result;
+
+    if(
+        ( 0 < worker_state->frame_count )
+        && (( 0 < delay ) || ( FRAME_MAX_EVENTS == worker_state->frame_count ))
+    )
+    {
+        if( 0 != ( result = action_replay_player_t_worker_put_frame(
+            worker_state
+        ))) { goto handle_do_not_repeat; }
+    }
+    if( 0 == worker_state->frame_count )
     {
-        LOG( "failure parsing JSON, buffer = %s", buffer );
-        return EINVAL;
+        size_t const frame = worker_state->frames % FRAMES_IN_FLIGHT;
+
+        /* saturates on overflow, which only makes the event late */
+        worker_state->deadline = action_replay_nanoseconds_add(
+            worker_state->deadline,
+            delay
+        ).value;
+        worker_state->deadlines[ frame ] = worker_state->deadline;
+        worker_state->waits[ frame ] = ( 0 < delay );
     }
 
-    action_replay_player_t_worker_parse_state_t * const parse_state =
-        parse_states + line;
-
-    parse_state->sleep = action_replay_new(
-        action_replay_time_converter_t_class(),
-        action_replay_time_converter_t_args(
-            strtoull(
-                buffer + tokens[ INPUT_JSON_TIME_TOKEN ].start,
-                NULL,
-                10
-    )));
-    if( NULL == parse_state->sleep )
+    size_t const event = worker_state->events_reserved % EVENTS_IN_FLIGHT;
+
+    ++( worker_state->frame_count );
+    ++( worker_state->events_reserved );
+    worker_state->types[ event ] = type;
+    worker_state->codes[ event ] = code;
+    worker_state->values[ event ] = value;
+    if(( EV_SYN == type ) && ( SYN_REPORT == code ))
     {
-        LOG( "failure allocating memory for sleep time object" );
-        free( parse_state );
-        return ENOMEM;
+        if( 0 != ( result = action_replay_player_t_worker_put_frame(
+            worker_state
+        ))) { goto handle_do_not_repeat; }
     }
-    parse_state->zero_time = zero_time;
-    parse_state->add =
-        ACTION_REPLAY_DYNAMIC(
-            action_replay_time_t_func_t,
-            add,
-            zero_time
-        );
-    parse_state->sub =
-        ACTION_REPLAY_DYNAMIC(
-            action_replay_time_t_func_t,
-            sub,
-            zero_time
-        );
-    parse_state->converter =
-        ACTION_REPLAY_DYNAMIC(
-            action_replay_time_t_converter_func_t,
-            converter,
-            zero_time
-        );
-    parse_state->output = output;
-    parse_state->event.type = ( __u16 ) strtoul(
-        buffer + tokens[ INPUT_JSON_TYPE_TOKEN ].start,
-        NULL,
-        10
+
+    return EAGAIN;
+
+handle_do_not_repeat:
+    return action_replay_player_t_worker_finished( worker_state, result );
+}
+
+/* queues last frame, which may have no SYN_REPORT, and any left over */
+static action_replay_error_t action_replay_player_t_worker_done(
+    action_replay_player_t_worker_state_t * const worker_state
+)
+{
+    action_replay_error_t result;
+
+    LOG( "parsing finished" );
+    result = action_replay_player_t_worker_put_frame( worker_state );
+    if( 0 == result )
+    { result = action_replay_player_t_worker_put_frames( worker_state ); }
+
+    return action_replay_player_t_worker_finished( worker_state, result );
+}
+
+static inline action_replay_error_t action_replay_player_t_worker_put_record(
+    action_replay_player_t_worker_state_t * const restrict worker_state,
+    action_replay_binary_recording_record_t const * const restrict record
+)
+{
+    return action_replay_player_t_worker_add_event(
+        worker_state,
+        record->delay,
+        record->type,
+        record->code,
+        record->value
     );
-    parse_state->event.code = ( __u16 ) strtoul(
-        buffer + tokens[ INPUT_JSON_CODE_TOKEN ].start,
-        NULL,
-        10
+}
+
+static void * action_replay_player_t_parse_job( void * const state )
+{
+    action_replay_player_t_parse_job_t * const job = state;
+
+    job->lines = action_replay_json_recording_parse_lines(
+        job->buffer,
+        job->buffer_length
     );
-    parse_state->event.value = ( __s32 ) strtol(
-        buffer + tokens[ INPUT_JSON_VALUE_TOKEN ].start,
-        NULL,
-        10
+    job->parsed = true;
+    action_replay_player_t_release_input(
+        job->buffer,
+        job->buffer + job->buffer_length
     );
 
-    return 0;
+    return NULL;
 }
 
-static void action_replay_player_t_process_item( void * const state )
+static unsigned int action_replay_player_t_parse_threads(
+    unsigned int const parse_threads
+)
 {
-    action_replay_player_t_worker_parse_state_t * const parse_state = state;
-    ssize_t const write_size = sizeof( struct input_event );
+    if( 0 != parse_threads ) { return parse_threads; }
+
+    long const online = sysconf( _SC_NPROCESSORS_ONLN );
 
-    if( 0 < parse_state->sleep->nanoseconds( parse_state->sleep ).value )
+    return ( 0 < online ) ? ( unsigned int ) online : 1;
+}
+
+/* cuts next part off the rest, it ends after a newline */
+static size_t action_replay_player_t_worker_next_part(
+    action_replay_player_t_worker_state_t * const worker_state
+)
+{
+    char const * const start = worker_state->rest;
+    char const * const end = start + worker_state->rest_length;
+    char const * part_end = end;
+
+    if( worker_state->part_length < worker_state->rest_length )
     {
-        parse_state->add( parse_state->zero_time, parse_state->sleep );
+        char const * const target = start + worker_state->part_length;
+        size_t const newline = action_replay_line_scan_newline(
+            target,
+            ( size_t ) ( end - target )
+        );
 
-        action_replay_time_converter_t * const now = action_replay_new(
-            action_replay_time_converter_t_class(),
-            action_replay_time_converter_t_args(
-                action_replay_time_converter_t_now()
-            )
+        if( end - target > ( ptrdiff_t ) newline )
+        { part_end = target + newline + 1; }
+    }
+    worker_state->rest = part_end;
+    worker_state->rest_length = ( size_t ) ( end - part_end );
+
+    return ( size_t ) ( part_end - start );
+}
+
+/* job gets next part to parse, or is left empty without any */
+static void action_replay_player_t_worker_start_job(
+    action_replay_player_t_worker_state_t * const restrict worker_state,
+    action_replay_player_t_parse_job_t * const restrict job
+)
+{
+    job->parsed = false;
+    job->buffer = worker_state->rest;
+    job->buffer_length = action_replay_player_t_worker_next_part( worker_state );
+    if( 0 == job->buffer_length ) { return; }
+    job->started = ( 0 == pthread_create(
+        &( job->thread ),
+        NULL,
+        action_replay_player_t_parse_job,
+        job
+    ));
+    /* worker parses it when it gets there */
+    if( ! job->started )
+    {
+        LOG(
+            "failure starting parse job %u",
+            ( unsigned int ) ( job - worker_state->jobs )
         );
+    }
+}
+
+/*
+ * keeps first part of buffer for worker, jobs parse the next ones
+ * and each takes the next part left once its records were queued
+ */
+static void action_replay_player_t_worker_split(
+    action_replay_player_t_worker_state_t * const worker_state
+)
+{
+    unsigned int const threads =
+        action_replay_player_t_parse_threads( worker_state->parse_threads );
+    size_t part_length = worker_state->buffer_length / threads;
 
-        if( NULL == now ) { goto handle_skip_sleep; }
+    worker_state->split = true;
+    if(
+        ( 2 > threads )
+        || ( 2 * PARSE_PART_MIN_LENGTH > worker_state->buffer_length )
+    ) { return; }
+    if( PARSE_PART_MIN_LENGTH > part_length )
+    { part_length = PARSE_PART_MIN_LENGTH; }
+    if( PARSE_PART_MAX_LENGTH < part_length )
+    { part_length = PARSE_PART_MAX_LENGTH; }
+
+    size_t const parts =
+        ( worker_state->buffer_length + part_length - 1 ) / part_length;
+    unsigned int const jobs_count = ( threads - 1 < parts - 1 )
+        ? threads - 1
+        : ( unsigned int ) ( parts - 1 );
+
+    worker_state->jobs =
+        calloc( jobs_count, sizeof( action_replay_player_t_parse_job_t ));
+    if( NULL == worker_state->jobs )
+    {
+        LOG( "failure allocating parse jobs, parsing on one thread" );
+        return;
+    }
+    worker_state->jobs_count = jobs_count;
+    worker_state->part_length = part_length;
+    worker_state->rest = worker_state->buffer;
+    worker_state->rest_length = worker_state->buffer_length;
+    worker_state->buffer_length =
+        action_replay_player_t_worker_next_part( worker_state );
+    for( unsigned int i = 0; i < jobs_count; ++i )
+    {
+        action_replay_player_t_worker_start_job(
+            worker_state,
+            worker_state->jobs + i
+        );
+    }
+    LOG(
+        "parsing input in about %" PRIu64 " parts of about %" PRIu64
+        " bytes on %u threads",
+        ( uint64_t ) parts,
+        ( uint64_t ) part_length,
+        jobs_count + 1
+    );
+}
 
-        action_replay_return_t const result =
-            parse_state->sub( parse_state->zero_time, now );
+static void action_replay_player_t_worker_free_jobs(
+    action_replay_player_t_worker_state_t * const worker_state
+)
+{
+    for( unsigned int i = 0; i < worker_state->jobs_count; ++i )
+    {
+        action_replay_player_t_parse_job_t * const job =
+            worker_state->jobs + i;
 
-        if( E2BIG == result.status ) { goto handle_skip_sleep; }
+        if( job->started && ( 0 != pthread_join( job->thread, NULL )))
+        { LOG( "failure joining parse job %u", i ); }
+        free( job->lines.records );
+    }
+    free( worker_state->jobs );
+    worker_state->jobs = NULL;
+    worker_state->jobs_count = 0;
+}
 
-        action_replay_time_t_converter_return_t const sleep_result =
-            parse_state->converter( parse_state->zero_time );
+/* queues records of jobs in file order, once worker's own lines are queued */
+static action_replay_error_t action_replay_player_t_worker_jobs(
+    action_replay_player_t_worker_state_t * const worker_state
+)
+{
+    if( 0 == worker_state->jobs_count )
+    { return action_replay_player_t_worker_done( worker_state ); }
 
-        if( 0 != sleep_result.status ) { goto handle_skip_sleep; }
+    action_replay_player_t_parse_job_t * const job =
+        worker_state->jobs + worker_state->job;
 
-#if HAVE_TIME_H
-        struct timespec const sleep_time =
-            sleep_result.converter->timespec( sleep_result.converter ).value;
+    /* parts are handed out in order, so later jobs have none either */
+    if( 0 == job->buffer_length )
+    { return action_replay_player_t_worker_done( worker_state ); }
 
-        nanosleep( &sleep_time, NULL );
-#elif HAVE_SYS_TIME_H
-        struct timeval const sleep_time =
-            sleep_result.converter->timeval( sleep_result.converter ).value;
+    action_replay_error_t result;
 
-        select( 0, NULL, NULL, NULL, &sleep_time );
-#endif /* HAVE_TIME_H */
-        parse_state->add( parse_state->zero_time, now );
-        action_replay_delete( ( void * ) sleep_result.converter );
-handle_skip_sleep:
-        action_replay_delete( ( void * ) now );
+    /* complete frames go out before waiting for job, or parsing it */
+    if( job->started || ( ! job->parsed ))
+    {
+        result = action_replay_player_t_worker_put_frames( worker_state );
+        if( 0 != result )
+        {
+            return action_replay_player_t_worker_finished(
+                worker_state,
+                result
+            );
+        }
+    }
+    if( job->started )
+    {
+        job->started = false;
+        if( 0 != pthread_join( job->thread, NULL ))
+        {
+            LOG( "failure joining parse job %u", worker_state->job );
+            return action_replay_player_t_worker_finished(
+                worker_state,
+                EINVAL
+            );
+        }
+    }
+    if( ! job->parsed ) { action_replay_player_t_parse_job( job ); }
+    if( 0 != job->lines.status )
+    {
+        LOG( "failure parsing input in parse job %u", worker_state->job );
+        return action_replay_player_t_worker_finished(
+            worker_state,
+            job->lines.status
+        );
+    }
+    if( job->lines.count == worker_state->job_record )
+    {
+        result = action_replay_player_t_worker_put_frames( worker_state );
+        if( 0 != result )
+        {
+            return action_replay_player_t_worker_finished(
+                worker_state,
+                result
+            );
+        }
+        free( job->lines.records );
+        job->lines.records = NULL;
+        worker_state->job_record = 0;
+        action_replay_player_t_worker_start_job( worker_state, job );
+        worker_state->job = ( worker_state->job + 1 ) % worker_state->jobs_count;
+        return EAGAIN;
     }
 
-    if(
-        write_size > write(
-            fileno( parse_state->output ),
-            &( parse_state->event ),
-            write_size
-    ))
-    { LOG( "failure writing to output device %p", parse_state->output ); }
-    action_replay_delete( ( void * ) parse_state->sleep );
+    return action_replay_player_t_worker_put_record(
+        worker_state,
+        job->lines.records + worker_state->job_record++
+    );
 }
 
-static FILE * action_replay_player_t_open_output_from_header(
-    char const * const buffer,
-    size_t const buffer_length
-)
+static action_replay_error_t action_replay_player_t_worker( void * state )
 {
-    FILE * result = NULL;
-    action_replay_player_t_skip_t skip = action_replay_player_t_skip_comments(
-            buffer,
-            buffer_length
-        );
+    action_replay_player_t_worker_state_t * const worker_state = state;
+
+    action_replay_error_t const room =
+        action_replay_player_t_worker_wait_for_room( worker_state );
 
-    if( 0 != skip.status )
+    if( EAGAIN == room ) { return room; }
+    if( 0 != room )
+    { return action_replay_player_t_worker_finished( worker_state, room ); }
+    if( ! worker_state->split )
+    { action_replay_player_t_worker_split( worker_state ); }
+    if( worker_state->lines_count == worker_state->lines_next )
     {
-        LOG( "failure getting header offset" );
-        return NULL;
+        /* every line scanned before was parsed */
+        if( RELEASE_LENGTH <= worker_state->buffer - worker_state->released )
+        {
+            worker_state->released = action_replay_player_t_release_input(
+                worker_state->released,
+                worker_state->buffer
+            );
+        }
+        worker_state->lines_next = 0;
+        worker_state->lines_count = action_replay_line_scan_lines(
+            worker_state->buffer,
+            worker_state->buffer_length,
+            worker_state->lines,
+            LINES_PER_SCAN
+        );
+        if( 0 == worker_state->lines_count )
+        { return action_replay_player_t_worker_jobs( worker_state ); }
+
+        action_replay_line_scan_line_t const * const last =
+            worker_state->lines + worker_state->lines_count - 1;
+        size_t const scanned =
+            ( size_t ) ( last->start + last->length - worker_state->buffer );
+
+        worker_state->buffer += scanned;
+        worker_state->buffer_length -= scanned;
     }
 
-    action_replay_player_t_skip_t line = action_replay_player_t_get_line(
-            skip.buffer,
-            skip.buffer_length
-        );
+    action_replay_line_scan_line_t const line =
+        worker_state->lines[ worker_state->lines_next++ ];
+
+    if( line.comment ) { return EAGAIN; }
 
-    if( 0 != line.status )
+    action_replay_json_recording_return_t const event =
+        action_replay_json_recording_parse_line( line.start, line.length );
+
+    if( 0 != event.status )
     {
-        LOG( "failure reading header from input file" );
-        return NULL;
+        LOG(
+            "failure parsing JSON, buffer = %.*s",
+            ( int ) line.length,
+            line.start
+        );
+        LOG( "failure parsing line in worker %p", worker_state );
+        return action_replay_player_t_worker_finished(
+            worker_state,
+            event.status
+        );
     }
 
-    jsmn_parser parser;
-    jsmntok_t tokens[ HEADER_JSON_TOKENS_COUNT ];
+    return action_replay_player_t_worker_add_event(
+        worker_state,
+        event.delay,
+        event.type,
+        event.code,
+        event.value
+    );
+}
 
-    jsmn_init( &parser );
+static action_replay_error_t
+action_replay_player_t_binary_worker( void * state )
+{
+    action_replay_player_t_worker_state_t * const worker_state = state;
+    action_replay_player_t_state_t * const player_state =
+        worker_state->player_state;
 
-    jsmnerr_t const parse_result = jsmn_parse(
-            &parser,
-            line.buffer,
-            line.buffer_length,
-            tokens,
-            HEADER_JSON_TOKENS_COUNT
-        );
+    if( player_state->records_count == worker_state->record )
+    { return action_replay_player_t_worker_done( worker_state ); }
+
+    action_replay_error_t const room =
+        action_replay_player_t_worker_wait_for_room( worker_state );
+
+    if( EAGAIN == room ) { return room; }
+    if( 0 != room )
+    { return action_replay_player_t_worker_finished( worker_state, room ); }
+
+    char const * const record =
+        ( char const * ) ( player_state->records + worker_state->record );
 
-    if( HEADER_JSON_TOKENS_COUNT != parse_result )
+    if( RELEASE_LENGTH <= record - worker_state->released )
     {
-        LOG( "failure parsing JSON, buffer = %s", buffer );
-        goto handle_jsmn_parse_error;
+        worker_state->released = action_replay_player_t_release_input(
+            worker_state->released,
+            record
+        );
     }
 
-    jsmntok_t const path_token = tokens[ HEADER_JSON_TOKENS_COUNT - 1 ];
+    return action_replay_player_t_worker_put_record(
+        worker_state,
+        player_state->records + worker_state->record++
+    );
+}
+
+static inline void action_replay_player_t_minimize_timer_slack(
+    action_replay_player_t_timing_t * const timing
+)
+{
+    /* slack is per thread, queue's thread runs all items */
+    if(( ! timing->timer_slack ) || timing->timer_slack_set ) { return; }
+    timing->timer_slack_set = true;
+#if HAVE_SYS_PRCTL_H && defined( PR_SET_TIMERSLACK )
+    if( 0 != prctl( PR_SET_TIMERSLACK, 1UL, 0UL, 0UL, 0UL ))
+    { LOG( "failure setting timer slack, errno = %d", errno ); }
+#else /* ! ( HAVE_SYS_PRCTL_H && PR_SET_TIMERSLACK ) */
+    LOG( "timer slack can't be set on this platform" );
+#endif /* HAVE_SYS_PRCTL_H && PR_SET_TIMERSLACK */
+}
 
-    if( JSMN_STRING != path_token.type )
+static inline unsigned int
+action_replay_player_t_lateness_bucket( uint64_t const lateness )
+{
+    uint64_t microseconds = lateness / NANOSECONDS_IN_MICROSECOND;
+    unsigned int bucket = 0;
+
+    while(( 0 < microseconds ) && ( LATENESS_HISTOGRAM_BUCKETS - 1 > bucket ))
     {
-        LOG( "path has wrong token type" );
-        goto handle_invalid_token_error;
+        microseconds >>= 1;
+        ++bucket;
     }
 
-    char * filepath = calloc(
-        path_token.end - path_token.start + 1,
-        sizeof( char )
-    );
+    return bucket;
+}
+
+static void action_replay_player_t_process_item( void * const state )
+{
+    action_replay_player_t_worker_state_t * const worker_state = state;
+    action_replay_player_t_timing_t * const timing = &( worker_state->timing );
+    FILE * const output = worker_state->player_state->output;
+    unsigned int const frames_done =
+        ( unsigned int ) OPA_load_int( &( worker_state->frames_done ));
+    unsigned int const events_start =
+        ( unsigned int ) OPA_load_int( &( worker_state->events_done ));
+    size_t const frame = frames_done % FRAMES_IN_FLIGHT;
+    unsigned int const events_end = worker_state->events_ends[ frame ];
+    unsigned int const count = events_end - events_start;
+    uint64_t const deadline = worker_state->deadlines[ frame ];
+    bool const wait = worker_state->waits[ frame ];
+    ssize_t const write_size =
+        ( ssize_t ) ( count * sizeof( struct input_event ));
+
+    /* event times are left zero, kernel stamps events itself */
+    for( unsigned int i = 0; i < count; ++i )
+    {
+        size_t const event = ( events_start + i ) % EVENTS_IN_FLIGHT;
 
-    if( NULL == filepath) { goto handle_filepath_alloc_error; }
-    strncpy(
-        filepath,
-        line.buffer + path_token.start,
-        path_token.end - path_token.start
+        worker_state->frame_events[ i ].type = worker_state->types[ event ];
+        worker_state->frame_events[ i ].code = worker_state->codes[ event ];
+        worker_state->frame_events[ i ].value = worker_state->values[ event ];
+    }
+    /* worker may reuse frame and its events from here on */
+    OPA_store_release_int(
+        &( worker_state->events_done ),
+        ( int ) events_end
     );
-    result = fopen( filepath, "a" );
+    OPA_store_release_int(
+        &( worker_state->frames_done ),
+        ( int ) ( frames_done + 1 )
+    );
+
+    /* zero-delay frames, or rests of split ones, don't look at the clock */
+    if( wait )
+    {
+        action_replay_player_t_minimize_timer_slack( timing );
+
+        action_replay_error_t const result = ( 0 == timing->spin_margin )
+            ? action_replay_nanoseconds_sleep_until( deadline )
+            : action_replay_nanoseconds_spin_until(
+                deadline,
+                timing->spin_margin
+            );
+
+        if( 0 != result )
+        { LOG( "failure sleeping until %" PRIu64, deadline ); }
+    }
+    if(
+        write_size > write(
+            fileno( output ),
+            worker_state->frame_events,
+            write_size
+    ))
+    { LOG( "failure writing to output device %p", output ); }
+
+    /* early wakeups count as no lateness */
+    timing->lateness = action_replay_nanoseconds_sub(
+        action_replay_nanoseconds_monotonic_now(),
+        deadline
+    ).value;
+    if( timing->lateness > timing->max_lateness )
+    { timing->max_lateness = timing->lateness; }
+    timing->events += count;
+    if( wait )
+    {
+        ++( timing->lateness_histogram[
+            action_replay_player_t_lateness_bucket( timing->lateness )
+        ] );
+    }
+}
+
+static FILE * action_replay_player_t_open_device( char const * const path )
+{
+    FILE * const result = fopen( path, "a" );
+
     LOG(
         "%s opening output device %s as %p",
         ( NULL == result ) ? "failure" : "success",
-        filepath,
+        path,
         result
     );
-    free( filepath );
-handle_filepath_alloc_error:
-handle_invalid_token_error:
-handle_jsmn_parse_error:
     return result;
 }
 
-static action_replay_player_t_worker_parse_state_t *
-action_replay_player_t_prealloc_parse_states(
-    char const * const buffer,
-    size_t const buffer_length
+/*
+ * one pass over events, before any of them is queued,
+ * which leaves no more of input in memory than replay does
+ */
+static void action_replay_player_t_capabilities(
+    action_replay_player_t_state_t const * const restrict player_state,
+    action_replay_uinput_capabilities_t * const restrict capabilities
 )
 {
-    uint64_t lines = 0;
-
-    action_replay_player_t_skip_t skip =
-        action_replay_player_t_skip_header( buffer, buffer_length );
-
-    if( 0 != skip.status ) { return NULL; } /* invalid file type? */
-    do {
-        skip = action_replay_player_t_skip_comments( skip.buffer, skip.buffer_length );
-        if( 0 != skip.status ) { continue; }
-        action_replay_player_t_skip_t line =
-            action_replay_player_t_get_line( skip.buffer, skip.buffer_length );
-        if( 0 == ( skip.status = line.status ))
+    action_replay_uinput_capabilities_init( capabilities );
+    if( player_state->binary )
+    {
+        char const * released = ( char const * ) player_state->records;
+
+        for( size_t i = 0; i < player_state->records_count; ++i )
         {
-            ++lines;
-            skip.buffer += line.buffer_length;
-            skip.buffer_length -= line.buffer_length;
+            char const * const record =
+                ( char const * ) ( player_state->records + i );
+
+            if( RELEASE_LENGTH <= record - released )
+            {
+                released =
+                    action_replay_player_t_release_input( released, record );
+            }
+            action_replay_uinput_capabilities_add(
+                capabilities,
+                player_state->records[ i ].type,
+                player_state->records[ i ].code,
+                player_state->records[ i ].value
+            );
         }
-    } while( 0 == skip.status );
-
-    LOG( "preallocating parse state for %"PRIu64" lines", lines );
-    return calloc( lines, sizeof( action_replay_player_t_worker_parse_state_t ));
-}
+        return;
+    }
 
-static inline action_replay_player_t_skip_t action_replay_player_t_get_line(
-    char const * const buffer,
-    size_t const buffer_length
-)
-{
+    char const * const buffer =
+        ( char const * ) player_state->input + player_state->events_offset;
+    size_t const buffer_length =
+        player_state->input_length - player_state->events_offset;
+    action_replay_line_scan_line_t lines[ LINES_PER_SCAN ];
+    char const * released = buffer;
     size_t offset = 0;
 
-    while(( buffer_length > offset + 1 ) && ( '\n' != buffer[ offset ] ))
-    { ++offset; }
-    return ( action_replay_player_t_skip_t )
+    while( buffer_length > offset )
     {
-        (( '\n' == buffer[ offset ] ) || ( buffer_length == ( offset + 1 )))
-            ? 0 : EINVAL,
-        buffer,
-        offset + 1
-    };
+        if( RELEASE_LENGTH <= buffer + offset - released )
+        {
+            released =
+                action_replay_player_t_release_input( released, buffer + offset );
+        }
+
+        size_t const count = action_replay_line_scan_lines(
+            buffer + offset,
+            buffer_length - offset,
+            lines,
+            LINES_PER_SCAN
+        );
+
+        for( size_t i = 0; i < count; ++i )
+        {
+            if( lines[ i ].comment ) { continue; }
+
+            /* bad lines are reported when replayed */
+            action_replay_json_recording_return_t const event =
+                action_replay_json_recording_parse_line(
+                    lines[ i ].start,
+                    lines[ i ].length
+                );
+
+            if( 0 != event.status ) { continue; }
+            action_replay_uinput_capabilities_add(
+                capabilities,
+                event.type,
+                event.code,
+                event.value
+            );
+        }
+        offset = ( size_t ) (
+            lines[ count - 1 ].start + lines[ count - 1 ].length - buffer
+        );
+    }
 }
 
-static action_replay_player_t_skip_t action_replay_player_t_skip_comments(
-    char const * const buffer,
-    size_t const buffer_length
+/* device goes away with the stream, writes are the same as to evdev */
+static FILE * action_replay_player_t_open_uinput(
+    action_replay_player_t_state_t const * const restrict player_state,
+    char const * const restrict path
 )
 {
-    size_t offset = 0;
+    action_replay_uinput_capabilities_t capabilities;
+    char name[ sizeof( UINPUT_NAME_PREFIX ) + INPUT_MAX_LEN ];
 
-    while(
-        ( buffer_length > offset + 1 )
-        && ( COMMENT_SYMBOL == buffer[ offset ] )
-    )
+    action_replay_player_t_capabilities( player_state, &capabilities );
+    if( 0 != capabilities.ignored )
     {
-        action_replay_player_t_skip_t line = action_replay_player_t_get_line(
-                buffer + offset,
-                buffer_length - offset
-            );
+        LOG(
+            "%" PRIu64 " events of %s not supported by virtual devices",
+            capabilities.ignored,
+            path
+        );
+    }
+    snprintf( name, sizeof( name ), UINPUT_NAME_PREFIX "%s", path );
+
+    action_replay_uinput_return_t const device =
+        action_replay_uinput_create( name, &capabilities );
 
-        if( 0 != line.status )
-        { return ( action_replay_player_t_skip_t ) { line.status, NULL, 0 }; }
-        offset += line.buffer_length;
+    if( 0 != device.status )
+    {
+        LOG(
+            "failure creating virtual device for %s, errno = %d",
+            path,
+            device.status
+        );
+        return NULL;
     }
 
-    return ( action_replay_player_t_skip_t )
-    { 0, buffer + offset, buffer_length - offset };
+    FILE * const result = fdopen( device.fd, "w" );
+
+    LOG(
+        "%s opening virtual device for %s as %p",
+        ( NULL == result ) ? "failure" : "success",
+        path,
+        result
+    );
+    if( NULL == result ) { close( device.fd ); }
+    return result;
 }
 
-static action_replay_player_t_skip_t action_replay_player_t_skip_header(
-    char const * const buffer,
-    size_t const buffer_length
+static FILE * action_replay_player_t_open_output(
+    action_replay_player_t_state_t const * const restrict player_state,
+    char const * const restrict path,
+    bool const uinput
 )
 {
-    action_replay_player_t_skip_t comments =
-        action_replay_player_t_skip_comments( buffer, buffer_length );
+    return uinput
+        ? action_replay_player_t_open_uinput( player_state, path )
+        : action_replay_player_t_open_device( path );
+}
+
+static FILE * action_replay_player_t_open_output_from_binary_header(
+    action_replay_player_t_state_t * const player_state,
+    bool const uinput
+)
+{
+    action_replay_binary_recording_return_t const recording =
+        ( NULL == player_state->compiled.mapping )
+            ? action_replay_binary_recording_read(
+                player_state->input,
+                player_state->input_length
+            )
+            : action_replay_binary_recording_read(
+                player_state->compiled.recording,
+                player_state->compiled.recording_length
+            );
 
-    if( 0 != comments.status )
-    { return ( action_replay_player_t_skip_t ) { comments.status, NULL, 0 }; }
+    if( 0 != recording.status )
+    {
+        LOG( "failure reading binary header from input file" );
+        return NULL;
+    }
+    player_state->records = recording.records;
+    player_state->records_count = recording.count;
+    LOG(
+        "binary recording of %" PRIu64 " events",
+        ( uint64_t ) recording.count
+    );
+    return action_replay_player_t_open_output(
+        player_state,
+        recording.path,
+        uinput
+    );
+}
 
-    action_replay_player_t_skip_t header =
-        action_replay_player_t_get_line( comments.buffer, comments.buffer_length );
+static FILE * action_replay_player_t_open_output_from_header(
+    action_replay_player_t_state_t * const player_state,
+    bool const uinput
+)
+{
+    action_replay_json_recording_header_return_t const header =
+        action_replay_json_recording_parse_header(
+            player_state->input,
+            player_state->input_length
+        );
 
     if( 0 != header.status )
-    { return ( action_replay_player_t_skip_t ) { header.status, NULL, 0 }; }
-    
-    return action_replay_player_t_skip_comments(
-        comments.buffer + header.buffer_length,
-        comments.buffer_length - header.buffer_length
+    {
+        LOG( "failure reading header from input file" );
+        return NULL;
+    }
+    player_state->events_offset = header.events_offset;
+
+    FILE * const result = action_replay_player_t_open_output(
+        player_state,
+        header.path,
+        uinput
     );
+
+    free( header.path );
+    return result;
 }
 
 static action_replay_return_t
@@ -1089,6 +1832,9 @@ action_replay_player_t_start_state_copier( void * const state )
     action_replay_player_t_start_state_t * const copy = result.state;
     action_replay_player_t_start_state_t const * const original = state;
 
+    copy->spin_margin = original->spin_margin;
+    copy->timer_slack = original->timer_slack;
+    copy->parse_threads = original->parse_threads;
     copy->zero_time =
         action_replay_copy( ( void const * const ) original->zero_time );
     if( NULL != copy->zero_time ) { return result; }
@@ -1100,13 +1846,21 @@ action_replay_player_t_start_state_copier( void * const state )
 }
 
 action_replay_args_t action_replay_player_t_start_state(
-    action_replay_time_t const * const zero_time
+    action_replay_time_t const * const zero_time,
+    uint64_t const spin_margin,
+    bool const timer_slack,
+    unsigned int const parse_threads
 )
 {
     action_replay_args_t result = action_replay_args_t_default_args();
 
     action_replay_player_t_start_state_t start_state =
-    { action_replay_copy( ( void const * const ) zero_time ) };
+    {
+        action_replay_copy( ( void const * const ) zero_time ),
+        spin_margin,
+        timer_slack,
+        parse_threads
+    };
 
     if( NULL == start_state.zero_time ) { return result; }
 
@@ -1135,6 +1889,8 @@ action_replay_class_t const * action_replay_player_t_class( void )
         action_replay_stoppable_t_class,
         NULL
     };
+    static action_replay_reflection_cache_t reflection_cache;
+    static action_replay_class_t_ancestry_t ancestry;
     static action_replay_class_t const result =
     {
         sizeof( action_replay_player_t ),
@@ -1142,7 +1898,10 @@ action_replay_class_t const * action_replay_player_t_class( void )
         action_replay_player_t_destructor,
         action_replay_player_t_copier,
         action_replay_player_t_reflector,
-        inheritance
+        &reflection_cache,
+        inheritance,
+        &ancestry,
+        NULL
     };
 
     return &result;
@@ -1178,6 +1937,7 @@ action_replay_player_t_args_t_copier( void * const state )
         original_player_args->path_to_input,
         INPUT_MAX_LEN
     );
+    player_args->uinput = original_player_args->uinput;
     if( NULL != player_args->path_to_input )
     {
         result.status = 0;
@@ -1190,15 +1950,17 @@ action_replay_player_t_args_t_copier( void * const state )
     return result;
 }
 
-action_replay_args_t
-action_replay_player_t_args( char const * const restrict path_to_input )
+action_replay_args_t action_replay_player_t_args(
+    char const * const restrict path_to_input,
+    bool const uinput
+)
 {
     action_replay_args_t result = action_replay_args_t_default_args();
 
     if( NULL == path_to_input ) { return result; }
 
     action_replay_player_t_args_t args =
-    { action_replay_strndup( path_to_input, INPUT_MAX_LEN ) };
+    { action_replay_strndup( path_to_input, INPUT_MAX_LEN ), uinput };
 
     if( NULL == args.path_to_input ) { goto handle_error; }
 
@@ -0,0 +1,247 @@
+#include "action_replay/pool.h"
+#include "action_replay/stddef.h"
+#include "action_replay/stdint.h"
+#include <errno.h>
+#include <opa_primitives.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* blocks moved between thread cache and shared list at once */
+#define POOL_BATCH 32
+#define POOL_CACHE_LIMIT ( 2 * POOL_BATCH )
+#define POOL_SHARED_LIMIT 1024
+/* local counters are added to pool's after that many operations */
+#define POOL_FLUSH_INTERVAL 256
+
+typedef enum {
+    KEY_UNINITIALIZED,
+    KEY_READY,
+    KEY_FAILED
+} action_replay_pool_t_key_state_t;
+
+typedef struct { void * next; } action_replay_pool_t_block_t;
+
+typedef struct {
+    action_replay_pool_t * pool;
+    void * free_list;
+    size_t free_count;
+    size_t operations;
+    uint64_t allocations;
+    uint64_t recycled;
+    uint64_t releases;
+} action_replay_pool_t_cache_t;
+
+static inline size_t
+action_replay_pool_t_block_size( action_replay_pool_t const * const pool )
+{
+    return ( sizeof( action_replay_pool_t_block_t ) > pool->size )
+        ? sizeof( action_replay_pool_t_block_t )
+        : pool->size;
+}
+
+/* pool mutex must be held */
+static void action_replay_pool_t_cache_flush_counters(
+    action_replay_pool_t_cache_t * const cache
+)
+{
+    action_replay_pool_t * const pool = cache->pool;
+
+    pool->allocations += cache->allocations;
+    pool->recycled += cache->recycled;
+    pool->releases += cache->releases;
+    cache->allocations = 0;
+    cache->recycled = 0;
+    cache->releases = 0;
+    cache->operations = 0;
+}
+
+/* pool mutex must be held; moves up to count blocks to shared list */
+static void action_replay_pool_t_cache_spill(
+    action_replay_pool_t_cache_t * const cache,
+    size_t count
+)
+{
+    action_replay_pool_t * const pool = cache->pool;
+
+    while(( 0 < count ) && ( NULL != cache->free_list ))
+    {
+        action_replay_pool_t_block_t * const block = cache->free_list;
+
+        cache->free_list = block->next;
+        --( cache->free_count );
+        --count;
+        if( POOL_SHARED_LIMIT <= pool->free_count )
+        {
+            free( block );
+            continue;
+        }
+        block->next = pool->free_list;
+        pool->free_list = block;
+        ++( pool->free_count );
+    }
+}
+
+static void action_replay_pool_t_cache_destructor( void * const state )
+{
+    action_replay_pool_t_cache_t * const cache = state;
+    action_replay_pool_t * const pool = cache->pool;
+
+    pthread_mutex_lock( &( pool->mutex ));
+    action_replay_pool_t_cache_spill( cache, cache->free_count );
+    action_replay_pool_t_cache_flush_counters( cache );
+    pthread_mutex_unlock( &( pool->mutex ));
+    free( cache );
+}
+
+static action_replay_pool_t_cache_t *
+action_replay_pool_t_cache( action_replay_pool_t * const pool )
+{
+    int key_state = OPA_load_acquire_int( &( pool->key_state ));
+
+    if( KEY_UNINITIALIZED == key_state )
+    {
+        pthread_mutex_lock( &( pool->mutex ));
+        if( KEY_UNINITIALIZED == OPA_load_int( &( pool->key_state )))
+        {
+            OPA_store_release_int(
+                &( pool->key_state ),
+                ( 0 == pthread_key_create(
+                    &( pool->key ),
+                    action_replay_pool_t_cache_destructor
+                )) ? KEY_READY : KEY_FAILED
+            );
+        }
+        pthread_mutex_unlock( &( pool->mutex ));
+        key_state = OPA_load_acquire_int( &( pool->key_state ));
+    }
+    if( KEY_READY != key_state ) { return NULL; }
+
+    action_replay_pool_t_cache_t * cache = pthread_getspecific( pool->key );
+
+    if( NULL != cache ) { return cache; }
+    cache = calloc( 1, sizeof( action_replay_pool_t_cache_t ));
+    if( NULL == cache ) { return NULL; }
+    cache->pool = pool;
+    if( 0 != pthread_setspecific( pool->key, cache ))
+    {
+        free( cache );
+        return NULL;
+    }
+
+    return cache;
+}
+
+static inline void action_replay_pool_t_cache_tick(
+    action_replay_pool_t_cache_t * const cache
+)
+{
+    if( POOL_FLUSH_INTERVAL > ++( cache->operations )) { return; }
+    pthread_mutex_lock( &( cache->pool->mutex ));
+    action_replay_pool_t_cache_flush_counters( cache );
+    pthread_mutex_unlock( &( cache->pool->mutex ));
+}
+
+void * action_replay_pool_t_alloc( action_replay_pool_t * const pool )
+{
+    if( NULL == pool ) { return NULL; }
+
+    action_replay_pool_t_cache_t * const cache =
+        action_replay_pool_t_cache( pool );
+
+    /* no thread cache, serve from libc without accounting */
+    if( NULL == cache )
+    { return calloc( 1, action_replay_pool_t_block_size( pool )); }
+    if( NULL == cache->free_list )
+    {
+        pthread_mutex_lock( &( pool->mutex ));
+        for(
+            size_t i = 0;
+            ( i < POOL_BATCH ) && ( NULL != pool->free_list );
+            ++i
+        )
+        {
+            action_replay_pool_t_block_t * const block = pool->free_list;
+
+            pool->free_list = block->next;
+            --( pool->free_count );
+            block->next = cache->free_list;
+            cache->free_list = block;
+            ++( cache->free_count );
+        }
+        pthread_mutex_unlock( &( pool->mutex ));
+    }
+
+    size_t const size = action_replay_pool_t_block_size( pool );
+    void * result;
+
+    if( NULL != cache->free_list )
+    {
+        action_replay_pool_t_block_t * const block = cache->free_list;
+
+        cache->free_list = block->next;
+        --( cache->free_count );
+        memset( block, 0, size );
+        result = block;
+        ++( cache->recycled );
+    }
+    else if( NULL == ( result = calloc( 1, size ))) { return NULL; }
+
+    ++( cache->allocations );
+    action_replay_pool_t_cache_tick( cache );
+    return result;
+}
+
+void action_replay_pool_t_free(
+    action_replay_pool_t * const restrict pool,
+    void * const restrict block
+)
+{
+    if(( NULL == pool ) || ( NULL == block )) { return; }
+
+    action_replay_pool_t_cache_t * const cache =
+        action_replay_pool_t_cache( pool );
+
+    if( NULL == cache )
+    {
+        free( block );
+        return;
+    }
+
+    action_replay_pool_t_block_t * const free_block = block;
+
+    free_block->next = cache->free_list;
+    cache->free_list = free_block;
+    ++( cache->free_count );
+    ++( cache->releases );
+    if( POOL_CACHE_LIMIT < cache->free_count )
+    {
+        pthread_mutex_lock( &( pool->mutex ));
+        action_replay_pool_t_cache_spill( cache, POOL_BATCH );
+        pthread_mutex_unlock( &( pool->mutex ));
+    }
+    action_replay_pool_t_cache_tick( cache );
+}
+
+action_replay_pool_t_stats_return_t
+action_replay_pool_t_stats( action_replay_pool_t * const pool )
+{
+    if( NULL == pool )
+    {
+        return ( action_replay_pool_t_stats_return_t const )
+        { EINVAL, 0, 0, 0 };
+    }
+
+    action_replay_pool_t_cache_t * const cache =
+        action_replay_pool_t_cache( pool );
+    action_replay_pool_t_stats_return_t result = { 0, 0, 0, 0 };
+
+    pthread_mutex_lock( &( pool->mutex ));
+    if( NULL != cache ) { action_replay_pool_t_cache_flush_counters( cache ); }
+    result.allocations = pool->allocations;
+    result.recycled = pool->recycled;
+    result.releases = pool->releases;
+    pthread_mutex_unlock( &( pool->mutex ));
+
+    return result;
+}
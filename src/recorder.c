@@ -4,14 +4,16 @@
 #include "action_replay/args.h"
 #include "action_replay/class.h"
 #include "action_replay/error.h"
+#include "action_replay/event_ring.h"
 #include "action_replay/inttypes.h"
-#include "action_replay/limits.h"
 #include "action_replay/log.h"
 #include "action_replay/object_oriented_programming.h"
 #include "action_replay/object_oriented_programming_super.h"
 #include "action_replay/recorder.h"
+#include "action_replay/recorder_io.h"
 #include "action_replay/return.h"
 #include "action_replay/stateful_return.h"
+#include "action_replay/stdbool.h"
 #include "action_replay/stddef.h"
 #include "action_replay/stdint.h"
 #include "action_replay/stoppable.h"
@@ -19,6 +21,7 @@
 #include "action_replay/sys/types.h"
 #include "action_replay/time.h"
 #include "action_replay/time_converter.h"
+#include "action_replay/uring.h"
 #include <errno.h>
 #include <fcntl.h>
 #include <linux/input.h>
@@ -36,10 +39,16 @@
 #define POLL_RUN_FLAG_DESCRIPTOR 1
 #define POLL_DESCRIPTORS_COUNT 2
 
-#define INFINITE_WAIT -1
-
 #define INPUT_MAX_LEN 1024
 
+/* io_uring user data, at most one operation of each kind is in flight */
+#define URING_ENTRIES 8
+#define URING_INPUT 1
+#define URING_RUN_FLAG 2
+#define URING_WRITE 3
+#define URING_TIMEOUT 4
+#define URING_CANCEL 5
+
 typedef struct {
     action_replay_time_t * zero_time;
 } action_replay_recorder_t_start_state_t;
@@ -47,14 +56,36 @@ typedef struct {
 typedef struct {
     char * path_to_input_device;
     char * path_to_output;
+    action_replay_recorder_io_format_t format;
+    size_t ring_capacity;
+    action_replay_recorder_t_backend_t backend;
 } action_replay_recorder_t_args_t;
 
 typedef struct {
-    action_replay_time_t * event_time;
-    action_replay_time_t * zero_time;
+    uint64_t zero_time; /* owned by whichever thread writes */
     action_replay_recorder_t_state_t * recorder_state;
-    struct input_event event;
+    uint64_t reads;
+    uint64_t events_read;
+    struct input_event events[ ACTION_REPLAY_RECORDER_IO_EVENTS_PER_READ ];
+    /* writer thread's */
+    struct input_event written[ ACTION_REPLAY_RECORDER_IO_EVENTS_PER_READ ];
     struct pollfd descriptors[ POLL_DESCRIPTORS_COUNT ];
+    /* io_uring backend's */
+    struct {
+        action_replay_error_t status; /* first failure, stops worker */
+        bool stopping;
+        bool cancelled;
+        bool input_armed;
+        bool run_flag_armed;
+        bool timeout_armed;
+        bool write_in_flight;
+        char run_flag;
+        size_t input_length; /* bytes read into events so far */
+        size_t written_length; /* of in_flight buffer */
+        size_t in_flight_length;
+        /* kernel writes it while writer buffers next events */
+        char in_flight[ ACTION_REPLAY_RECORDER_IO_BUFFER_SIZE ];
+    } uring;
 } action_replay_recorder_t_worker_state_t;
 
 struct action_replay_recorder_t_state_t
@@ -66,13 +97,15 @@ struct action_replay_recorder_t_state_t
     FILE * input;
     FILE * output;
     int pipe_fd[ PIPE_DESCRIPTORS_COUNT ];
+    /* NULL if events are written on the capturing thread */
+    action_replay_stoppable_t * writer_thread;
+    action_replay_event_ring_t ring;
+    action_replay_recorder_io_writer_t writer; /* only one thread writes */
+    bool has_uring; /* false if poll is used */
+    action_replay_uring_t uring;
+    uint64_t polls; /* capturing thread's, read while it's stopped */
 };
 
-static action_replay_error_t action_replay_recorder_t_write_header(
-    char const * const path_to_input_device,
-    FILE * const output
-);
-
 static action_replay_stateful_return_t action_replay_recorder_t_state_t_new(
     action_replay_args_t const args,
     action_replay_stoppable_t_start_func_t const start,
@@ -119,24 +152,71 @@ static action_replay_stateful_return_t action_replay_recorder_t_state_t_new(
         result.status = errno;
         goto handle_pipe_error;
     }
-    result.status = action_replay_recorder_t_write_header(
+    action_replay_recorder_io_writer_init(
+        &( recorder_state->writer ),
+        fileno( recorder_state->output ),
+        recorder_args->format
+    );
+    result.status = action_replay_recorder_io_write_header(
         recorder_args->path_to_input_device,
-        recorder_state->output
+        &( recorder_state->writer )
     );
-    if( 0 == result.status )
+    if( 0 != result.status ) { goto handle_write_header_error; }
+    if( ACTION_REPLAY_RECORDER_T_IO_URING == recorder_args->backend )
     {
-        LOG(
-            "%s opened as %p",
-            recorder_args->path_to_input_device,
-            recorder_state->input
+        action_replay_return_t const uring = action_replay_uring_t_init(
+            &( recorder_state->uring ),
+            URING_ENTRIES
         );
-        recorder_state->start_state = action_replay_args_t_default_args();
-        recorder_state->stoppable_start = start;
-        recorder_state->stoppable_stop = stop;
-        recorder_state->worker_state = NULL;
-        return result;
+
+        recorder_state->has_uring = ( 0 == uring.status );
+        if( ! recorder_state->has_uring )
+        {
+            LOG(
+                "failure setting up io_uring for %s, errno = %d,"
+                " falling back to poll",
+                recorder_args->path_to_input_device,
+                uring.status
+            );
+        }
     }
+    /* io_uring writes without blocking the capture, no thread needed */
+    if(
+        ( ! recorder_state->has_uring )
+        && ( 0 < recorder_args->ring_capacity )
+    )
+    {
+        result.status = action_replay_event_ring_t_init(
+            &( recorder_state->ring ),
+            recorder_args->ring_capacity
+        ).status;
+        if( 0 != result.status ) { goto handle_ring_init_error; }
+        /* we control creation, so no reflection necessary */
+        recorder_state->writer_thread = action_replay_new(
+            action_replay_stoppable_t_class(),
+            action_replay_stoppable_t_args()
+        );
+        if( NULL == recorder_state->writer_thread )
+        {
+            result.status = errno;
+            goto handle_writer_thread_new_error;
+        }
+    }
+    LOG(
+        "%s opened as %p",
+        recorder_args->path_to_input_device,
+        recorder_state->input
+    );
+    recorder_state->start_state = action_replay_args_t_default_args();
+    recorder_state->stoppable_start = start;
+    recorder_state->stoppable_stop = stop;
+    recorder_state->worker_state = NULL;
+    return result;
 
+handle_writer_thread_new_error:
+    action_replay_event_ring_t_destroy( &( recorder_state->ring ));
+handle_ring_init_error:
+handle_write_header_error:
     close( recorder_state->pipe_fd[ PIPE_READ ] );
     close( recorder_state->pipe_fd[ PIPE_WRITE ] );
 handle_pipe_error:
@@ -153,10 +233,29 @@ static action_replay_return_t action_replay_recorder_t_state_t_delete(
     action_replay_recorder_t_state_t * const recorder_state
 )
 {
-    action_replay_return_t const result =
+    action_replay_return_t result =
         action_replay_args_t_delete( recorder_state->start_state );
 
     if( 0 != result.status ) { return result; }
+    if( recorder_state->has_uring )
+    {
+        result = action_replay_uring_t_destroy( &( recorder_state->uring ));
+        if( 0 != result.status ) { return result; }
+        recorder_state->has_uring = false;
+    }
+    if( NULL != recorder_state->writer_thread )
+    {
+        result.status =
+            action_replay_delete( ( void * ) recorder_state->writer_thread );
+        if( 0 != result.status ) { return result; }
+        recorder_state->writer_thread = NULL;
+        result = action_replay_event_ring_t_destroy( &( recorder_state->ring ));
+        if( 0 != result.status ) { return result; }
+    }
+    /* header is left buffered if never started */
+    result.status =
+        action_replay_recorder_io_writer_flush( &( recorder_state->writer ));
+    if( 0 != result.status ) { return result; }
     if(
         ( -1 == close( recorder_state->pipe_fd[ PIPE_READ ] ))
         || ( -1 == close( recorder_state->pipe_fd[ PIPE_WRITE ] ))
@@ -344,6 +443,12 @@ static action_replay_reflector_return_t action_replay_recorder_t_reflector(
 }
 
 static action_replay_error_t action_replay_recorder_t_worker( void * state );
+static action_replay_error_t
+action_replay_recorder_t_uring_worker( void * state );
+static void action_replay_recorder_t_uring_drain(
+    action_replay_recorder_t_state_t * const recorder_state
+);
+static action_replay_error_t action_replay_recorder_t_writer( void * state );
 
 static action_replay_return_t action_replay_recorder_t_start_func_t_start(
     action_replay_stoppable_t * const self,
@@ -373,41 +478,52 @@ static action_replay_return_t action_replay_recorder_t_start_func_t_start(
 
     action_replay_recorder_t_start_state_t * const recorder_start_state =
         start_state.state;
-    action_replay_time_converter_t * const zero = action_replay_new(
-        action_replay_time_converter_t_class(),
-        action_replay_time_converter_t_args( 0 )
-    );
+    action_replay_time_t_converter_return_t const zero_time =
+        ACTION_REPLAY_DYNAMIC(
+            action_replay_time_t_converter_func_t,
+            converter,
+            recorder_start_state->zero_time
+        )( recorder_start_state->zero_time );
     action_replay_return_t result;
 
-    if( NULL == zero )
-    {
-        result.status = errno;
-        goto handle_time_converter_creation_error;
-    }
-    /* since we control creation, reflection isn't necessary */
-    worker_state->event_time = action_replay_new(
-        action_replay_time_t_class(),
-        action_replay_time_t_args( zero )
-    );
-    action_replay_delete( ( void * ) zero );
-    if( NULL == worker_state->event_time )
-    {
-        result.status = errno;
-        goto handle_event_time_creation_error;
-    }
+    if( 0 != ( result.status = zero_time.status ))
+    { goto handle_zero_time_conversion_error; }
+
+    action_replay_time_converter_t_return_t const zero_nanoseconds =
+        zero_time.converter->nanoseconds( zero_time.converter );
+
+    action_replay_delete( ( void * ) zero_time.converter );
+    if( 0 != ( result.status = zero_nanoseconds.status ))
+    { goto handle_zero_time_conversion_error; }
+    /* events are timed against a plain copy, no objects per event */
+    worker_state->zero_time = zero_nanoseconds.value;
 
     worker_state->descriptors[ POLL_INPUT_DESCRIPTOR ] = ( struct pollfd )
     { .fd = fileno( recorder_state->input ), .events = POLLIN };
     worker_state->descriptors[ POLL_RUN_FLAG_DESCRIPTOR ] = ( struct pollfd )
     { .fd = recorder_state->pipe_fd[ PIPE_READ ], .events = POLLIN };
-    /* zero_time was copied internally */
-    worker_state->zero_time = recorder_start_state->zero_time;
     worker_state->recorder_state = recorder_state;
 
+    action_replay_stoppable_t * const writer_thread =
+        recorder_state->writer_thread;
+
+    /* fails if already started, before ring is touched */
+    if(
+        ( NULL != writer_thread )
+        && ( 0 != ( result = writer_thread->start(
+            writer_thread,
+            action_replay_stoppable_t_start_state(
+                action_replay_recorder_t_writer,
+                worker_state
+            )
+        )).status )
+    ) { goto handle_writer_thread_start_error; }
     result = recorder_state->stoppable_start(
         self,
         action_replay_stoppable_t_start_state(
-            action_replay_recorder_t_worker,
+            recorder_state->has_uring
+                ? action_replay_recorder_t_uring_worker
+                : action_replay_recorder_t_worker,
             worker_state
         )
     );
@@ -421,10 +537,15 @@ static action_replay_return_t action_replay_recorder_t_start_func_t_start(
         recorder_state->worker_state = worker_state;
         return result;
     }
+    if( NULL != writer_thread )
+    {
+        action_replay_event_ring_t_close( &( recorder_state->ring ));
+        writer_thread->stop( writer_thread );
+        action_replay_event_ring_t_reset( &( recorder_state->ring ));
+    }
 
-    action_replay_delete( ( void * ) ( worker_state->event_time ));
-handle_event_time_creation_error:
-handle_time_converter_creation_error:
+handle_writer_thread_start_error:
+handle_zero_time_conversion_error:
     free( worker_state );
     action_replay_args_t_delete( start_state );
     return result;
@@ -463,36 +584,166 @@ static action_replay_return_t action_replay_recorder_t_stop_func_t_stop(
     result = recorder_state->stoppable_stop( self );
     /* at most one thread can succeed */
     if( 0 != result.status ) { return result; }
+    /* worker may have quit with requests still in flight */
+    if( recorder_state->has_uring )
+    {
+        action_replay_recorder_t_uring_drain( recorder_state );
+        LOG(
+            "worker %p made %" PRIu64 " io_uring_enter calls so far",
+            recorder_state->worker_state,
+            recorder_state->uring.enters
+        );
+    }
+    if( NULL != recorder_state->writer_thread )
+    {
+        action_replay_event_ring_t * const ring = &( recorder_state->ring );
+
+        /* wakes writer up, so it can be joined */
+        action_replay_event_ring_t_close( ring );
+        if( 0 != recorder_state->writer_thread->stop(
+            recorder_state->writer_thread
+        ).status )
+        {
+            LOG(
+                "failure stopping writer thread %p",
+                recorder_state->writer_thread
+            );
+        }
+        /* writer may have been stopped before it emptied the ring */
+        else
+        {
+            while( EAGAIN == action_replay_recorder_t_writer(
+                recorder_state->worker_state
+            ));
+        }
+        LOG(
+            "worker %p dropped %" PRIu64 " of %" PRIu64 " events,"
+            " ring high-water mark %" PRIu64 " of %" PRIu64 " events",
+            recorder_state->worker_state,
+            ring->dropped,
+            ring->pushed + ring->dropped,
+            ring->high_water_mark,
+            ( uint64_t ) ( ring->size - 1 )
+        );
+        action_replay_event_ring_t_reset( ring );
+    }
+    /* not an error of stop(), later delete() flushes again */
+    if( 0 != action_replay_recorder_io_writer_flush(
+        &( recorder_state->writer )
+    )) { LOG( "failure flushing events to %p", recorder_state->output ); }
+    LOG(
+        "worker %p read %" PRIu64 " events in %" PRIu64 " reads",
+        recorder_state->worker_state,
+        recorder_state->worker_state->events_read,
+        recorder_state->worker_state->reads
+    );
     /* XXX: possible leak */
     action_replay_args_t_delete( recorder_state->start_state );
     recorder_state->start_state = action_replay_args_t_default_args();
-    /* XXX: possible leak */
-    action_replay_delete(
-        ( void * ) recorder_state->worker_state->event_time
-    );
     free( recorder_state->worker_state );
     recorder_state->worker_state = NULL;
 
     return result;
 }
 
-static action_replay_error_t action_replay_recorder_t_worker_safe_input_read(
-    int fd,
-    struct input_event * const buf,
-    size_t const size
-);
-static action_replay_error_t action_replay_recorder_t_worker_safe_output_write(
-    struct input_event const event,
-    action_replay_time_t * const restrict event_time,
-    action_replay_time_t * const restrict zero_time,
-    FILE * const restrict output
-);
+/* EAGAIN once all are written */
+static action_replay_error_t action_replay_recorder_t_write_events(
+    action_replay_recorder_t_worker_state_t * const restrict worker_state,
+    struct input_event const * const restrict events,
+    size_t const count
+)
+{
+    action_replay_recorder_io_writer_t * const writer =
+        &( worker_state->recorder_state->writer );
+
+    for( size_t i = 0; i < count; ++i )
+    {
+        action_replay_error_t const result =
+            action_replay_recorder_io_write_event(
+                events[ i ],
+                &( worker_state->zero_time ),
+                writer
+            );
+
+        if( 0 != result )
+        {
+            LOG(
+                "failure writing entry to %p",
+                worker_state->recorder_state->output
+            );
+            return result;
+        }
+    }
+
+    return EAGAIN;
+}
+
+static action_replay_error_t action_replay_recorder_t_writer( void * state )
+{
+    action_replay_recorder_t_worker_state_t * const worker_state = state;
+    action_replay_event_ring_t * const ring =
+        &( worker_state->recorder_state->ring );
+    action_replay_recorder_io_writer_t * const writer =
+        &( worker_state->recorder_state->writer );
+    /* checked before popping, so nothing pushed before closing is lost */
+    bool const closed = action_replay_event_ring_t_is_closed( ring );
+    size_t const count = action_replay_event_ring_t_pop(
+        ring,
+        worker_state->written,
+        ACTION_REPLAY_RECORDER_IO_EVENTS_PER_READ
+    );
+
+    if( 0 < count )
+    {
+        return action_replay_recorder_t_write_events(
+            worker_state,
+            worker_state->written,
+            count
+        );
+    }
+    if( closed )
+    {
+        LOG( "writer of worker %p drained the ring", worker_state );
+        return ECANCELED;
+    }
+    if( ETIMEDOUT != action_replay_event_ring_t_wait(
+        ring,
+        action_replay_recorder_io_writer_timeout( writer )
+    )) { return EAGAIN; }
+
+    /* input went idle, buffered events shouldn't wait for more */
+    action_replay_error_t const result =
+        action_replay_recorder_io_writer_flush( writer );
+
+    return ( 0 == result ) ? EAGAIN : result;
+}
 
 static action_replay_error_t action_replay_recorder_t_worker( void * state )
 {
     action_replay_recorder_t_worker_state_t * const worker_state = state;
+    action_replay_recorder_t_state_t * const recorder_state =
+        worker_state->recorder_state;
+    action_replay_recorder_io_writer_t * const writer =
+        &( recorder_state->writer );
+
+    ++( recorder_state->polls );
+    /* writer belongs to writer thread if there's one */
+    int const poll_result = poll(
+        worker_state->descriptors,
+        POLL_DESCRIPTORS_COUNT,
+        ( NULL == recorder_state->writer_thread )
+            ? action_replay_recorder_io_writer_timeout( writer )
+            : ACTION_REPLAY_RECORDER_IO_INFINITE_WAIT
+    );
+
+    /* input went idle, buffered events shouldn't wait for more */
+    if( 0 == poll_result )
+    {
+        action_replay_error_t const result =
+            action_replay_recorder_io_writer_flush( writer );
 
-    poll( worker_state->descriptors, POLL_DESCRIPTORS_COUNT, INFINITE_WAIT );
+        return ( 0 == result ) ? EAGAIN : result;
+    }
 
     if( POLLIN == (
         worker_state->descriptors[ POLL_RUN_FLAG_DESCRIPTOR ].revents & POLLIN
@@ -526,146 +777,376 @@ static action_replay_error_t action_replay_recorder_t_worker( void * state )
         return EAGAIN;
     }
 
-    action_replay_error_t result;
+    action_replay_recorder_io_read_return_t const read_result =
+        action_replay_recorder_io_read(
+            worker_state->descriptors[ POLL_INPUT_DESCRIPTOR ].fd,
+            worker_state->events,
+            ACTION_REPLAY_RECORDER_IO_EVENTS_PER_READ
+        );
 
-    result = action_replay_recorder_t_worker_safe_input_read(
-        worker_state->descriptors[ POLL_INPUT_DESCRIPTOR ].fd,
-        &( worker_state->event ),
-        sizeof( struct input_event )
-    );
-    if( 0 != result )
+    if( 0 != read_result.status )
     {
         LOG( "failed read from %p", worker_state->recorder_state->input );
-        return result;
+        return read_result.status;
     }
-    result = action_replay_recorder_t_worker_safe_output_write(
-        worker_state->event,
-        worker_state->event_time,
-        worker_state->zero_time,
-        worker_state->recorder_state->output
-    );
-    if( 0 != result )
+    ++( worker_state->reads );
+    worker_state->events_read += read_result.count;
+    if( NULL == recorder_state->writer_thread )
     {
-        LOG(
-            "failure writing entry to %p",
-            worker_state->recorder_state->output
+        return action_replay_recorder_t_write_events(
+            worker_state,
+            worker_state->events,
+            read_result.count
         );
-        return result;
     }
+    /* never blocks, events which don't fit are counted as dropped */
+    action_replay_event_ring_t_push(
+        &( recorder_state->ring ),
+        worker_state->events,
+        read_result.count
+    );
 
     return EAGAIN;
 }
 
-static action_replay_error_t
-action_replay_recorder_t_worker_safe_input_read(
-    int fd,
-    struct input_event * const buf,
-    size_t const size
+/* stops worker once requests in flight complete */
+static void action_replay_recorder_t_uring_fail(
+    action_replay_recorder_t_worker_state_t * const worker_state,
+    action_replay_error_t const error
 )
 {
-    if( size > SSIZE_MAX )
+    LOG( "failure in worker %p io_uring, errno = %d", worker_state, error );
+    if( 0 == worker_state->uring.status )
+    { worker_state->uring.status = error; }
+    worker_state->uring.stopping = true;
+}
+
+/* next read might not fit in writer without flushing */
+static inline bool action_replay_recorder_t_uring_writer_full(
+    action_replay_recorder_io_writer_t const * const writer
+)
+{
+    return ACTION_REPLAY_RECORDER_IO_BUFFER_SIZE - writer->length
+        < ACTION_REPLAY_RECORDER_IO_EVENTS_PER_READ
+            * ACTION_REPLAY_RECORDER_IO_EVENT_MAX_LEN;
+}
+
+static action_replay_error_t action_replay_recorder_t_uring_write(
+    action_replay_recorder_t_worker_state_t * const worker_state
+)
+{
+    action_replay_recorder_t_state_t * const recorder_state =
+        worker_state->recorder_state;
+
+    worker_state->uring.write_in_flight = true;
+    return action_replay_uring_t_write(
+        &( recorder_state->uring ),
+        recorder_state->writer.fd,
+        worker_state->uring.in_flight + worker_state->uring.written_length,
+        worker_state->uring.in_flight_length
+            - worker_state->uring.written_length,
+        URING_WRITE
+    );
+}
+
+/* writer buffer is free again right away */
+static action_replay_error_t action_replay_recorder_t_uring_flush(
+    action_replay_recorder_t_worker_state_t * const worker_state
+)
+{
+    action_replay_recorder_io_writer_t * const writer =
+        &( worker_state->recorder_state->writer );
+
+    memcpy( worker_state->uring.in_flight, writer->buffer, writer->length );
+    worker_state->uring.in_flight_length = writer->length;
+    worker_state->uring.written_length = 0;
+    writer->length = 0;
+
+    return action_replay_recorder_t_uring_write( worker_state );
+}
+
+/* queues whatever isn't in flight yet, or cancels it all when stopping */
+static action_replay_error_t action_replay_recorder_t_uring_arm(
+    action_replay_recorder_t_worker_state_t * const worker_state
+)
+{
+    action_replay_recorder_t_state_t * const recorder_state =
+        worker_state->recorder_state;
+    action_replay_uring_t * const uring = &( recorder_state->uring );
+    action_replay_recorder_io_writer_t * const writer =
+        &( recorder_state->writer );
+    action_replay_error_t result = 0;
+
+    if( worker_state->uring.stopping )
+    {
+        if( worker_state->uring.cancelled ) { return result; }
+        worker_state->uring.cancelled = true;
+        if( worker_state->uring.input_armed )
+        {
+            result = action_replay_uring_t_cancel(
+                uring,
+                URING_INPUT,
+                URING_CANCEL
+            );
+        }
+        if(( 0 == result ) && worker_state->uring.run_flag_armed )
+        {
+            result = action_replay_uring_t_cancel(
+                uring,
+                URING_RUN_FLAG,
+                URING_CANCEL
+            );
+        }
+        if(( 0 == result ) && worker_state->uring.timeout_armed )
+        {
+            result = action_replay_uring_t_cancel(
+                uring,
+                URING_TIMEOUT,
+                URING_CANCEL
+            );
+        }
+        return result;
+    }
+    if( ! worker_state->uring.run_flag_armed )
+    {
+        result = action_replay_uring_t_read(
+            uring,
+            recorder_state->pipe_fd[ PIPE_READ ],
+            &( worker_state->uring.run_flag ),
+            1,
+            URING_RUN_FLAG
+        );
+        if( 0 != result ) { return result; }
+        worker_state->uring.run_flag_armed = true;
+    }
+    if(
+        ( ! worker_state->uring.write_in_flight )
+        && action_replay_recorder_t_uring_writer_full( writer )
+        && ( 0 != ( result =
+            action_replay_recorder_t_uring_flush( worker_state )
+        ))
+    ) { return result; }
+    /* input waits in kernel until there's room for it */
+    if(
+        ( ! worker_state->uring.input_armed )
+        && ( ! action_replay_recorder_t_uring_writer_full( writer ))
+    )
+    {
+        result = action_replay_uring_t_read(
+            uring,
+            worker_state->descriptors[ POLL_INPUT_DESCRIPTOR ].fd,
+            ( uint8_t * ) worker_state->events
+                + worker_state->uring.input_length,
+            sizeof( worker_state->events ) - worker_state->uring.input_length,
+            URING_INPUT
+        );
+        if( 0 != result ) { return result; }
+        worker_state->uring.input_armed = true;
+    }
+    /* input going idle shouldn't leave events buffered */
+    if(( ! worker_state->uring.timeout_armed ) && ( 0 < writer->length ))
+    {
+        result = action_replay_uring_t_timeout(
+            uring,
+            ACTION_REPLAY_RECORDER_IO_FLUSH_TIMEOUT,
+            URING_TIMEOUT
+        );
+        if( 0 != result ) { return result; }
+        worker_state->uring.timeout_armed = true;
+    }
+
+    return result;
+}
+
+static void action_replay_recorder_t_uring_input(
+    action_replay_recorder_t_worker_state_t * const worker_state,
+    int32_t const result
+)
+{
+    worker_state->uring.input_armed = false;
+    if( -ECANCELED == result ) { return; }
+    /* EOF in input stream should not happen */
+    if( 0 >= result )
     {
-        LOG( "requested size is invalid" );
-        return EINVAL;
+        action_replay_recorder_t_uring_fail(
+            worker_state,
+            ( 0 == result ) ? EIO : -result
+        );
+        return;
     }
 
-    uint8_t * const u8_casted_buf = ( void * ) buf;
-    ssize_t count = 0;
+    /* evdev gives whole events, but other sources may split them */
+    size_t const length = worker_state->uring.input_length + result;
+    size_t const count = length / sizeof( struct input_event );
+
+    ++( worker_state->reads );
+    worker_state->events_read += count;
 
-    do {
-        ssize_t read_result = read(
-            fd,
-            u8_casted_buf + count,
-            size - count
+    action_replay_error_t const write_result =
+        action_replay_recorder_t_write_events(
+            worker_state,
+            worker_state->events,
+            count
         );
-        /* EOF in input stream should not happen */
-        if( 0 == read_result ) { return EIO; }
-        if( -1 == read_result ) { return errno; }
-        count += read_result;
-    } while( count < ( ssize_t const ) size );
 
-    return 0;
+    if( EAGAIN != write_result )
+    {
+        action_replay_recorder_t_uring_fail( worker_state, write_result );
+        return;
+    }
+    worker_state->uring.input_length = length % sizeof( struct input_event );
+    memmove(
+        worker_state->events,
+        worker_state->events + count,
+        worker_state->uring.input_length
+    );
 }
 
-static action_replay_error_t action_replay_recorder_t_worker_safe_output_write(
-    struct input_event const event,
-    action_replay_time_t * const restrict event_time,
-    action_replay_time_t * const restrict zero_time,
-    FILE * const restrict output
+static void action_replay_recorder_t_uring_complete(
+    action_replay_recorder_t_worker_state_t * const worker_state,
+    action_replay_uring_t_completion_return_t const completion
 )
 {
-    static char const * const json =
-        "\n{ \"time\": %"PRIu64
-        ", \"type\": %hu, \"code\": %hu, \"value\": %d }";
-    action_replay_return_t result;
-    action_replay_time_converter_t * const event_time_converter =
-        action_replay_new(
-            action_replay_time_converter_t_class(),
-            action_replay_time_converter_t_args(
-                action_replay_time_converter_t_from_timeval( event.time )
+    action_replay_recorder_io_writer_t * const writer =
+        &( worker_state->recorder_state->writer );
+    action_replay_error_t result = 0;
+
+    switch( completion.user_data )
+    {
+        case URING_INPUT:
+            action_replay_recorder_t_uring_input(
+                worker_state,
+                completion.result
+            );
+            return;
+        case URING_RUN_FLAG:
+            worker_state->uring.run_flag_armed = false;
+            LOG(
+                "worker %p ordered to stop reading events from %p",
+                worker_state,
+                worker_state->recorder_state->input
+            );
+            worker_state->uring.stopping = true;
+            return;
+        case URING_WRITE:
+            if( 0 > completion.result )
+            {
+                worker_state->uring.write_in_flight = false;
+                result = -completion.result;
+                break;
+            }
+            worker_state->uring.written_length += completion.result;
+            if(
+                worker_state->uring.in_flight_length
+                > worker_state->uring.written_length
             )
-        );
+            {
+                result = action_replay_recorder_t_uring_write( worker_state );
+                break;
+            }
+            worker_state->uring.write_in_flight = false;
+            return;
+        case URING_TIMEOUT:
+            worker_state->uring.timeout_armed = false;
+            if(
+                ( -ETIME == completion.result )
+                && ( ! worker_state->uring.write_in_flight )
+                && ( 0 < writer->length )
+            ) { result = action_replay_recorder_t_uring_flush( worker_state ); }
+            break;
+        default: /* cancellations */
+            return;
+    }
+    if( 0 != result )
+    { action_replay_recorder_t_uring_fail( worker_state, result ); }
+}
 
-    if( NULL == event_time_converter ) { return errno; }
+static inline bool action_replay_recorder_t_uring_idle(
+    action_replay_recorder_t_worker_state_t const * const worker_state
+)
+{
+    return ( ! worker_state->uring.input_armed )
+        && ( ! worker_state->uring.run_flag_armed )
+        && ( ! worker_state->uring.timeout_armed )
+        && ( ! worker_state->uring.write_in_flight );
+}
 
-    action_replay_time_t_converter_return_t const zero_time_converter =
-        ACTION_REPLAY_DYNAMIC(
-            action_replay_time_t_converter_func_t,
-            converter,
-            zero_time
-        )( zero_time );
-
-    if( 0 != zero_time_converter.status )
-    { return zero_time_converter.status; }
-    result = event_time->set( event_time, event_time_converter );
-    action_replay_delete( ( void * ) event_time_converter );
-    if( 0 != result.status ) { return result.status; }
-    result = event_time->sub( event_time, zero_time_converter.converter );
-    action_replay_delete( ( void * ) zero_time_converter.converter );
-    if( 0 != result.status ) { return result.status; }
-
-    action_replay_time_t_converter_return_t const result_converter =
-        event_time->converter( event_time );
-
-    if( 0 != result_converter.status ) { return result_converter.status; }
-    result =
-        ACTION_REPLAY_DYNAMIC( action_replay_time_t_func_t, add, zero_time )(
-            zero_time,
-            result_converter.converter
-        );
-    if( 0 != result.status ) { return result.status; }
+/*
+ * no poll, read or write syscall per event:
+ * one io_uring_enter both hands over re-armed reads and pending writes,
+ * and waits for them to complete
+ */
+static action_replay_error_t
+action_replay_recorder_t_uring_worker( void * state )
+{
+    action_replay_recorder_t_worker_state_t * const worker_state = state;
+    action_replay_uring_t * const uring =
+        &( worker_state->recorder_state->uring );
+    action_replay_error_t result =
+        action_replay_recorder_t_uring_arm( worker_state );
 
-    action_replay_time_converter_t_return_t nanoseconds =
-        result_converter.converter->nanoseconds( result_converter.converter );
+    /* whatever got queued is still submitted, cancels come next time */
+    if( 0 != result )
+    { action_replay_recorder_t_uring_fail( worker_state, result ); }
+    /* buffers belong to the worker, nothing may be left in flight */
+    if(
+        worker_state->uring.stopping
+        && action_replay_recorder_t_uring_idle( worker_state )
+    )
+    {
+        return ( 0 == worker_state->uring.status )
+            ? ECANCELED
+            : worker_state->uring.status;
+    }
+    result = action_replay_uring_t_submit_and_wait( uring );
+    if( EINTR == result ) { return EAGAIN; }
+    if( 0 != result )
+    {
+        LOG( "failure waiting on io_uring in worker %p", worker_state );
+        return result;
+    }
 
-    action_replay_delete( ( void * ) result_converter.converter );
-    if( 0 != nanoseconds.status ) { return nanoseconds.status; }
+    action_replay_uring_t_completion_return_t completion;
 
-    int const fprintf_result = fprintf(
-        output,
-        json,
-        nanoseconds.value,
-        event.type,
-        event.code,
-        event.value
-    );
+    while( 0 == ( completion = action_replay_uring_t_pop( uring )).status )
+    { action_replay_recorder_t_uring_complete( worker_state, completion ); }
 
-    return ( 0 < fprintf_result ) ? 0 : EINVAL;
+    return EAGAIN;
 }
 
-static inline action_replay_error_t action_replay_recorder_t_write_header(
-    char const * const path_to_input_device,
-    FILE * const output
+/*
+ * kernel reads into and writes from worker state, so it can't be freed
+ * until nothing is in flight; a ring that can't be waited on is closed,
+ * which cancels the rest, and a new one is set up for later starts
+ */
+static void action_replay_recorder_t_uring_drain(
+    action_replay_recorder_t_state_t * const recorder_state
 )
 {
-    static char const * const header_string = "{ \"file\": \"%s\" }";
-    int const fprintf_result = fprintf(
-        output,
-        header_string,
-        path_to_input_device
-    );
+    action_replay_recorder_t_worker_state_t * const worker_state =
+        recorder_state->worker_state;
 
-    return ( 0 < fprintf_result ) ? 0 : EINVAL;
+    /* worker quitting on an error doesn't cancel anything by itself */
+    worker_state->uring.stopping = true;
+    while( ! action_replay_recorder_t_uring_idle( worker_state ))
+    {
+        if(
+            ( EAGAIN
+                == action_replay_recorder_t_uring_worker( worker_state ))
+            || action_replay_recorder_t_uring_idle( worker_state )
+        ) { continue; }
+        LOG( "failure draining io_uring of worker %p", worker_state );
+        if( 0 != action_replay_uring_t_destroy(
+            &( recorder_state->uring )
+        ).status ) { LOG( "failure closing io_uring" ); }
+        recorder_state->has_uring = ( 0 == action_replay_uring_t_init(
+            &( recorder_state->uring ),
+            URING_ENTRIES
+        ).status );
+        if( ! recorder_state->has_uring )
+        { LOG( "failure setting up io_uring again, falling back to poll" ); }
+        return;
+    }
 }
 
 static action_replay_return_t
@@ -743,6 +1224,8 @@ action_replay_class_t const * action_replay_recorder_t_class( void )
         action_replay_stoppable_t_class,
         NULL
     };
+    static action_replay_reflection_cache_t reflection_cache;
+    static action_replay_class_t_ancestry_t ancestry;
     static action_replay_class_t const result =
     {
         sizeof( action_replay_recorder_t ),
@@ -750,7 +1233,10 @@ action_replay_class_t const * action_replay_recorder_t_class( void )
         action_replay_recorder_t_destructor,
         action_replay_recorder_t_copier,
         action_replay_recorder_t_reflector,
-        inheritance
+        &reflection_cache,
+        inheritance,
+        &ancestry,
+        NULL
     };
 
     return &result;
@@ -782,6 +1268,10 @@ action_replay_recorder_t_args_t_copier( void * const state )
     action_replay_recorder_t_args_t const * const original_recorder_args =
         state;
 
+    recorder_args->format = original_recorder_args->format;
+    recorder_args->ring_capacity = original_recorder_args->ring_capacity;
+    recorder_args->backend = original_recorder_args->backend;
+
     recorder_args->path_to_input_device = action_replay_strndup(
         original_recorder_args->path_to_input_device,
         INPUT_MAX_LEN
@@ -811,7 +1301,10 @@ handle_path_to_input_device_calloc_error:
 
 action_replay_args_t action_replay_recorder_t_args(
     char const * const restrict path_to_input_device,
-    char const * const restrict path_to_output
+    char const * const restrict path_to_output,
+    action_replay_recorder_io_format_t const format,
+    size_t const ring_capacity,
+    action_replay_recorder_t_backend_t const backend
 )
 {
     action_replay_args_t result = action_replay_args_t_default_args();
@@ -822,7 +1315,10 @@ action_replay_args_t action_replay_recorder_t_args(
     action_replay_recorder_t_args_t args =
     {
         action_replay_strndup( path_to_input_device, INPUT_MAX_LEN ),
-        action_replay_strndup( path_to_output, INPUT_MAX_LEN )
+        action_replay_strndup( path_to_output, INPUT_MAX_LEN ),
+        format,
+        ring_capacity,
+        backend
     };
 
     if(
@@ -849,3 +1345,37 @@ handle_error:
     return result;
 }
 
+
+action_replay_recorder_t_stats_return_t
+action_replay_recorder_t_stats( action_replay_recorder_t * const recorder )
+{
+    if(
+        ( NULL == recorder )
+        || ( ! action_replay_is_type(
+            ( void * ) recorder,
+            action_replay_recorder_t_class()
+        ))
+    )
+    {
+        return ( action_replay_recorder_t_stats_return_t const )
+        { EINVAL, 0, 0, 0 };
+    }
+
+    action_replay_recorder_t_state_t const * const recorder_state =
+        ACTION_REPLAY_DYNAMIC(
+            action_replay_recorder_t_state_t *,
+            recorder_state,
+            recorder
+        );
+
+    /* ring stays zeroed without a writer thread */
+    return ( action_replay_recorder_t_stats_return_t const )
+    {
+        0,
+        recorder_state->polls + (
+            ( recorder_state->has_uring ) ? recorder_state->uring.enters : 0
+        ),
+        recorder_state->ring.sleeps,
+        recorder_state->ring.wakes
+    };
+}
@@ -0,0 +1,359 @@
+#define __STDC_FORMAT_MACROS
+
+#include "action_replay/binary_recording.h"
+#include "action_replay/error.h"
+#include "action_replay/inttypes.h"
+#include "action_replay/limits.h"
+#include "action_replay/log.h"
+#include "action_replay/nanoseconds.h"
+#include "action_replay/recorder_io.h"
+#include "action_replay/stddef.h"
+#include "action_replay/stdint.h"
+#include "action_replay/sys/types.h"
+#include <errno.h>
+#include <linux/input.h>
+#include <string.h>
+#include <unistd.h>
+
+action_replay_recorder_io_read_return_t action_replay_recorder_io_read(
+    int const fd,
+    struct input_event * const buf,
+    size_t const max_count
+)
+{
+    size_t const size = max_count * sizeof( struct input_event );
+
+    if(( 0 == max_count ) || ( size > SSIZE_MAX ))
+    {
+        LOG( "requested size is invalid" );
+        return ( action_replay_recorder_io_read_return_t const ) { EINVAL, 0 };
+    }
+
+    uint8_t * const u8_casted_buf = ( void * ) buf;
+    ssize_t count = 0;
+
+    /* evdev gives whole events, but other sources may split them */
+    do {
+        ssize_t read_result = read(
+            fd,
+            u8_casted_buf + count,
+            ( 0 == count )
+                ? size
+                : sizeof( struct input_event )
+                    - ( count % sizeof( struct input_event ))
+        );
+        /* EOF in input stream should not happen */
+        if( 0 == read_result )
+        { return ( action_replay_recorder_io_read_return_t const ) { EIO, 0 }; }
+        if( -1 == read_result )
+        {
+            return ( action_replay_recorder_io_read_return_t const )
+            { errno, 0 };
+        }
+        count += read_result;
+    } while( 0 != ( count % sizeof( struct input_event )));
+
+    return ( action_replay_recorder_io_read_return_t const )
+    { 0, count / sizeof( struct input_event ) };
+}
+
+#define UINT64_MAX_DIGITS 20
+
+static char const digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/* returns count of written digits, same as %PRIu64 */
+static inline size_t action_replay_recorder_io_format_uint64(
+    char * const restrict output,
+    uint64_t value
+)
+{
+    char digits[ UINT64_MAX_DIGITS ];
+    char * start = digits + UINT64_MAX_DIGITS;
+
+    while( 100 <= value )
+    {
+        unsigned int const pair = ( unsigned int ) ( value % 100 ) * 2;
+
+        value /= 100;
+        start -= 2;
+        start[ 0 ] = digit_pairs[ pair ];
+        start[ 1 ] = digit_pairs[ pair + 1 ];
+    }
+    if( 10 <= value )
+    {
+        start -= 2;
+        start[ 0 ] = digit_pairs[ value * 2 ];
+        start[ 1 ] = digit_pairs[ value * 2 + 1 ];
+    }
+    else { *( --start ) = ( char ) ( '0' + value ); }
+
+    size_t const length = ( size_t ) ( digits + UINT64_MAX_DIGITS - start );
+
+    memcpy( output, start, length );
+    return length;
+}
+
+/* same as %d */
+static inline size_t action_replay_recorder_io_format_int32(
+    char * const restrict output,
+    int32_t const value
+)
+{
+    if( 0 <= value )
+    { return action_replay_recorder_io_format_uint64( output, value ); }
+    output[ 0 ] = '-';
+    /* negated in unsigned arithmetic, so INT32_MIN doesn't overflow */
+    return 1 + action_replay_recorder_io_format_uint64(
+        output + 1,
+        ( uint64_t ) ( 0U - ( uint32_t ) value )
+    );
+}
+
+static inline size_t action_replay_recorder_io_copy(
+    char * const restrict output,
+    char const * const restrict literal,
+    size_t const length
+)
+{
+    memcpy( output, literal, length );
+    return length;
+}
+
+#define COPY_LITERAL( output, literal ) \
+    action_replay_recorder_io_copy( output, literal, sizeof( literal ) - 1 )
+
+void action_replay_recorder_io_writer_init(
+    action_replay_recorder_io_writer_t * const writer,
+    int const fd,
+    action_replay_recorder_io_format_t const format
+)
+{
+    writer->fd = fd;
+    writer->format = format;
+    writer->length = 0;
+}
+
+static action_replay_error_t action_replay_recorder_io_write_all(
+    int const fd,
+    char const * const buffer,
+    size_t const length
+)
+{
+    size_t offset = 0;
+
+    while( length > offset )
+    {
+        ssize_t const write_result =
+            write( fd, buffer + offset, length - offset );
+
+        if( -1 == write_result )
+        {
+            if( EINTR == errno ) { continue; }
+            return errno;
+        }
+        offset += write_result;
+    }
+
+    return 0;
+}
+
+action_replay_error_t action_replay_recorder_io_writer_flush(
+    action_replay_recorder_io_writer_t * const writer
+)
+{
+    action_replay_error_t const result = action_replay_recorder_io_write_all(
+        writer->fd,
+        writer->buffer,
+        writer->length
+    );
+
+    if( 0 == result ) { writer->length = 0; }
+
+    return result;
+}
+
+/* flushes if length bytes don't fit after buffered ones */
+static inline action_replay_error_t action_replay_recorder_io_writer_reserve(
+    action_replay_recorder_io_writer_t * const writer,
+    size_t const length
+)
+{
+    if( ACTION_REPLAY_RECORDER_IO_BUFFER_SIZE - writer->length >= length )
+    { return 0; }
+
+    return action_replay_recorder_io_writer_flush( writer );
+}
+
+action_replay_error_t action_replay_recorder_io_writer_append(
+    action_replay_recorder_io_writer_t * const restrict writer,
+    void const * const restrict data,
+    size_t const length
+)
+{
+    action_replay_error_t const result =
+        action_replay_recorder_io_writer_reserve( writer, length );
+
+    if( 0 != result ) { return result; }
+    /* too large to be buffered at all */
+    if( ACTION_REPLAY_RECORDER_IO_BUFFER_SIZE < length )
+    { return action_replay_recorder_io_write_all( writer->fd, data, length ); }
+    memcpy( writer->buffer + writer->length, data, length );
+    writer->length += length;
+
+    return 0;
+}
+
+static action_replay_error_t action_replay_recorder_io_write_binary_header(
+    char const * const restrict path_to_input_device,
+    action_replay_recorder_io_writer_t * const restrict writer
+)
+{
+    static char const padding[
+        sizeof( action_replay_binary_recording_record_t )
+    ];
+    size_t const path_length = strlen( path_to_input_device );
+
+    if( UINT32_MAX < path_length ) { return EINVAL; }
+
+    action_replay_binary_recording_header_t const header =
+    {
+        ACTION_REPLAY_BINARY_RECORDING_MAGIC,
+        ACTION_REPLAY_BINARY_RECORDING_VERSION,
+        ( uint32_t ) path_length
+    };
+    /* NUL terminator comes from the padding */
+    size_t const padding_length =
+        action_replay_binary_recording_records_offset( path_length )
+        - sizeof( header ) - path_length;
+    action_replay_error_t result;
+
+    if(
+        ( 0 != ( result = action_replay_recorder_io_writer_append(
+            writer,
+            &header,
+            sizeof( header )
+        )))
+        || ( 0 != ( result = action_replay_recorder_io_writer_append(
+            writer,
+            path_to_input_device,
+            path_length
+        )))
+    ) { return result; }
+
+    return action_replay_recorder_io_writer_append(
+        writer,
+        padding,
+        padding_length
+    );
+}
+
+action_replay_error_t action_replay_recorder_io_write_header(
+    char const * const restrict path_to_input_device,
+    action_replay_recorder_io_writer_t * const restrict writer
+)
+{
+    if( ACTION_REPLAY_RECORDER_IO_BINARY == writer->format )
+    {
+        return action_replay_recorder_io_write_binary_header(
+            path_to_input_device,
+            writer
+        );
+    }
+
+    static char const header_start[] = "{ \"file\": \"";
+    static char const header_end[] = "\" }";
+    action_replay_error_t result;
+
+    if(
+        ( 0 != ( result = action_replay_recorder_io_writer_append(
+            writer,
+            header_start,
+            sizeof( header_start ) - 1
+        )))
+        || ( 0 != ( result = action_replay_recorder_io_writer_append(
+            writer,
+            path_to_input_device,
+            strlen( path_to_input_device )
+        )))
+    ) { return result; }
+
+    return action_replay_recorder_io_writer_append(
+        writer,
+        header_end,
+        sizeof( header_end ) - 1
+    );
+}
+
+action_replay_error_t action_replay_recorder_io_write_event(
+    struct input_event const event,
+    uint64_t * const restrict zero_time,
+    action_replay_recorder_io_writer_t * const restrict writer
+)
+{
+    uint64_t const event_time =
+        action_replay_nanoseconds_from_timeval( event.time );
+    action_replay_nanoseconds_return_t const nanoseconds =
+        action_replay_nanoseconds_sub( event_time, *zero_time );
+
+    if( 0 != nanoseconds.status )
+    {
+        LOG(
+            "substracting later time from earlier time is not allowed: %"
+            PRIu64" - %"PRIu64,
+            event_time,
+            *zero_time
+        );
+        return nanoseconds.status;
+    }
+    *zero_time = event_time;
+
+    if( ACTION_REPLAY_RECORDER_IO_BINARY == writer->format )
+    {
+        action_replay_binary_recording_record_t const record =
+        { nanoseconds.value, event.type, event.code, event.value };
+
+        return action_replay_recorder_io_writer_append(
+            writer,
+            &record,
+            sizeof( record )
+        );
+    }
+
+    action_replay_error_t const result =
+        action_replay_recorder_io_writer_reserve(
+            writer,
+            ACTION_REPLAY_RECORDER_IO_EVENT_MAX_LEN
+        );
+
+    if( 0 != result ) { return result; }
+
+    /* \n{ "time": %PRIu64, "type": %hu, "code": %hu, "value": %d } */
+    char * const start = writer->buffer + writer->length;
+    char * output = start;
+
+    output += COPY_LITERAL( output, "\n{ \"time\": " );
+    output += action_replay_recorder_io_format_uint64(
+        output,
+        nanoseconds.value
+    );
+    output += COPY_LITERAL( output, ", \"type\": " );
+    output += action_replay_recorder_io_format_uint64( output, event.type );
+    output += COPY_LITERAL( output, ", \"code\": " );
+    output += action_replay_recorder_io_format_uint64( output, event.code );
+    output += COPY_LITERAL( output, ", \"value\": " );
+    output += action_replay_recorder_io_format_int32( output, event.value );
+    output += COPY_LITERAL( output, " }" );
+    writer->length += ( size_t ) ( output - start );
+
+    return 0;
+}
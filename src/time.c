@@ -5,9 +5,11 @@
 #include "action_replay/inttypes.h"
 #include "action_replay/limits.h"
 #include "action_replay/log.h"
+#include "action_replay/nanoseconds.h"
 #include "action_replay/object.h"
 #include "action_replay/object_oriented_programming.h"
 #include "action_replay/object_oriented_programming_super.h"
+#include "action_replay/pool.h"
 #include "action_replay/return.h"
 #include "action_replay/stateful_return.h"
 #include "action_replay/stdint.h"
@@ -18,12 +20,16 @@
 
 struct action_replay_time_t_state_t { uint64_t nanoseconds; };
 
+/* states and args of short-lived objects, one block each */
+static action_replay_pool_t state_pool =
+    ACTION_REPLAY_POOL_T_INITIALIZER( sizeof( action_replay_time_t_state_t ));
+
 static action_replay_stateful_return_t
 action_replay_time_t_state_t_new( uint64_t const nanoseconds )
 {
     action_replay_stateful_return_t result;
 
-    result.state = calloc( 1, sizeof( action_replay_time_t_state_t ));
+    result.state = action_replay_pool_t_alloc( &state_pool );
     if( NULL == result.state )
     {
         result.status = ENOMEM;
@@ -41,7 +47,7 @@ static action_replay_return_t action_replay_time_t_state_t_delete(
     action_replay_time_t_state_t * const time_state
 )
 {
-    free( time_state );
+    action_replay_pool_t_free( &state_pool, time_state );
     return ( action_replay_return_t ) { 0 };
 }
 
@@ -274,13 +280,20 @@ static action_replay_return_t action_replay_time_t_func_t_add(
 
     if( 0 != nanoseconds.status )
     { return ( action_replay_return_t ) { nanoseconds.status }; }
-    if(( UINT64_MAX - nanoseconds.value ) < time_state->nanoseconds )
+
+    action_replay_nanoseconds_return_t const sum =
+        action_replay_nanoseconds_add(
+            time_state->nanoseconds,
+            nanoseconds.value
+        );
+
+    if( 0 != sum.status )
     {
         LOG( "cannot add - resulting value would overflow" );
-        return ( action_replay_return_t const ) { E2BIG };
+        return ( action_replay_return_t const ) { sum.status };
     }
 
-    time_state->nanoseconds += nanoseconds.value;
+    time_state->nanoseconds = sum.value;
     return ( action_replay_return_t const ) { 0 };
 }
 
@@ -313,7 +326,14 @@ static action_replay_return_t action_replay_time_t_func_t_sub(
 
     if( 0 != nanoseconds.status )
     { return ( action_replay_return_t ) { nanoseconds.status }; }
-    if( nanoseconds.value > time_state->nanoseconds )
+
+    action_replay_nanoseconds_return_t const difference =
+        action_replay_nanoseconds_sub(
+            time_state->nanoseconds,
+            nanoseconds.value
+        );
+
+    if( 0 != difference.status )
     {
         LOG(
             "substracting later time from earlier time is not allowed: %"
@@ -322,10 +342,10 @@ static action_replay_return_t action_replay_time_t_func_t_sub(
             nanoseconds.value
         );
 
-        return ( action_replay_return_t const ) { E2BIG };
+        return ( action_replay_return_t const ) { difference.status };
     }
 
-    time_state->nanoseconds -= nanoseconds.value;
+    time_state->nanoseconds = difference.value;
     return ( action_replay_return_t const ) { 0 };
 }
 
@@ -367,6 +387,11 @@ action_replay_class_t const * action_replay_time_t_class( void )
 {
     static action_replay_class_t_func_t const inheritance[] =
     { action_replay_object_t_class, NULL };
+    static action_replay_reflection_cache_t reflection_cache;
+    static action_replay_class_t_ancestry_t ancestry;
+    /* short-lived, mostly temporaries of conversions */
+    static action_replay_pool_t pool =
+        ACTION_REPLAY_POOL_T_INITIALIZER( sizeof( action_replay_time_t ));
     static action_replay_class_t const result =
     {
         sizeof( action_replay_time_t ),
@@ -374,7 +399,10 @@ action_replay_class_t const * action_replay_time_t_class( void )
         action_replay_time_t_destructor,
         action_replay_time_t_copier,
         action_replay_time_t_reflector,
-        inheritance
+        &reflection_cache,
+        inheritance,
+        &ancestry,
+        &pool
     };
 
     return &result;
@@ -383,7 +411,7 @@ action_replay_class_t const * action_replay_time_t_class( void )
 static action_replay_return_t
 action_replay_time_t_args_t_destructor( void * const state )
 {
-    free( state );
+    action_replay_pool_t_free( &state_pool, state );
     return ( action_replay_return_t const ) { 0 };
 }
 
@@ -392,7 +420,7 @@ action_replay_time_t_args_t_copier( void * const state )
 {
     action_replay_stateful_return_t result;
 
-    result.state = calloc( 1, sizeof( action_replay_time_t_state_t ));
+    result.state = action_replay_pool_t_alloc( &state_pool );
     if( NULL == result.state )
     {
         result.status = ENOMEM;
@@ -1,10 +1,10 @@
-#define _POSIX_C_SOURCE 199309L /* clock_gettime */
-
 #include "action_replay/args.h"
 #include "action_replay/class.h"
+#include "action_replay/nanoseconds.h"
 #include "action_replay/object.h"
 #include "action_replay/object_oriented_programming.h"
 #include "action_replay/object_oriented_programming_super.h"
+#include "action_replay/pool.h"
 #include "action_replay/return.h"
 #include "action_replay/stateful_return.h"
 #include "action_replay/stdint.h"
@@ -24,12 +24,17 @@
 
 struct action_replay_time_converter_t_state_t { uint64_t nanoseconds; };
 
+/* states and args of short-lived objects, one block each */
+static action_replay_pool_t state_pool = ACTION_REPLAY_POOL_T_INITIALIZER(
+    sizeof( action_replay_time_converter_t_state_t )
+);
+
 static action_replay_stateful_return_t
 action_replay_time_converter_t_state_t_new( uint64_t const nanoseconds )
 {
     action_replay_stateful_return_t result;
 
-    result.state = calloc( 1, sizeof( action_replay_time_converter_t_state_t ));
+    result.state = action_replay_pool_t_alloc( &state_pool );
     if( NULL == result.state )
     {
         result.status = ENOMEM;
@@ -48,7 +53,7 @@ static action_replay_return_t action_replay_time_converter_t_state_t_delete(
     action_replay_time_converter_t_state_t * const time_converter_state
 )
 {
-    free( time_converter_state );
+    action_replay_pool_t_free( &state_pool, time_converter_state );
     return ( action_replay_return_t ) { 0 };
 }
 
@@ -394,21 +399,17 @@ action_replay_time_converter_t_timespec_func_t_timespec(
         { EINVAL, { 0, 0 } };
     }
 
-    uint64_t value =
-        ACTION_REPLAY_DYNAMIC(
-            action_replay_time_converter_t_state_t *,
-            time_converter_state,
-            self
-        )->nanoseconds;
-    lldiv_t const result = lldiv(
-            value,
-            NANOSECONDS_IN_MICROSECOND
-                * MICROSECONDS_IN_MILLISECOND
-                * MILLISECONDS_IN_SECOND
-        );
-
     return ( action_replay_time_converter_t_timespec_return_t const )
-    { 0, { ( time_t ) result.quot, ( long ) result.rem } };
+    {
+        0,
+        action_replay_nanoseconds_to_timespec(
+            ACTION_REPLAY_DYNAMIC(
+                action_replay_time_converter_t_state_t *,
+                time_converter_state,
+                self
+            )->nanoseconds
+        )
+    };
 }
 #endif /* HAVE_TIME_H */
 
@@ -418,22 +419,28 @@ action_replay_time_converter_t_timeval_func_t_timeval(
     action_replay_time_converter_t const * const self
 )
 {
-    action_replay_time_converter_t_timespec_return_t const result =
-        action_replay_time_converter_t_timespec_func_t_timespec( self );
-    struct timeval t = { 0, 0 };
-
-    if( 0 == result.status )
+    if(
+        ( NULL == self )
+        || ( ! action_replay_is_type(
+            ( void const * const ) self,
+            action_replay_time_converter_t_class()
+    )))
     {
-        t.tv_sec = result.value.tv_sec;
-
-        lldiv_t const division =
-            lldiv( result.value.tv_nsec, NANOSECONDS_IN_MICROSECOND );
-
-        t.tv_usec = ( suseconds_t ) division.quot;
+        return ( action_replay_time_converter_t_timeval_return_t const )
+        { EINVAL, { 0, 0 } };
     }
 
     return ( action_replay_time_converter_t_timeval_return_t const )
-    { result.status, t };
+    {
+        0,
+        action_replay_nanoseconds_to_timeval(
+            ACTION_REPLAY_DYNAMIC(
+                action_replay_time_converter_t_state_t *,
+                time_converter_state,
+                self
+            )->nanoseconds
+        )
+    };
 }
 #endif /* HAVE_SYS_TIME_H */
 
@@ -441,6 +448,12 @@ action_replay_class_t const * action_replay_time_converter_t_class( void )
 {
     static action_replay_class_t_func_t const inheritance[] =
     { action_replay_object_t_class, NULL };
+    static action_replay_reflection_cache_t reflection_cache;
+    static action_replay_class_t_ancestry_t ancestry;
+    /* short-lived, mostly temporaries of conversions */
+    static action_replay_pool_t pool = ACTION_REPLAY_POOL_T_INITIALIZER(
+        sizeof( action_replay_time_converter_t )
+    );
     static action_replay_class_t const result =
     {
         sizeof( action_replay_time_converter_t ),
@@ -448,7 +461,10 @@ action_replay_class_t const * action_replay_time_converter_t_class( void )
         action_replay_time_converter_t_destructor,
         action_replay_time_converter_t_copier,
         action_replay_time_converter_t_reflector,
-        inheritance
+        &reflection_cache,
+        inheritance,
+        &ancestry,
+        &pool
     };
 
     return &result;
@@ -457,7 +473,7 @@ action_replay_class_t const * action_replay_time_converter_t_class( void )
 static action_replay_return_t
 action_replay_time_converter_t_args_t_destructor( void * const state )
 {
-    free( state );
+    action_replay_pool_t_free( &state_pool, state );
     return ( action_replay_return_t const ) { 0 };
 }
 
@@ -466,8 +482,7 @@ action_replay_time_converter_t_args_t_copier( void * const state )
 {
     action_replay_stateful_return_t result;
 
-    result.state =
-        calloc( 1, sizeof( action_replay_time_converter_t_state_t ));
+    result.state = action_replay_pool_t_alloc( &state_pool );
     if( NULL == result.state )
     {
         result.status = ENOMEM;
@@ -505,43 +520,14 @@ action_replay_time_converter_t_args( uint64_t const nanoseconds )
 #if HAVE_TIME_H
 uint64_t
 action_replay_time_converter_t_from_timespec( struct timespec const value )
-{
-    return ( ( uint64_t ) value.tv_sec )
-        * NANOSECONDS_IN_MICROSECOND
-        * MICROSECONDS_IN_MILLISECOND
-        * MILLISECONDS_IN_SECOND
-        + ( ( uint64_t ) value.tv_nsec );
-}
+{ return action_replay_nanoseconds_from_timespec( value ); }
 #endif /* HAVE_TIME_H */
 
 #if HAVE_SYS_TIME_H
 uint64_t
 action_replay_time_converter_t_from_timeval( struct timeval const value )
-{
-    return ( ( uint64_t ) value.tv_sec )
-        * NANOSECONDS_IN_MICROSECOND
-        * MICROSECONDS_IN_MILLISECOND
-        * MILLISECONDS_IN_SECOND
-        + ( ( uint64_t ) value.tv_usec )
-        * NANOSECONDS_IN_MICROSECOND;
-}
+{ return action_replay_nanoseconds_from_timeval( value ); }
 #endif /* HAVE_SYS_TIME_H */
 
 uint64_t action_replay_time_converter_t_now( void )
-{
-#if HAVE_TIME_H && HAVE_CLOCK_GETTIME
-    struct timespec result;
-
-    if( 0 == clock_gettime( CLOCK_REALTIME, &result ))
-    { return action_replay_time_converter_t_from_timespec( result ); }
-#endif /* HAVE_TIME_H && HAVE_CLOCK_GETTIME */
-#if HAVE_SYS_TIME_H && HAVE_GETTIMEOFDAY
-    struct timeval fallback;
-
-    if( 0 == gettimeofday( &fallback, NULL ))
-    { return action_replay_time_converter_t_from_timeval( fallback ); }
-#endif /* HAVE_SYS_TIME_H && HAVE_GETTIMEOFDAY */
-
-    return 0;
-}
-
+{ return action_replay_nanoseconds_now(); }
@@ -0,0 +1,202 @@
+#include "action_replay/error.h"
+#include "action_replay/stddef.h"
+#include "action_replay/stdint.h"
+#include "action_replay/uinput.h"
+#include <errno.h>
+#include <linux/input.h>
+#include <string.h>
+
+#if HAVE_LINUX_UINPUT_H
+# include <fcntl.h>
+# include <linux/uinput.h>
+# include <sys/ioctl.h>
+# include <unistd.h>
+#endif /* HAVE_LINUX_UINPUT_H */
+
+#define BITS_IN_BYTE 8
+
+/*
+ * event types a device can be given, with how many codes each has;
+ * EV_SYN is always there, EV_REP would make kernel add repeats of its own
+ * on top of recorded ones and EV_FF ones are written to devices, not read
+ */
+static struct {
+    uint16_t type;
+    uint16_t codes;
+} const kinds[] =
+{
+    { EV_KEY, KEY_CNT },
+    { EV_REL, REL_CNT },
+    { EV_ABS, ABS_CNT },
+    { EV_MSC, MSC_CNT },
+    { EV_SW, SW_CNT },
+    { EV_LED, LED_CNT },
+    { EV_SND, SND_CNT }
+};
+
+#define KINDS_COUNT ( sizeof( kinds ) / sizeof( kinds[ 0 ] ))
+
+static inline bool action_replay_uinput_has_code(
+    action_replay_uinput_capabilities_t const * const capabilities,
+    uint16_t const type,
+    uint16_t const code
+)
+{
+    return 0 != (
+        capabilities->codes[ type ][ code / BITS_IN_BYTE ]
+        & ( 1U << ( code % BITS_IN_BYTE ))
+    );
+}
+
+/* codes of types outside kinds are out of range, 0 */
+static inline uint16_t action_replay_uinput_codes( uint16_t const type )
+{
+    for( size_t i = 0; i < KINDS_COUNT; ++i )
+    { if( type == kinds[ i ].type ) { return kinds[ i ].codes; } }
+
+    return 0;
+}
+
+void action_replay_uinput_capabilities_init(
+    action_replay_uinput_capabilities_t * const capabilities
+)
+{ memset( capabilities, 0, sizeof( *capabilities )); }
+
+void action_replay_uinput_capabilities_add(
+    action_replay_uinput_capabilities_t * const capabilities,
+    uint16_t const type,
+    uint16_t const code,
+    int32_t const value
+)
+{
+    if( EV_SYN == type ) { return; }
+    if( action_replay_uinput_codes( type ) <= code )
+    {
+        ++( capabilities->ignored );
+        return;
+    }
+    if( EV_ABS == type )
+    {
+        if( ! action_replay_uinput_has_code( capabilities, type, code ))
+        {
+            capabilities->abs_min[ code ] = value;
+            capabilities->abs_max[ code ] = value;
+        }
+        else if( capabilities->abs_min[ code ] > value )
+        { capabilities->abs_min[ code ] = value; }
+        else if( capabilities->abs_max[ code ] < value )
+        { capabilities->abs_max[ code ] = value; }
+    }
+    capabilities->types[ type ] = true;
+    capabilities->codes[ type ][ code / BITS_IN_BYTE ] |=
+        ( uint8_t ) ( 1U << ( code % BITS_IN_BYTE ));
+}
+
+#if HAVE_LINUX_UINPUT_H
+
+static unsigned long int action_replay_uinput_request( uint16_t const type )
+{
+    switch( type )
+    {
+        case EV_KEY: return UI_SET_KEYBIT;
+        case EV_REL: return UI_SET_RELBIT;
+        case EV_ABS: return UI_SET_ABSBIT;
+        case EV_MSC: return UI_SET_MSCBIT;
+        case EV_SW: return UI_SET_SWBIT;
+        case EV_LED: return UI_SET_LEDBIT;
+        default: return UI_SET_SNDBIT;
+    }
+}
+
+static action_replay_error_t action_replay_uinput_set_bits(
+    int const fd,
+    action_replay_uinput_capabilities_t const * const capabilities
+)
+{
+    for( size_t i = 0; i < KINDS_COUNT; ++i )
+    {
+        uint16_t const type = kinds[ i ].type;
+
+        if( ! capabilities->types[ type ] ) { continue; }
+        if( -1 == ioctl( fd, UI_SET_EVBIT, ( int ) type )) { return errno; }
+        for( uint16_t code = 0; code < kinds[ i ].codes; ++code )
+        {
+            if(
+                action_replay_uinput_has_code( capabilities, type, code )
+                && ( -1 == ioctl(
+                    fd,
+                    action_replay_uinput_request( type ),
+                    ( int ) code
+                ))
+            ) { return errno; }
+        }
+    }
+
+    return 0;
+}
+
+action_replay_uinput_return_t action_replay_uinput_create(
+    char const * const restrict name,
+    action_replay_uinput_capabilities_t const * const restrict capabilities
+)
+{
+    action_replay_uinput_return_t result = { 0, -1 };
+
+    result.fd = open( "/dev/uinput", O_WRONLY );
+    if(( -1 == result.fd ) && ( ENOENT == errno ))
+    { result.fd = open( "/dev/input/uinput", O_WRONLY ); }
+    if( -1 == result.fd )
+    {
+        result.status = errno;
+        return result;
+    }
+    result.status = action_replay_uinput_set_bits( result.fd, capabilities );
+    if( 0 != result.status ) { goto handle_error; }
+
+    /* legacy setup, which every uinput version understands */
+    struct uinput_user_dev device;
+
+    memset( &device, 0, sizeof( device ));
+    strncpy( device.name, name, UINPUT_MAX_NAME_SIZE - 1 );
+    device.id.bustype = BUS_VIRTUAL;
+    for( uint16_t code = 0; code < ABS_CNT; ++code )
+    {
+        device.absmin[ code ] = capabilities->abs_min[ code ];
+        device.absmax[ code ] = capabilities->abs_max[ code ];
+    }
+    if(
+        ( ssize_t ) sizeof( device )
+        != write( result.fd, &device, sizeof( device ))
+    )
+    {
+        result.status = errno;
+        goto handle_error;
+    }
+    if( -1 == ioctl( result.fd, UI_DEV_CREATE ))
+    {
+        result.status = errno;
+        goto handle_error;
+    }
+
+    return result;
+
+handle_error:
+    close( result.fd );
+    result.fd = -1;
+    return result;
+}
+
+#else /* ! HAVE_LINUX_UINPUT_H */
+
+action_replay_uinput_return_t action_replay_uinput_create(
+    char const * const restrict name,
+    action_replay_uinput_capabilities_t const * const restrict capabilities
+)
+{
+    ( void ) name;
+    ( void ) capabilities;
+
+    return ( action_replay_uinput_return_t const ) { ENOSYS, -1 };
+}
+
+#endif /* HAVE_LINUX_UINPUT_H */
@@ -0,0 +1,446 @@
+#define _DEFAULT_SOURCE /* syscall */
+
+#include "action_replay/error.h"
+#include "action_replay/return.h"
+#include "action_replay/stddef.h"
+#include "action_replay/stdint.h"
+#include "action_replay/uring.h"
+#include <errno.h>
+
+#if HAVE_LINUX_IO_URING_H && HAVE_SYS_SYSCALL_H
+
+# include <linux/io_uring.h>
+# include <opa_primitives.h>
+# include <string.h>
+# include <sys/mman.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+
+# define NANOSECONDS_IN_MILLISECOND 1000000
+# define MILLISECONDS_IN_SECOND 1000
+
+/* kernel's ring indices are plain 32-bit counters, laid out as OPA_int_t */
+static inline unsigned int
+action_replay_uring_t_load_acquire( unsigned int * const index )
+{ return ( unsigned int ) OPA_load_acquire_int(( OPA_int_t * ) index ); }
+
+static inline void action_replay_uring_t_store_release(
+    unsigned int * const index,
+    unsigned int const value
+)
+{ OPA_store_release_int(( OPA_int_t * ) index, ( int ) value ); }
+
+static inline void * action_replay_uring_t_offset(
+    void * const ring,
+    unsigned int const offset
+)
+{ return ( char * ) ring + offset; }
+
+static inline void * action_replay_uring_t_map(
+    int const fd,
+    size_t const size,
+    off_t const offset
+)
+{
+    return mmap(
+        NULL,
+        size,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED,
+        fd,
+        offset
+    );
+}
+
+action_replay_return_t action_replay_uring_t_init(
+    action_replay_uring_t * const uring,
+    unsigned int const entries
+)
+{
+    action_replay_return_t result = { 0 };
+    struct io_uring_params params;
+
+    memset( &params, 0, sizeof( params ));
+    uring->fd = ( int ) syscall( __NR_io_uring_setup, entries, &params );
+    if( -1 == uring->fd )
+    {
+        result.status = errno;
+        return result;
+    }
+    /* writes at current file position came with 5.6 kernels */
+    if( 0 == ( params.features & IORING_FEAT_RW_CUR_POS ))
+    {
+        result.status = ENOTSUP;
+        goto handle_features_error;
+    }
+    uring->sq_ring_size =
+        params.sq_off.array + params.sq_entries * sizeof( unsigned int );
+    uring->cq_ring_size =
+        params.cq_off.cqes + params.cq_entries * sizeof( struct io_uring_cqe );
+    if( 0 != ( params.features & IORING_FEAT_SINGLE_MMAP ))
+    {
+        if( uring->cq_ring_size > uring->sq_ring_size )
+        { uring->sq_ring_size = uring->cq_ring_size; }
+        uring->cq_ring_size = uring->sq_ring_size;
+    }
+    uring->sq_ring = action_replay_uring_t_map(
+        uring->fd,
+        uring->sq_ring_size,
+        IORING_OFF_SQ_RING
+    );
+    if( MAP_FAILED == uring->sq_ring )
+    {
+        result.status = errno;
+        goto handle_sq_ring_map_error;
+    }
+    uring->cq_ring = ( 0 != ( params.features & IORING_FEAT_SINGLE_MMAP ))
+        ? uring->sq_ring
+        : action_replay_uring_t_map(
+            uring->fd,
+            uring->cq_ring_size,
+            IORING_OFF_CQ_RING
+        );
+    if( MAP_FAILED == uring->cq_ring )
+    {
+        result.status = errno;
+        goto handle_cq_ring_map_error;
+    }
+    uring->sqes_size = params.sq_entries * sizeof( struct io_uring_sqe );
+    uring->sqes = action_replay_uring_t_map(
+        uring->fd,
+        uring->sqes_size,
+        IORING_OFF_SQES
+    );
+    if( MAP_FAILED == ( void * ) uring->sqes )
+    {
+        result.status = errno;
+        goto handle_sqes_map_error;
+    }
+
+    uring->sq_head =
+        action_replay_uring_t_offset( uring->sq_ring, params.sq_off.head );
+    uring->sq_tail =
+        action_replay_uring_t_offset( uring->sq_ring, params.sq_off.tail );
+    uring->sq_array =
+        action_replay_uring_t_offset( uring->sq_ring, params.sq_off.array );
+    uring->sq_mask = *( unsigned int * ) action_replay_uring_t_offset(
+        uring->sq_ring,
+        params.sq_off.ring_mask
+    );
+    uring->sq_entries = params.sq_entries;
+    uring->cq_head =
+        action_replay_uring_t_offset( uring->cq_ring, params.cq_off.head );
+    uring->cq_tail =
+        action_replay_uring_t_offset( uring->cq_ring, params.cq_off.tail );
+    uring->cq_mask = *( unsigned int * ) action_replay_uring_t_offset(
+        uring->cq_ring,
+        params.cq_off.ring_mask
+    );
+    uring->cqes =
+        action_replay_uring_t_offset( uring->cq_ring, params.cq_off.cqes );
+    /* entries are always used in order, so the indirection is identity */
+    for( unsigned int i = 0; i < uring->sq_entries; ++i )
+    { uring->sq_array[ i ] = i; }
+    uring->queued = 0;
+    uring->enters = 0;
+
+    return result;
+
+handle_sqes_map_error:
+    if( uring->cq_ring != uring->sq_ring )
+    { munmap( uring->cq_ring, uring->cq_ring_size ); }
+handle_cq_ring_map_error:
+    munmap( uring->sq_ring, uring->sq_ring_size );
+handle_sq_ring_map_error:
+handle_features_error:
+    close( uring->fd );
+    uring->fd = -1;
+    return result;
+}
+
+action_replay_return_t
+action_replay_uring_t_destroy( action_replay_uring_t * const uring )
+{
+    action_replay_return_t result = { 0 };
+
+    munmap( uring->sqes, uring->sqes_size );
+    if( uring->cq_ring != uring->sq_ring )
+    { munmap( uring->cq_ring, uring->cq_ring_size ); }
+    munmap( uring->sq_ring, uring->sq_ring_size );
+    /* kernel cancels whatever is still in flight */
+    if( -1 == close( uring->fd )) { result.status = errno; }
+    uring->fd = -1;
+
+    return result;
+}
+
+static struct io_uring_sqe *
+action_replay_uring_t_get_sqe( action_replay_uring_t * const uring )
+{
+    /* only this thread moves the tail */
+    unsigned int const tail = *( uring->sq_tail ) + uring->queued;
+
+    if(
+        uring->sq_entries
+        <= tail - action_replay_uring_t_load_acquire( uring->sq_head )
+    ) { return NULL; }
+
+    struct io_uring_sqe * const sqe =
+        &( uring->sqes[ tail & uring->sq_mask ] );
+
+    memset( sqe, 0, sizeof( struct io_uring_sqe ));
+    ++( uring->queued );
+
+    return sqe;
+}
+
+static action_replay_error_t action_replay_uring_t_queue(
+    action_replay_uring_t * const uring,
+    uint8_t const opcode,
+    int const fd,
+    uint64_t const address,
+    uint32_t const length,
+    uint64_t const offset,
+    uint64_t const user_data
+)
+{
+    struct io_uring_sqe * const sqe = action_replay_uring_t_get_sqe( uring );
+
+    if( NULL == sqe ) { return EBUSY; }
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = address;
+    sqe->len = length;
+    sqe->off = offset;
+    sqe->user_data = user_data;
+
+    return 0;
+}
+
+action_replay_error_t action_replay_uring_t_read(
+    action_replay_uring_t * const restrict uring,
+    int const fd,
+    void * const restrict buffer,
+    size_t const length,
+    uint64_t const user_data
+)
+{
+    if( UINT32_MAX < length ) { return EINVAL; }
+
+    return action_replay_uring_t_queue(
+        uring,
+        IORING_OP_READ,
+        fd,
+        ( uint64_t ) ( uintptr_t ) buffer,
+        ( uint32_t ) length,
+        ( uint64_t ) -1, /* current position */
+        user_data
+    );
+}
+
+action_replay_error_t action_replay_uring_t_write(
+    action_replay_uring_t * const restrict uring,
+    int const fd,
+    void const * const restrict buffer,
+    size_t const length,
+    uint64_t const user_data
+)
+{
+    if( UINT32_MAX < length ) { return EINVAL; }
+
+    return action_replay_uring_t_queue(
+        uring,
+        IORING_OP_WRITE,
+        fd,
+        ( uint64_t ) ( uintptr_t ) buffer,
+        ( uint32_t ) length,
+        ( uint64_t ) -1, /* current position */
+        user_data
+    );
+}
+
+action_replay_error_t action_replay_uring_t_timeout(
+    action_replay_uring_t * const uring,
+    int const timeout_milliseconds,
+    uint64_t const user_data
+)
+{
+    if( 0 > timeout_milliseconds ) { return EINVAL; }
+    uring->timeout.tv_sec = timeout_milliseconds / MILLISECONDS_IN_SECOND;
+    uring->timeout.tv_nsec =
+        ( long long int ) ( timeout_milliseconds % MILLISECONDS_IN_SECOND )
+        * NANOSECONDS_IN_MILLISECOND;
+
+    /* no completion count, only time ends it */
+    return action_replay_uring_t_queue(
+        uring,
+        IORING_OP_TIMEOUT,
+        -1,
+        ( uint64_t ) ( uintptr_t ) &( uring->timeout ),
+        1,
+        0,
+        user_data
+    );
+}
+
+action_replay_error_t action_replay_uring_t_cancel(
+    action_replay_uring_t * const uring,
+    uint64_t const target_user_data,
+    uint64_t const user_data
+)
+{
+    return action_replay_uring_t_queue(
+        uring,
+        IORING_OP_ASYNC_CANCEL,
+        -1,
+        target_user_data,
+        0,
+        0,
+        user_data
+    );
+}
+
+action_replay_error_t
+action_replay_uring_t_submit_and_wait( action_replay_uring_t * const uring )
+{
+    /* entries are filled in before kernel can see them */
+    action_replay_uring_t_store_release(
+        uring->sq_tail,
+        *( uring->sq_tail ) + uring->queued
+    );
+    uring->queued = 0;
+
+    /* includes entries an interrupted enter left behind */
+    unsigned int const to_submit = *( uring->sq_tail )
+        - action_replay_uring_t_load_acquire( uring->sq_head );
+    unsigned int const ready =
+        action_replay_uring_t_load_acquire( uring->cq_tail )
+        - *( uring->cq_head );
+
+    if(( 0 == to_submit ) && ( 0 < ready )) { return 0; }
+    ++( uring->enters );
+    if( -1 == syscall(
+        __NR_io_uring_enter,
+        uring->fd,
+        to_submit,
+        ( 0 < ready ) ? 0 : 1,
+        IORING_ENTER_GETEVENTS,
+        NULL,
+        0
+    )) { return errno; }
+
+    return 0;
+}
+
+action_replay_uring_t_completion_return_t
+action_replay_uring_t_pop( action_replay_uring_t * const uring )
+{
+    action_replay_uring_t_completion_return_t result = { EAGAIN, 0, 0 };
+    unsigned int const head = *( uring->cq_head );
+
+    if( head == action_replay_uring_t_load_acquire( uring->cq_tail ))
+    { return result; }
+
+    struct io_uring_cqe const * const cqe =
+        &( uring->cqes[ head & uring->cq_mask ] );
+
+    result.status = 0;
+    result.user_data = cqe->user_data;
+    result.result = cqe->res;
+    /* slot can be reused by kernel once head moves */
+    action_replay_uring_t_store_release( uring->cq_head, head + 1 );
+
+    return result;
+}
+
+#else /* no io_uring headers */
+
+action_replay_return_t action_replay_uring_t_init(
+    action_replay_uring_t * const uring,
+    unsigned int const entries
+)
+{
+    ( void ) entries;
+    uring->fd = -1;
+    return ( action_replay_return_t const ) { ENOSYS };
+}
+
+action_replay_return_t
+action_replay_uring_t_destroy( action_replay_uring_t * const uring )
+{
+    ( void ) uring;
+    return ( action_replay_return_t const ) { ENOSYS };
+}
+
+action_replay_error_t action_replay_uring_t_read(
+    action_replay_uring_t * const restrict uring,
+    int const fd,
+    void * const restrict buffer,
+    size_t const length,
+    uint64_t const user_data
+)
+{
+    ( void ) uring;
+    ( void ) fd;
+    ( void ) buffer;
+    ( void ) length;
+    ( void ) user_data;
+    return ENOSYS;
+}
+
+action_replay_error_t action_replay_uring_t_write(
+    action_replay_uring_t * const restrict uring,
+    int const fd,
+    void const * const restrict buffer,
+    size_t const length,
+    uint64_t const user_data
+)
+{
+    ( void ) uring;
+    ( void ) fd;
+    ( void ) buffer;
+    ( void ) length;
+    ( void ) user_data;
+    return ENOSYS;
+}
+
+action_replay_error_t action_replay_uring_t_timeout(
+    action_replay_uring_t * const uring,
+    int const timeout_milliseconds,
+    uint64_t const user_data
+)
+{
+    ( void ) uring;
+    ( void ) timeout_milliseconds;
+    ( void ) user_data;
+    return ENOSYS;
+}
+
+action_replay_error_t action_replay_uring_t_cancel(
+    action_replay_uring_t * const uring,
+    uint64_t const target_user_data,
+    uint64_t const user_data
+)
+{
+    ( void ) uring;
+    ( void ) target_user_data;
+    ( void ) user_data;
+    return ENOSYS;
+}
+
+action_replay_error_t
+action_replay_uring_t_submit_and_wait( action_replay_uring_t * const uring )
+{
+    ( void ) uring;
+    return ENOSYS;
+}
+
+action_replay_uring_t_completion_return_t
+action_replay_uring_t_pop( action_replay_uring_t * const uring )
+{
+    ( void ) uring;
+    return ( action_replay_uring_t_completion_return_t const )
+    { ENOSYS, 0, 0 };
+}
+
+#endif /* HAVE_LINUX_IO_URING_H && HAVE_SYS_SYSCALL_H */
@@ -522,6 +522,8 @@ action_replay_class_t const * action_replay_worker_t_class( void )
         action_replay_stateful_object_t_class,
         NULL
     };
+    static action_replay_reflection_cache_t reflection_cache;
+    static action_replay_class_t_ancestry_t ancestry;
     static action_replay_class_t const result =
     {
         sizeof( action_replay_worker_t ),
@@ -529,7 +531,10 @@ action_replay_class_t const * action_replay_worker_t_class( void )
         action_replay_worker_t_destructor,
         action_replay_worker_t_copier,
         action_replay_worker_t_reflector,
-        inheritance
+        &reflection_cache,
+        inheritance,
+        &ancestry,
+        NULL
     };
 
     return &result;
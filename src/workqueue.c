@@ -1,12 +1,17 @@
+#define _DEFAULT_SOURCE /* syscall */
+
 #include "action_replay/args.h"
 #include "action_replay/class.h"
 #include "action_replay/error.h"
+#include "action_replay/limits.h"
 #include "action_replay/log.h"
 #include "action_replay/object.h"
 #include "action_replay/object_oriented_programming.h"
 #include "action_replay/object_oriented_programming_super.h"
 #include "action_replay/return.h"
 #include "action_replay/stateful_return.h"
+#include "action_replay/stdbool.h"
+#include "action_replay/stddef.h"
 #include "action_replay/worker.h"
 #include "action_replay/workqueue.h"
 #include <errno.h>
@@ -14,18 +19,92 @@
 #include <opa_queue.h>
 #include <pthread.h>
 #include <stdlib.h>
+#include <unistd.h>
+
+#if HAVE_LINUX_FUTEX_H && HAVE_SYS_SYSCALL_H
+# define WORKQUEUE_FUTEX 1
+# include <linux/futex.h>
+# include <sys/syscall.h>
+#else /* no futex, parking falls back to condition */
+# define WORKQUEUE_FUTEX 0
+#endif /* HAVE_LINUX_FUTEX_H && HAVE_SYS_SYSCALL_H */
+
+/* busy waits of a ring's side before it parks, if there's another CPU */
+#define RING_SPINS 256
+
+/* a pool thread's deque starts with that many slots, doubles when full */
+#define DEQUE_CAPACITY 64
+
+typedef struct {
+    action_replay_workqueue_t_backend_t backend;
+    size_t ring_capacity;
+    unsigned int threads;
+} action_replay_workqueue_t_args_t;
 
 typedef struct {
-    OPA_Queue_element_hdr_t header;
     action_replay_workqueue_t_work_func_t payload;
     void * state;
-} action_replay_workqueue_t_item_t;
+} action_replay_workqueue_t_slot_t;
+
+/*
+ * single producer, single consumer; a side which ran out of spins
+ * sets its parked word and sleeps on it, the other side wakes it
+ * only if it finds the word set
+ */
+typedef struct {
+    action_replay_workqueue_t_slot_t * slots;
+    int size; /* capacity + 1, one slot is always left empty */
+    /* no point with one CPU, other side can't run while we spin */
+    unsigned int spins;
+    OPA_int_t head; /* next to run, moved by processing thread */
+    OPA_int_t tail; /* next to put, moved by producer */
+    OPA_int_t consumer_parked;
+    OPA_int_t producer_parked;
+    OPA_int_t running; /* from start() until processing thread flushed */
+} action_replay_workqueue_t_ring_t;
+
+typedef struct {
+    action_replay_workqueue_t_slot_t * slots;
+    size_t capacity; /* power of two */
+    size_t head; /* oldest */
+    size_t count;
+} action_replay_workqueue_t_deque_t;
+
+/* pool thread's; deques and their counts are guarded by its mutex */
+typedef struct {
+    action_replay_workqueue_t_state_t * workqueue_state;
+    unsigned int index;
+    pthread_mutex_t mutex;
+    /* owner runs newest first, others steal oldest first */
+    action_replay_workqueue_t_deque_t stealable;
+    /* put_ordered() items of keys mapped to this thread, only it runs them */
+    action_replay_workqueue_t_deque_t ordered;
+    OPA_int_t stealable_count;
+    OPA_int_t ordered_count;
+    /* waited on with workqueue's mutex, which guards sleeping */
+    pthread_cond_t condition;
+    OPA_int_t sleeping;
+} action_replay_workqueue_t_thread_t;
+
+typedef struct {
+    action_replay_workqueue_t_thread_t * threads;
+    unsigned int threads_count; /* initialized */
+    OPA_int_t stealable; /* items in all stealable deques */
+    OPA_int_t outstanding; /* put and not yet run to the end */
+    OPA_int_t sleepers; /* changed under workqueue's mutex */
+    OPA_int_t next; /* thread which gets next put from outside of pool */
+} action_replay_workqueue_t_pool_t;
 
 struct action_replay_workqueue_t_state_t
 {
-    action_replay_worker_t * worker;
+    /* one per thread, only a pool has more than one */
+    action_replay_worker_t * * workers;
+    unsigned int workers_count;
     OPA_ptr_t run_flag;
+    action_replay_workqueue_t_backend_t backend;
     OPA_Queue_info_t queue;
+    action_replay_workqueue_t_ring_t ring;
+    action_replay_workqueue_t_pool_t pool;
     pthread_cond_t condition;
     pthread_mutex_t mutex;
 };
@@ -41,10 +120,179 @@ static action_replay_workqueue_t_run_flag_t workqueue_continue =
 static action_replay_workqueue_t_run_flag_t workqueue_join = WORKQUEUE_JOIN;
 static action_replay_workqueue_t_run_flag_t workqueue_stop = WORKQUEUE_STOP;
 
+/* pool thread running on the calling thread, if any */
+static pthread_once_t thread_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t thread_key;
+static bool thread_key_ready;
+
 static void * action_replay_workqueue_t_process_queue( void * state );
+static void * action_replay_workqueue_t_process_ring( void * state );
+static void * action_replay_workqueue_t_process_pool( void * state );
+
+static unsigned int action_replay_workqueue_t_online_cpus( void )
+{
+    long const online = sysconf( _SC_NPROCESSORS_ONLN );
+
+    return ( 1 < online ) ? ( unsigned int ) online : 1;
+}
+
+static void action_replay_workqueue_t_thread_key_init( void )
+{ thread_key_ready = ( 0 == pthread_key_create( &thread_key, NULL )); }
+
+static action_replay_error_t action_replay_workqueue_t_deque_init(
+    action_replay_workqueue_t_deque_t * const deque
+)
+{
+    deque->slots =
+        calloc( DEQUE_CAPACITY, sizeof( action_replay_workqueue_t_slot_t ));
+    if( NULL == deque->slots ) { return ENOMEM; }
+    deque->capacity = DEQUE_CAPACITY;
+    deque->head = 0;
+    deque->count = 0;
+
+    return 0;
+}
+
+static action_replay_error_t action_replay_workqueue_t_deque_push(
+    action_replay_workqueue_t_deque_t * const restrict deque,
+    action_replay_workqueue_t_work_func_t const payload,
+    void * const state
+)
+{
+    if( deque->capacity == deque->count )
+    {
+        action_replay_workqueue_t_slot_t * const slots = malloc(
+            2 * deque->capacity * sizeof( action_replay_workqueue_t_slot_t )
+        );
+
+        if( NULL == slots ) { return ENOMEM; }
+        for( size_t i = 0; i < deque->count; ++i )
+        {
+            slots[ i ] =
+                deque->slots[ ( deque->head + i ) & ( deque->capacity - 1 ) ];
+        }
+        free( deque->slots );
+        deque->slots = slots;
+        deque->capacity *= 2;
+        deque->head = 0;
+    }
+
+    action_replay_workqueue_t_slot_t * const slot = deque->slots
+        + (( deque->head + deque->count ) & ( deque->capacity - 1 ));
+
+    slot->payload = payload;
+    slot->state = state;
+    ++( deque->count );
+
+    return 0;
+}
+
+static bool action_replay_workqueue_t_deque_pop_oldest(
+    action_replay_workqueue_t_deque_t * const restrict deque,
+    action_replay_workqueue_t_slot_t * const restrict slot
+)
+{
+    if( 0 == deque->count ) { return false; }
+    * slot = deque->slots[ deque->head ];
+    deque->head = ( deque->head + 1 ) & ( deque->capacity - 1 );
+    --( deque->count );
+
+    return true;
+}
+
+static bool action_replay_workqueue_t_deque_pop_newest(
+    action_replay_workqueue_t_deque_t * const restrict deque,
+    action_replay_workqueue_t_slot_t * const restrict slot
+)
+{
+    if( 0 == deque->count ) { return false; }
+    --( deque->count );
+    * slot = deque->slots[
+        ( deque->head + deque->count ) & ( deque->capacity - 1 )
+    ];
+
+    return true;
+}
+
+static void action_replay_workqueue_t_pool_destroy(
+    action_replay_workqueue_t_pool_t * const pool
+)
+{
+    while( 0 < pool->threads_count )
+    {
+        action_replay_workqueue_t_thread_t * const thread =
+            pool->threads + --( pool->threads_count );
+
+        pthread_cond_destroy( &( thread->condition ));
+        pthread_mutex_destroy( &( thread->mutex ));
+        free( thread->ordered.slots );
+        free( thread->stealable.slots );
+    }
+    free( pool->threads );
+    pool->threads = NULL;
+}
+
+static action_replay_error_t action_replay_workqueue_t_pool_init(
+    action_replay_workqueue_t_pool_t * const pool,
+    action_replay_workqueue_t_state_t * const workqueue_state,
+    unsigned int const threads_count
+)
+{
+    action_replay_error_t result;
+
+    if( 0 != pthread_once(
+        &thread_key_once,
+        action_replay_workqueue_t_thread_key_init
+    )) { LOG( "failure initializing pool thread key" ); }
+    pool->threads =
+        calloc( threads_count, sizeof( action_replay_workqueue_t_thread_t ));
+    if( NULL == pool->threads ) { return ENOMEM; }
+    for( pool->threads_count = 0; threads_count > pool->threads_count; )
+    {
+        action_replay_workqueue_t_thread_t * const thread =
+            pool->threads + pool->threads_count;
+
+        thread->workqueue_state = workqueue_state;
+        thread->index = pool->threads_count;
+        if( 0 != ( result = action_replay_workqueue_t_deque_init(
+            &( thread->stealable )
+        ))) { goto handle_stealable_error; }
+        if( 0 != ( result = action_replay_workqueue_t_deque_init(
+            &( thread->ordered )
+        ))) { goto handle_ordered_error; }
+        result = pthread_mutex_init( &( thread->mutex ), NULL );
+        if( 0 != result ) { goto handle_mutex_error; }
+        result = pthread_cond_init( &( thread->condition ), NULL );
+        if( 0 != result ) { goto handle_cond_error; }
+        ++( pool->threads_count );
+    }
+
+    return 0;
+
+handle_cond_error:
+    pthread_mutex_destroy( &( pool->threads[ pool->threads_count ].mutex ));
+handle_mutex_error:
+    free( pool->threads[ pool->threads_count ].ordered.slots );
+handle_ordered_error:
+    free( pool->threads[ pool->threads_count ].stealable.slots );
+handle_stealable_error:
+    action_replay_workqueue_t_pool_destroy( pool );
+    return result;
+}
+
+/* what each backend's processing thread is started with */
+static void * action_replay_workqueue_t_thread_state(
+    action_replay_workqueue_t_state_t * const workqueue_state,
+    unsigned int const index
+)
+{
+    return ( ACTION_REPLAY_WORKQUEUE_T_POOL == workqueue_state->backend )
+        ? ( void * ) ( workqueue_state->pool.threads + index )
+        : ( void * ) workqueue_state;
+}
 
 static action_replay_stateful_return_t
-action_replay_workqueue_t_state_t_new( void )
+action_replay_workqueue_t_state_t_new( action_replay_args_t const args )
 {
     action_replay_stateful_return_t result;
 
@@ -56,17 +304,71 @@ action_replay_workqueue_t_state_t_new( void )
     }
     result.status = 0;
 
+    action_replay_workqueue_t_args_t * const workqueue_args = args.state;
     action_replay_workqueue_t_state_t * const workqueue_state = result.state;
+    action_replay_worker_t_thread_func_t thread_function =
+        action_replay_workqueue_t_process_queue;
+    unsigned int workers_count = 1;
 
-    /*  we control creation, no reflection necessary */
-    workqueue_state->worker = action_replay_new(
-        action_replay_worker_t_class(),
-        action_replay_worker_t_args( action_replay_workqueue_t_process_queue )
-    );
-    if( NULL == workqueue_state->worker )
+    workqueue_state->backend = workqueue_args->backend;
+    if( ACTION_REPLAY_WORKQUEUE_T_SPSC == workqueue_state->backend )
+    {
+        if(
+            ( 0 == workqueue_args->ring_capacity )
+            || ( INT_MAX - 1 < workqueue_args->ring_capacity )
+        )
+        {
+            result.status = EINVAL;
+            goto handle_ring_error;
+        }
+        workqueue_state->ring.size =
+            ( int ) workqueue_args->ring_capacity + 1;
+        workqueue_state->ring.slots = calloc(
+            ( size_t ) workqueue_state->ring.size,
+            sizeof( action_replay_workqueue_t_slot_t )
+        );
+        if( NULL == workqueue_state->ring.slots )
+        {
+            result.status = ENOMEM;
+            goto handle_ring_error;
+        }
+        workqueue_state->ring.spins =
+            ( 1 < action_replay_workqueue_t_online_cpus() ) ? RING_SPINS : 0;
+        thread_function = action_replay_workqueue_t_process_ring;
+    }
+    if( ACTION_REPLAY_WORKQUEUE_T_POOL == workqueue_state->backend )
+    {
+        workers_count = ( 0 == workqueue_args->threads )
+            ? action_replay_workqueue_t_online_cpus()
+            : workqueue_args->threads;
+        if( 0 != ( result.status = action_replay_workqueue_t_pool_init(
+            &( workqueue_state->pool ),
+            workqueue_state,
+            workers_count
+        ))) { goto handle_pool_error; }
+        thread_function = action_replay_workqueue_t_process_pool;
+    }
+    workqueue_state->workers =
+        calloc( workers_count, sizeof( action_replay_worker_t * ));
+    if( NULL == workqueue_state->workers )
+    {
+        result.status = ENOMEM;
+        goto handle_workers_error;
+    }
+    for( ; workers_count > workqueue_state->workers_count; )
     {
-        result.status = errno;
-        goto handle_worker_new_error;
+        /*  we control creation, no reflection necessary */
+        action_replay_worker_t * const worker = action_replay_new(
+            action_replay_worker_t_class(),
+            action_replay_worker_t_args( thread_function )
+        );
+
+        if( NULL == worker )
+        {
+            result.status = errno;
+            goto handle_worker_new_error;
+        }
+        workqueue_state->workers[ workqueue_state->workers_count++ ] = worker;
     }
     result.status = pthread_cond_init( &( workqueue_state->condition ), NULL );
     if( 0 != result.status ) { goto handle_pthread_cond_error; }
@@ -80,8 +382,19 @@ action_replay_workqueue_t_state_t_new( void )
 handle_pthread_mutex_error:
     pthread_cond_destroy( &( workqueue_state->condition ));
 handle_pthread_cond_error:
-    action_replay_delete( ( void * ) workqueue_state->worker );
 handle_worker_new_error:
+    while( 0 < workqueue_state->workers_count )
+    {
+        action_replay_delete( ( void * ) workqueue_state->workers[
+            --( workqueue_state->workers_count )
+        ]);
+    }
+    free( workqueue_state->workers );
+handle_workers_error:
+    action_replay_workqueue_t_pool_destroy( &( workqueue_state->pool ));
+handle_pool_error:
+    free( workqueue_state->ring.slots );
+handle_ring_error:
     free( result.state );
     result.state = NULL;
     return result;
@@ -93,9 +406,14 @@ static action_replay_return_t action_replay_workqueue_t_state_t_delete(
 {
     action_replay_return_t result;
 
-    result.status = action_replay_delete( ( void * ) workqueue_state->worker );
-    if( 0 != result.status ) { return result; }
-    workqueue_state->worker = NULL;
+    while( 0 < workqueue_state->workers_count )
+    {
+        result.status = action_replay_delete( ( void * )
+            workqueue_state->workers[ workqueue_state->workers_count - 1 ]
+        );
+        if( 0 != result.status ) { return result; }
+        --( workqueue_state->workers_count );
+    }
     /* stop() called by destructor, no thread is waiting */
     result.status = pthread_cond_destroy( &( workqueue_state->condition ));
     if( 0 != result.status ) { return result; }
@@ -103,6 +421,9 @@ static action_replay_return_t action_replay_workqueue_t_state_t_delete(
     result.status = pthread_mutex_destroy( &( workqueue_state->mutex ));
     if( 0 != result.status ) { return result; }
 
+    free( workqueue_state->workers );
+    action_replay_workqueue_t_pool_destroy( &( workqueue_state->pool ));
+    free( workqueue_state->ring.slots );
     free( workqueue_state );
     return ( action_replay_return_t const ) { 0 };
 }
@@ -116,11 +437,18 @@ static action_replay_return_t action_replay_workqueue_t_internal(
     action_replay_workqueue_t const * const restrict original_workqueue,
     action_replay_args_t const args,
     action_replay_workqueue_t_put_func_t const put,
+    action_replay_workqueue_t_put_item_func_t const put_item,
+    action_replay_workqueue_t_put_many_func_t const put_many,
+    action_replay_workqueue_t_put_many_items_func_t const put_many_items,
+    action_replay_workqueue_t_put_ordered_func_t const put_ordered,
     action_replay_workqueue_t_func_t const start,
     action_replay_workqueue_t_func_t const stop,
     action_replay_workqueue_t_func_t const join
 )
 {
+    if( NULL == args.state )
+    { return ( action_replay_return_t const ) { EINVAL }; }
+
     SUPER(
         operation,
         action_replay_workqueue_t_class,
@@ -131,7 +459,7 @@ static action_replay_return_t action_replay_workqueue_t_internal(
 
     action_replay_stateful_return_t result;
     
-    result = action_replay_workqueue_t_state_t_new();
+    result = action_replay_workqueue_t_state_t_new( args );
     if( 0 != result.status )
     {
         SUPER(
@@ -154,6 +482,26 @@ static action_replay_return_t action_replay_workqueue_t_internal(
         put,
         workqueue
     ) = put;
+    ACTION_REPLAY_DYNAMIC(
+        action_replay_workqueue_t_put_item_func_t,
+        put_item,
+        workqueue
+    ) = put_item;
+    ACTION_REPLAY_DYNAMIC(
+        action_replay_workqueue_t_put_many_func_t,
+        put_many,
+        workqueue
+    ) = put_many;
+    ACTION_REPLAY_DYNAMIC(
+        action_replay_workqueue_t_put_many_items_func_t,
+        put_many_items,
+        workqueue
+    ) = put_many_items;
+    ACTION_REPLAY_DYNAMIC(
+        action_replay_workqueue_t_put_ordered_func_t,
+        put_ordered,
+        workqueue
+    ) = put_ordered;
     ACTION_REPLAY_DYNAMIC(
         action_replay_workqueue_t_func_t,
         start,
@@ -178,6 +526,35 @@ static action_replay_return_t action_replay_workqueue_t_put_func_t_put(
     action_replay_workqueue_t_work_func_t const payload,
     void * const state
 );
+static action_replay_return_t
+action_replay_workqueue_t_put_item_func_t_put_item(
+    action_replay_workqueue_t * const self,
+    action_replay_workqueue_t_item_t * const item,
+    action_replay_workqueue_t_work_func_t const payload,
+    void * const state
+);
+static action_replay_return_t
+action_replay_workqueue_t_put_many_func_t_put_many(
+    action_replay_workqueue_t * const self,
+    action_replay_workqueue_t_work_func_t const payload,
+    void * const * const states,
+    size_t const count
+);
+static action_replay_return_t
+action_replay_workqueue_t_put_many_items_func_t_put_many_items(
+    action_replay_workqueue_t * const self,
+    action_replay_workqueue_t_item_t * const items,
+    action_replay_workqueue_t_work_func_t const payload,
+    void * const * const states,
+    size_t const count
+);
+static action_replay_return_t
+action_replay_workqueue_t_put_ordered_func_t_put_ordered(
+    action_replay_workqueue_t * const self,
+    size_t const key,
+    action_replay_workqueue_t_work_func_t const payload,
+    void * const state
+);
 static action_replay_return_t action_replay_workqueue_t_func_t_start(
     action_replay_workqueue_t * const self
 );
@@ -199,6 +576,10 @@ static inline action_replay_return_t action_replay_workqueue_t_constructor(
         NULL,
         args,
         action_replay_workqueue_t_put_func_t_put,
+        action_replay_workqueue_t_put_item_func_t_put_item,
+        action_replay_workqueue_t_put_many_func_t_put_many,
+        action_replay_workqueue_t_put_many_items_func_t_put_many_items,
+        action_replay_workqueue_t_put_ordered_func_t_put_ordered,
         action_replay_workqueue_t_func_t_start,
         action_replay_workqueue_t_func_t_stop,
         action_replay_workqueue_t_func_t_join
@@ -277,204 +658,1088 @@ static action_replay_reflector_return_t action_replay_workqueue_t_reflector(
     );
 }
 
-static action_replay_return_t action_replay_workqueue_t_put_func_t_put(
-    action_replay_workqueue_t * const self,
-    action_replay_workqueue_t_work_func_t const payload,
-    void * const state
+/* sleeps while word is set, may return early; caller looks again */
+static void action_replay_workqueue_t_park(
+    action_replay_workqueue_t_state_t * const workqueue_state,
+    OPA_int_t * const word
 )
 {
-    if(
-        ( NULL == self )
-        || ( NULL == payload )
-        || ( ! action_replay_is_type(
-            ( void * const ) self,
-            action_replay_workqueue_t_class()
-    ))) { return ( action_replay_return_t const ) { EINVAL }; }
-    
-    action_replay_workqueue_t_state_t * const workqueue_state =
-        ACTION_REPLAY_DYNAMIC(
-            action_replay_workqueue_t_state_t *,
-            workqueue_state,
-            self
-        );
-    action_replay_workqueue_t_item_t * item;
-    
-    item = calloc( 1, sizeof( action_replay_workqueue_t_item_t ));
-    if( NULL == item ) { return ( action_replay_return_t const ) { ENOMEM }; }
-    OPA_Queue_header_init( &( item->header ));
-    item->payload = payload;
-    item->state = state;
-    OPA_Queue_enqueue(
-        &( workqueue_state->queue ),
-        item,
-        action_replay_workqueue_t_item_t,
-        header
+#if WORKQUEUE_FUTEX
+    ( void ) workqueue_state;
+    /* OPA_int_t wraps a single int; EAGAIN if it was cleared already */
+    syscall(
+        SYS_futex,
+        ( int * ) word,
+        FUTEX_WAIT_PRIVATE,
+        1,
+        NULL,
+        NULL,
+        0
     );
-
-    return ( action_replay_return_t const )
-    { pthread_cond_broadcast( &( workqueue_state->condition )) };
-}
-
-static action_replay_return_t action_replay_workqueue_t_func_t_start(
-    action_replay_workqueue_t * const self
-)
-{
-    if(
-        ( NULL == self )
-        || ( ! action_replay_is_type(
-            ( void * const ) self,
-            action_replay_workqueue_t_class()
-    ))) { return ( action_replay_return_t const ) { EINVAL }; }
-
-    action_replay_workqueue_t_state_t * const workqueue_state =
-        ACTION_REPLAY_DYNAMIC(
-            action_replay_workqueue_t_state_t *,
-            workqueue_state,
-            self
-        );
-    action_replay_return_t result;
-
-    result = workqueue_state->worker->start_lock( workqueue_state->worker );
-    switch( result.status )
+#else /* ! WORKQUEUE_FUTEX */
+    pthread_mutex_lock( &( workqueue_state->mutex ));
+    if( 0 != OPA_load_int( word ))
     {
-        case 0: break;
-        case EALREADY: return result;
-        default: return result;
+        pthread_cond_wait(
+            &( workqueue_state->condition ),
+            &( workqueue_state->mutex )
+        );
     }
-    OPA_store_ptr( &( workqueue_state->run_flag ), &workqueue_continue );
-    result = workqueue_state->worker->start_locked(
-        workqueue_state->worker,
-        workqueue_state
-    );
-    workqueue_state->worker->start_unlock(
-        workqueue_state->worker,
-        ( 0 == result.status )
-    );
-
-    return result;
+    pthread_mutex_unlock( &( workqueue_state->mutex ));
+#endif /* WORKQUEUE_FUTEX */
 }
 
-static action_replay_return_t action_replay_workqueue_t_func_t_finish(
-    action_replay_workqueue_t * const self,
-    action_replay_workqueue_t_run_flag_t * const run_flag
+/*
+ * wakes other side if it parked on word; the barrier pairs with
+ * the parking side's one, so either it sees the store made before
+ * this call, or this sees the word set
+ */
+static void action_replay_workqueue_t_unpark(
+    action_replay_workqueue_t_state_t * const workqueue_state,
+    OPA_int_t * const word
 )
 {
-    if(
-        ( NULL == self )
-        || ( ! action_replay_is_type(
-            ( void * const ) self,
-            action_replay_workqueue_t_class()
-    ))) { return ( action_replay_return_t const ) { EINVAL }; }
-
-    action_replay_workqueue_t_state_t * const workqueue_state =
-        ACTION_REPLAY_DYNAMIC(
-            action_replay_workqueue_t_state_t *,
-            workqueue_state,
-            self
-        );
-    action_replay_return_t result;
-
-    result = workqueue_state->worker->stop_lock( workqueue_state->worker );
-    switch( result.status )
-    {
-        case 0: break;
-        case EALREADY: return result;
-        default: return result;
-    }
-    OPA_store_ptr( &( workqueue_state->run_flag ), run_flag );
-    /* in case thread is waiting on empty queue */
-    result = ( action_replay_return_t const )
-    { pthread_cond_broadcast( &( workqueue_state->condition )) };
-    if( 0 == result.status )
-    {
-        result =
-            workqueue_state->worker->stop_locked( workqueue_state->worker );
-    }
-    workqueue_state->worker->stop_unlock(
-        workqueue_state->worker,
-        ( 0 == result.status )
+    OPA_read_write_barrier();
+    if( 0 == OPA_load_int( word )) { return; }
+    OPA_store_int( word, 0 );
+#if WORKQUEUE_FUTEX
+    ( void ) workqueue_state;
+    syscall(
+        SYS_futex,
+        ( int * ) word,
+        FUTEX_WAKE_PRIVATE,
+        1,
+        NULL,
+        NULL,
+        0
     );
-
-    return result;
+#else /* ! WORKQUEUE_FUTEX */
+    pthread_mutex_lock( &( workqueue_state->mutex ));
+    pthread_cond_broadcast( &( workqueue_state->condition ));
+    pthread_mutex_unlock( &( workqueue_state->mutex ));
+#endif /* WORKQUEUE_FUTEX */
 }
 
-static inline action_replay_return_t
-action_replay_workqueue_t_func_t_stop( action_replay_workqueue_t * const self )
-{ return action_replay_workqueue_t_func_t_finish( self, &workqueue_stop ); }
-
-static inline action_replay_return_t
-action_replay_workqueue_t_func_t_join( action_replay_workqueue_t * const self )
-{ return action_replay_workqueue_t_func_t_finish( self, &workqueue_join ); }
-
-static void * action_replay_workqueue_t_process_queue( void * state )
+/*
+ * producer; waits for room slot by slot, consumer is woken once
+ * the batch is in, or earlier if ring fills up before that;
+ * ENOBUFS if ring is full and nothing will empty it
+ */
+static action_replay_return_t action_replay_workqueue_t_push(
+    action_replay_workqueue_t_state_t * const restrict workqueue_state,
+    action_replay_workqueue_t_work_func_t const payload,
+    void * const * const restrict states,
+    size_t const count
+)
 {
-    action_replay_workqueue_t_state_t * const workqueue_state = state;
-    action_replay_workqueue_t_run_flag_t const * run_flag;
+    action_replay_workqueue_t_ring_t * const ring =
+        &( workqueue_state->ring );
+    action_replay_return_t result = { 0 };
 
-    LOG( "workqueue processing thread %p started", state );
-    while(
-        WORKQUEUE_STOP !=
-            * ( run_flag = OPA_load_ptr( &( workqueue_state->run_flag )))
-    )
+    for( size_t i = 0; i < count; ++i )
     {
-        pthread_mutex_lock( &( workqueue_state->mutex ));
-        while( 1 == OPA_Queue_is_empty( &( workqueue_state->queue )))
-        {
+        int const tail = OPA_load_int( &( ring->tail ));
+        int const next = ( tail + 1 ) % ring->size;
+        unsigned int spins = 0;
 
-            if( WORKQUEUE_JOIN ==
-                * ( run_flag = OPA_load_ptr( &( workqueue_state->run_flag )))
-            )
+        while( next == OPA_load_acquire_int( &( ring->head )))
+        {
+            if( 0 == OPA_load_int( &( ring->running )))
             {
-                LOG( "queue empty - quitting thread %p", state );
-                pthread_mutex_unlock( &( workqueue_state->mutex ));
-                goto handle_join_queue;
+                result.status = ENOBUFS;
+                goto handle_ring_full;
             }
-            pthread_cond_wait(
-                &( workqueue_state->condition ),
-                &( workqueue_state->mutex )
+            if( ring->spins > spins++ )
+            {
+                OPA_busy_wait();
+                continue;
+            }
+            /* slots put so far are what frees room */
+            action_replay_workqueue_t_unpark(
+                workqueue_state,
+                &( ring->consumer_parked )
             );
-            if( WORKQUEUE_STOP ==
-                * ( run_flag = OPA_load_ptr( &( workqueue_state->run_flag )))
+            OPA_store_int( &( ring->producer_parked ), 1 );
+            OPA_read_write_barrier();
+            if(
+                ( next == OPA_load_int( &( ring->head )))
+                && ( 0 != OPA_load_int( &( ring->running )))
             )
             {
-                LOG( "workqueue processing thread %p ordered to stop", state );
-                pthread_mutex_unlock( &( workqueue_state->mutex ));
-                goto handle_stop_queue;
+                action_replay_workqueue_t_park(
+                    workqueue_state,
+                    &( ring->producer_parked )
+                );
             }
+            OPA_store_int( &( ring->producer_parked ), 0 );
+            spins = 0;
         }
-        pthread_mutex_unlock( &( workqueue_state->mutex ));
-
-        action_replay_workqueue_t_item_t * item;
-
-        OPA_Queue_dequeue(
-            &( workqueue_state->queue ),
-            item,
-            action_replay_workqueue_t_item_t,
-            header
-        );
-        item->payload( item->state );
-        free( item );
+        ring->slots[ tail ].payload = payload;
+        ring->slots[ tail ].state = states[ i ];
+        OPA_store_release_int( &( ring->tail ), next );
     }
 
-handle_join_queue:
-handle_stop_queue:
-    /* flush queue */
-    while( 0 == OPA_Queue_is_empty( &( workqueue_state->queue )))
+handle_ring_full:
+    action_replay_workqueue_t_unpark(
+        workqueue_state,
+        &( ring->consumer_parked )
+    );
+    return result;
+}
+
+/* items are consecutive, processing thread is woken once */
+static action_replay_return_t action_replay_workqueue_t_enqueue(
+    action_replay_workqueue_t_state_t * const restrict workqueue_state,
+    action_replay_workqueue_t_item_t * const restrict items,
+    action_replay_workqueue_t_work_func_t const payload,
+    void * const * const restrict states,
+    size_t const count
+)
+{
+    for( size_t i = 0; i < count; ++i )
     {
-        action_replay_workqueue_t_item_t * item;
+        action_replay_workqueue_t_item_t * const item = items + i;
 
-        OPA_Queue_dequeue(
+        OPA_Queue_header_init( &( item->header ));
+        item->payload = payload;
+        item->state = states[ i ];
+        OPA_Queue_enqueue(
             &( workqueue_state->queue ),
             item,
             action_replay_workqueue_t_item_t,
             header
         );
-        free( item );
     }
 
-    LOG( "workqueue processing thread %p exiting", state );
-    return NULL;
-}
+    /*
+     * under mutex, so thread can't miss it between finding queue empty
+     * and starting to wait; callers may wait for items to run
+     * before putting more, which would never happen then
+     */
+    pthread_mutex_lock( &( workqueue_state->mutex ));
+
+    action_replay_return_t const result =
+    { pthread_cond_broadcast( &( workqueue_state->condition )) };
+
+    pthread_mutex_unlock( &( workqueue_state->mutex ));
+    return result;
+}
+
+/*
+ * wakes up to count sleeping pool threads, looking at span of them
+ * from first on; the barrier pairs with the sleeping thread's one,
+ * so either it sees work put before this call, or this sees it asleep
+ */
+static void action_replay_workqueue_t_pool_wake(
+    action_replay_workqueue_t_state_t * const workqueue_state,
+    unsigned int const first,
+    size_t count,
+    unsigned int const span
+)
+{
+    action_replay_workqueue_t_pool_t * const pool = &( workqueue_state->pool );
+
+    OPA_read_write_barrier();
+    if( 0 == OPA_load_int( &( pool->sleepers ))) { return; }
+    pthread_mutex_lock( &( workqueue_state->mutex ));
+    for( unsigned int i = 0; ( span > i ) && ( 0 < count ); ++i )
+    {
+        action_replay_workqueue_t_thread_t * const thread =
+            pool->threads + ( first + i ) % pool->threads_count;
+
+        if( 0 == OPA_load_int( &( thread->sleeping ))) { continue; }
+        OPA_store_int( &( thread->sleeping ), 0 );
+        OPA_decr_int( &( pool->sleepers ));
+        pthread_cond_signal( &( thread->condition ));
+        --count;
+    }
+    pthread_mutex_unlock( &( workqueue_state->mutex ));
+}
+
+/* counted as outstanding before thread's mutex lets anyone take them */
+static action_replay_return_t action_replay_workqueue_t_pool_push(
+    action_replay_workqueue_t_state_t * const restrict workqueue_state,
+    action_replay_workqueue_t_thread_t * const restrict thread,
+    bool const ordered,
+    action_replay_workqueue_t_work_func_t const payload,
+    void * const * const restrict states,
+    size_t const count
+)
+{
+    action_replay_workqueue_t_pool_t * const pool = &( workqueue_state->pool );
+    action_replay_workqueue_t_deque_t * const deque =
+        ( ordered ) ? &( thread->ordered ) : &( thread->stealable );
+    action_replay_return_t result = { 0 };
+    size_t pushed = 0;
+
+    pthread_mutex_lock( &( thread->mutex ));
+    for( ; count > pushed; ++pushed )
+    {
+        result.status = action_replay_workqueue_t_deque_push(
+            deque,
+            payload,
+            states[ pushed ]
+        );
+        if( 0 != result.status ) { break; }
+    }
+    OPA_add_int( &( pool->outstanding ), ( int ) pushed );
+    if( ordered )
+    { OPA_store_int( &( thread->ordered_count ), ( int ) deque->count ); }
+    else
+    {
+        OPA_store_int( &( thread->stealable_count ), ( int ) deque->count );
+        OPA_add_int( &( pool->stealable ), ( int ) pushed );
+    }
+    pthread_mutex_unlock( &( thread->mutex ));
+
+    /* only the owner runs ordered items, anyone may steal the others */
+    if( 0 < pushed )
+    {
+        action_replay_workqueue_t_pool_wake(
+            workqueue_state,
+            thread->index,
+            ( ordered ) ? 1 : pushed,
+            ( ordered ) ? 1 : pool->threads_count
+        );
+    }
+
+    return result;
+}
+
+/*
+ * pool thread puts to its own deque, where it finds them first;
+ * others spread the batch over the threads in turn
+ */
+static action_replay_return_t action_replay_workqueue_t_pool_put(
+    action_replay_workqueue_t_state_t * const restrict workqueue_state,
+    action_replay_workqueue_t_work_func_t const payload,
+    void * const * const restrict states,
+    size_t const count
+)
+{
+    action_replay_workqueue_t_pool_t * const pool = &( workqueue_state->pool );
+    action_replay_workqueue_t_thread_t * const own =
+        ( thread_key_ready ) ? pthread_getspecific( thread_key ) : NULL;
+
+    if(( NULL != own ) && ( workqueue_state == own->workqueue_state ))
+    {
+        return action_replay_workqueue_t_pool_push(
+            workqueue_state,
+            own,
+            false,
+            payload,
+            states,
+            count
+        );
+    }
+
+    size_t const chunk =
+        ( count + pool->threads_count - 1 ) / pool->threads_count;
+
+    for( size_t i = 0; count > i; i += chunk )
+    {
+        unsigned int const next =
+            ( unsigned int ) OPA_fetch_and_incr_int( &( pool->next ));
+        action_replay_return_t const result =
+            action_replay_workqueue_t_pool_push(
+                workqueue_state,
+                pool->threads + next % pool->threads_count,
+                false,
+                payload,
+                states + i,
+                ( count - i < chunk ) ? count - i : chunk
+            );
+
+        if( 0 != result.status ) { return result; }
+    }
+
+    return ( action_replay_return_t const ) { 0 };
+}
+
+/* own ordered items first, then own newest, then others' oldest */
+static bool action_replay_workqueue_t_pool_take(
+    action_replay_workqueue_t_thread_t * const restrict thread,
+    action_replay_workqueue_t_slot_t * const restrict slot
+)
+{
+    action_replay_workqueue_t_pool_t * const pool =
+        &( thread->workqueue_state->pool );
+    bool taken = false;
+
+    if( 0 < OPA_load_int( &( thread->ordered_count )))
+    {
+        pthread_mutex_lock( &( thread->mutex ));
+        taken = action_replay_workqueue_t_deque_pop_oldest(
+            &( thread->ordered ),
+            slot
+        );
+        OPA_store_int(
+            &( thread->ordered_count ),
+            ( int ) thread->ordered.count
+        );
+        pthread_mutex_unlock( &( thread->mutex ));
+        if( taken ) { return true; }
+    }
+    if( 0 < OPA_load_int( &( thread->stealable_count )))
+    {
+        pthread_mutex_lock( &( thread->mutex ));
+        taken = action_replay_workqueue_t_deque_pop_newest(
+            &( thread->stealable ),
+            slot
+        );
+        if( taken )
+        {
+            OPA_store_int(
+                &( thread->stealable_count ),
+                ( int ) thread->stealable.count
+            );
+            OPA_decr_int( &( pool->stealable ));
+        }
+        pthread_mutex_unlock( &( thread->mutex ));
+        if( taken ) { return true; }
+    }
+    for(
+        unsigned int i = 1;
+        ( pool->threads_count > i )
+            && ( 0 < OPA_load_int( &( pool->stealable )));
+        ++i
+    )
+    {
+        action_replay_workqueue_t_thread_t * const victim =
+            pool->threads + ( thread->index + i ) % pool->threads_count;
+
+        if( 0 == OPA_load_int( &( victim->stealable_count ))) { continue; }
+        pthread_mutex_lock( &( victim->mutex ));
+        taken = action_replay_workqueue_t_deque_pop_oldest(
+            &( victim->stealable ),
+            slot
+        );
+        if( taken )
+        {
+            OPA_store_int(
+                &( victim->stealable_count ),
+                ( int ) victim->stealable.count
+            );
+            OPA_decr_int( &( pool->stealable ));
+        }
+        pthread_mutex_unlock( &( victim->mutex ));
+        if( taken ) { return true; }
+    }
+
+    return false;
+}
+
+/* waits until woken, or there is something to take, or to quit */
+static void action_replay_workqueue_t_pool_sleep(
+    action_replay_workqueue_t_thread_t * const thread
+)
+{
+    action_replay_workqueue_t_state_t * const workqueue_state =
+        thread->workqueue_state;
+    action_replay_workqueue_t_pool_t * const pool = &( workqueue_state->pool );
+
+    pthread_mutex_lock( &( workqueue_state->mutex ));
+    OPA_store_int( &( thread->sleeping ), 1 );
+    OPA_incr_int( &( pool->sleepers ));
+    OPA_read_write_barrier();
+    while( 0 != OPA_load_int( &( thread->sleeping )))
+    {
+        action_replay_workqueue_t_run_flag_t const run_flag =
+            * ( action_replay_workqueue_t_run_flag_t const * )
+                OPA_load_ptr( &( workqueue_state->run_flag ));
+
+        if(
+            ( 0 < OPA_load_int( &( thread->ordered_count )))
+            || ( 0 < OPA_load_int( &( pool->stealable )))
+            || ( WORKQUEUE_STOP == run_flag )
+            || (
+                ( WORKQUEUE_JOIN == run_flag )
+                && ( 0 == OPA_load_int( &( pool->outstanding )))
+            )
+        )
+        {
+            OPA_store_int( &( thread->sleeping ), 0 );
+            OPA_decr_int( &( pool->sleepers ));
+            break;
+        }
+        pthread_cond_wait(
+            &( thread->condition ),
+            &( workqueue_state->mutex )
+        );
+    }
+    pthread_mutex_unlock( &( workqueue_state->mutex ));
+}
+
+/* drops items left by stop(), with every pool thread joined */
+static void action_replay_workqueue_t_pool_flush(
+    action_replay_workqueue_t_pool_t * const pool
+)
+{
+    for( unsigned int i = 0; pool->threads_count > i; ++i )
+    {
+        action_replay_workqueue_t_thread_t * const thread = pool->threads + i;
+
+        pthread_mutex_lock( &( thread->mutex ));
+        OPA_add_int(
+            &( pool->stealable ),
+            - ( int ) thread->stealable.count
+        );
+        OPA_add_int(
+            &( pool->outstanding ),
+            - ( int ) ( thread->stealable.count + thread->ordered.count )
+        );
+        thread->stealable.count = 0;
+        thread->ordered.count = 0;
+        OPA_store_int( &( thread->stealable_count ), 0 );
+        OPA_store_int( &( thread->ordered_count ), 0 );
+        pthread_mutex_unlock( &( thread->mutex ));
+    }
+}
+
+/* in case threads are waiting for work, see put() */
+static action_replay_return_t action_replay_workqueue_t_wake_all(
+    action_replay_workqueue_t_state_t * const workqueue_state
+)
+{
+    action_replay_return_t result = { 0 };
+
+    switch( workqueue_state->backend )
+    {
+        case ACTION_REPLAY_WORKQUEUE_T_SPSC:
+            action_replay_workqueue_t_unpark(
+                workqueue_state,
+                &( workqueue_state->ring.consumer_parked )
+            );
+            break;
+        case ACTION_REPLAY_WORKQUEUE_T_POOL:
+            action_replay_workqueue_t_pool_wake(
+                workqueue_state,
+                0,
+                workqueue_state->pool.threads_count,
+                workqueue_state->pool.threads_count
+            );
+            break;
+        default:
+            pthread_mutex_lock( &( workqueue_state->mutex ));
+            result.status =
+                pthread_cond_broadcast( &( workqueue_state->condition ));
+            pthread_mutex_unlock( &( workqueue_state->mutex ));
+            break;
+    }
+
+    return result;
+}
+
+/* allocates item, which queue frees once its payload ran; ring doesn't */
+static action_replay_return_t action_replay_workqueue_t_put_func_t_put(
+    action_replay_workqueue_t * const self,
+    action_replay_workqueue_t_work_func_t const payload,
+    void * const state
+)
+{
+    if(
+        ( NULL == self )
+        || ( NULL == payload )
+        || ( ! action_replay_is_type(
+            ( void * const ) self,
+            action_replay_workqueue_t_class()
+    ))) { return ( action_replay_return_t const ) { EINVAL }; }
+
+    action_replay_workqueue_t_state_t * const workqueue_state =
+        ACTION_REPLAY_DYNAMIC(
+            action_replay_workqueue_t_state_t *,
+            workqueue_state,
+            self
+        );
+    void * const states[] = { state };
+
+    if( ACTION_REPLAY_WORKQUEUE_T_SPSC == workqueue_state->backend )
+    {
+        return action_replay_workqueue_t_push(
+            workqueue_state,
+            payload,
+            states,
+            1
+        );
+    }
+    if( ACTION_REPLAY_WORKQUEUE_T_POOL == workqueue_state->backend )
+    {
+        return action_replay_workqueue_t_pool_put(
+            workqueue_state,
+            payload,
+            states,
+            1
+        );
+    }
+
+    action_replay_workqueue_t_item_t * const item =
+        malloc( sizeof( action_replay_workqueue_t_item_t ));
+
+    if( NULL == item ) { return ( action_replay_return_t const ) { ENOMEM }; }
+    item->allocation = item;
+
+    return action_replay_workqueue_t_enqueue(
+        workqueue_state,
+        item,
+        payload,
+        states,
+        1
+    );
+}
+
+/* no allocation, item is caller's */
+static action_replay_return_t
+action_replay_workqueue_t_put_item_func_t_put_item(
+    action_replay_workqueue_t * const self,
+    action_replay_workqueue_t_item_t * const item,
+    action_replay_workqueue_t_work_func_t const payload,
+    void * const state
+)
+{
+    if(
+        ( NULL == self )
+        || ( NULL == item )
+        || ( NULL == payload )
+        || ( ! action_replay_is_type(
+            ( void * const ) self,
+            action_replay_workqueue_t_class()
+    ))) { return ( action_replay_return_t const ) { EINVAL }; }
+    item->allocation = NULL;
+
+    action_replay_workqueue_t_state_t * const workqueue_state =
+        ACTION_REPLAY_DYNAMIC(
+            action_replay_workqueue_t_state_t *,
+            workqueue_state,
+            self
+        );
+    void * const states[] = { state };
+
+    /* ring and pool copy payload and state, item isn't used */
+    if( ACTION_REPLAY_WORKQUEUE_T_SPSC == workqueue_state->backend )
+    {
+        return action_replay_workqueue_t_push(
+            workqueue_state,
+            payload,
+            states,
+            1
+        );
+    }
+    if( ACTION_REPLAY_WORKQUEUE_T_POOL == workqueue_state->backend )
+    {
+        return action_replay_workqueue_t_pool_put(
+            workqueue_state,
+            payload,
+            states,
+            1
+        );
+    }
+
+    return action_replay_workqueue_t_enqueue(
+        workqueue_state,
+        item,
+        payload,
+        states,
+        1
+    );
+}
+
+/* only locked backend uses items, the others copy payload and state */
+static action_replay_return_t action_replay_workqueue_t_put_batch(
+    action_replay_workqueue_t_state_t * const restrict workqueue_state,
+    action_replay_workqueue_t_item_t * const restrict items,
+    action_replay_workqueue_t_work_func_t const payload,
+    void * const * const restrict states,
+    size_t const count
+)
+{
+    if( ACTION_REPLAY_WORKQUEUE_T_SPSC == workqueue_state->backend )
+    {
+        return action_replay_workqueue_t_push(
+            workqueue_state,
+            payload,
+            states,
+            count
+        );
+    }
+    if( ACTION_REPLAY_WORKQUEUE_T_POOL == workqueue_state->backend )
+    {
+        return action_replay_workqueue_t_pool_put(
+            workqueue_state,
+            payload,
+            states,
+            count
+        );
+    }
+
+    return action_replay_workqueue_t_enqueue(
+        workqueue_state,
+        items,
+        payload,
+        states,
+        count
+    );
+}
+
+/*
+ * one allocation for the whole batch, freed with its last item;
+ * queue runs items in order, so the others were dequeued before it
+ */
+static action_replay_return_t
+action_replay_workqueue_t_put_many_func_t_put_many(
+    action_replay_workqueue_t * const self,
+    action_replay_workqueue_t_work_func_t const payload,
+    void * const * const states,
+    size_t const count
+)
+{
+    if(
+        ( NULL == self )
+        || ( NULL == payload )
+        || (( NULL == states ) && ( 0 < count ))
+        || ( ! action_replay_is_type(
+            ( void * const ) self,
+            action_replay_workqueue_t_class()
+    ))) { return ( action_replay_return_t const ) { EINVAL }; }
+    if( 0 == count ) { return ( action_replay_return_t const ) { 0 }; }
+
+    action_replay_workqueue_t_state_t * const workqueue_state =
+        ACTION_REPLAY_DYNAMIC(
+            action_replay_workqueue_t_state_t *,
+            workqueue_state,
+            self
+        );
+    action_replay_workqueue_t_item_t * items = NULL;
+
+    if( ACTION_REPLAY_WORKQUEUE_T_LOCKED == workqueue_state->backend )
+    {
+        items = calloc( count, sizeof( action_replay_workqueue_t_item_t ));
+        if( NULL == items )
+        { return ( action_replay_return_t const ) { ENOMEM }; }
+        items[ count - 1 ].allocation = items;
+    }
+
+    return action_replay_workqueue_t_put_batch(
+        workqueue_state,
+        items,
+        payload,
+        states,
+        count
+    );
+}
+
+/* no allocation, items are caller's */
+static action_replay_return_t
+action_replay_workqueue_t_put_many_items_func_t_put_many_items(
+    action_replay_workqueue_t * const self,
+    action_replay_workqueue_t_item_t * const items,
+    action_replay_workqueue_t_work_func_t const payload,
+    void * const * const states,
+    size_t const count
+)
+{
+    if(
+        ( NULL == self )
+        || ( NULL == payload )
+        || ((( NULL == items ) || ( NULL == states )) && ( 0 < count ))
+        || ( ! action_replay_is_type(
+            ( void * const ) self,
+            action_replay_workqueue_t_class()
+    ))) { return ( action_replay_return_t const ) { EINVAL }; }
+    if( 0 == count ) { return ( action_replay_return_t const ) { 0 }; }
+    for( size_t i = 0; i < count; ++i ) { items[ i ].allocation = NULL; }
+
+    return action_replay_workqueue_t_put_batch(
+        ACTION_REPLAY_DYNAMIC(
+            action_replay_workqueue_t_state_t *,
+            workqueue_state,
+            self
+        ),
+        items,
+        payload,
+        states,
+        count
+    );
+}
+
+/* only a pool runs items concurrently, others keep them in order anyway */
+static action_replay_return_t
+action_replay_workqueue_t_put_ordered_func_t_put_ordered(
+    action_replay_workqueue_t * const self,
+    size_t const key,
+    action_replay_workqueue_t_work_func_t const payload,
+    void * const state
+)
+{
+    if(
+        ( NULL == self )
+        || ( NULL == payload )
+        || ( ! action_replay_is_type(
+            ( void * const ) self,
+            action_replay_workqueue_t_class()
+    ))) { return ( action_replay_return_t const ) { EINVAL }; }
+
+    action_replay_workqueue_t_state_t * const workqueue_state =
+        ACTION_REPLAY_DYNAMIC(
+            action_replay_workqueue_t_state_t *,
+            workqueue_state,
+            self
+        );
+    void * const states[] = { state };
+
+    if( ACTION_REPLAY_WORKQUEUE_T_POOL != workqueue_state->backend )
+    {
+        return action_replay_workqueue_t_put_func_t_put(
+            self,
+            payload,
+            state
+        );
+    }
+
+    return action_replay_workqueue_t_pool_push(
+        workqueue_state,
+        workqueue_state->pool.threads
+            + key % workqueue_state->pool.threads_count,
+        true,
+        payload,
+        states,
+        1
+    );
+}
+
+static action_replay_return_t action_replay_workqueue_t_func_t_start(
+    action_replay_workqueue_t * const self
+)
+{
+    if(
+        ( NULL == self )
+        || ( ! action_replay_is_type(
+            ( void * const ) self,
+            action_replay_workqueue_t_class()
+    ))) { return ( action_replay_return_t const ) { EINVAL }; }
+
+    action_replay_workqueue_t_state_t * const workqueue_state =
+        ACTION_REPLAY_DYNAMIC(
+            action_replay_workqueue_t_state_t *,
+            workqueue_state,
+            self
+        );
+    action_replay_worker_t * const * const workers = workqueue_state->workers;
+    unsigned int const workers_count = workqueue_state->workers_count;
+    action_replay_return_t result = { 0 };
+    unsigned int locked;
+    unsigned int started;
+
+    /* workers start and stop together, first one tells how it went */
+    for( locked = 0; workers_count > locked; ++locked )
+    {
+        result = workers[ locked ]->start_lock( workers[ locked ] );
+        if( 0 != result.status ) { goto handle_start_lock_error; }
+    }
+    OPA_store_ptr( &( workqueue_state->run_flag ), &workqueue_continue );
+    /* before thread runs, so a put can't find a full ring abandoned */
+    OPA_store_int( &( workqueue_state->ring.running ), 1 );
+    for( started = 0; workers_count > started; ++started )
+    {
+        result = workers[ started ]->start_locked(
+            workers[ started ],
+            action_replay_workqueue_t_thread_state( workqueue_state, started )
+        );
+        if( 0 != result.status ) { goto handle_start_locked_error; }
+    }
+    for( unsigned int i = 0; workers_count > i; ++i )
+    { workers[ i ]->start_unlock( workers[ i ], true ); }
+
+    return result;
+
+handle_start_locked_error:
+    OPA_store_ptr( &( workqueue_state->run_flag ), &workqueue_stop );
+    action_replay_workqueue_t_wake_all( workqueue_state );
+    for( unsigned int i = 0; started > i; ++i )
+    { workers[ i ]->stop_locked( workers[ i ] ); }
+    OPA_store_int( &( workqueue_state->ring.running ), 0 );
+handle_start_lock_error:
+    while( 0 < locked )
+    {
+        --locked;
+        workers[ locked ]->start_unlock( workers[ locked ], false );
+    }
+    return result;
+}
+
+static action_replay_return_t action_replay_workqueue_t_func_t_finish(
+    action_replay_workqueue_t * const self,
+    action_replay_workqueue_t_run_flag_t * const run_flag
+)
+{
+    if(
+        ( NULL == self )
+        || ( ! action_replay_is_type(
+            ( void * const ) self,
+            action_replay_workqueue_t_class()
+    ))) { return ( action_replay_return_t const ) { EINVAL }; }
+
+    action_replay_workqueue_t_state_t * const workqueue_state =
+        ACTION_REPLAY_DYNAMIC(
+            action_replay_workqueue_t_state_t *,
+            workqueue_state,
+            self
+        );
+    action_replay_worker_t * const * const workers = workqueue_state->workers;
+    unsigned int const workers_count = workqueue_state->workers_count;
+    action_replay_return_t result = { 0 };
+    unsigned int locked;
+    unsigned int joined;
+
+    for( locked = 0; workers_count > locked; ++locked )
+    {
+        result = workers[ locked ]->stop_lock( workers[ locked ] );
+        if( 0 != result.status ) { goto handle_stop_lock_error; }
+    }
+    OPA_store_ptr( &( workqueue_state->run_flag ), run_flag );
+    result = action_replay_workqueue_t_wake_all( workqueue_state );
+    for( joined = 0; ( 0 == result.status ) && ( workers_count > joined ); )
+    {
+        result = workers[ joined ]->stop_locked( workers[ joined ] );
+        if( 0 == result.status ) { ++joined; }
+    }
+    /* no thread left to run them, nor to put more */
+    if(
+        ( workers_count == joined )
+        && ( ACTION_REPLAY_WORKQUEUE_T_POOL == workqueue_state->backend )
+    ) { action_replay_workqueue_t_pool_flush( &( workqueue_state->pool )); }
+    for( unsigned int i = 0; workers_count > i; ++i )
+    { workers[ i ]->stop_unlock( workers[ i ], ( joined > i )); }
+
+    return result;
+
+handle_stop_lock_error:
+    while( 0 < locked )
+    {
+        --locked;
+        workers[ locked ]->stop_unlock( workers[ locked ], false );
+    }
+    return result;
+}
+
+static inline action_replay_return_t
+action_replay_workqueue_t_func_t_stop( action_replay_workqueue_t * const self )
+{ return action_replay_workqueue_t_func_t_finish( self, &workqueue_stop ); }
+
+static inline action_replay_return_t
+action_replay_workqueue_t_func_t_join( action_replay_workqueue_t * const self )
+{ return action_replay_workqueue_t_func_t_finish( self, &workqueue_join ); }
+
+static void * action_replay_workqueue_t_process_queue( void * state )
+{
+    action_replay_workqueue_t_state_t * const workqueue_state = state;
+    action_replay_workqueue_t_run_flag_t const * run_flag;
+
+    LOG( "workqueue processing thread %p started", state );
+    while(
+        WORKQUEUE_STOP !=
+            * ( run_flag = OPA_load_ptr( &( workqueue_state->run_flag )))
+    )
+    {
+        /* batches are drained without going back to the mutex */
+        if( 1 == OPA_Queue_is_empty( &( workqueue_state->queue )))
+        {
+            pthread_mutex_lock( &( workqueue_state->mutex ));
+            while( 1 == OPA_Queue_is_empty( &( workqueue_state->queue )))
+            {
+
+                if( WORKQUEUE_JOIN == * ( run_flag =
+                    OPA_load_ptr( &( workqueue_state->run_flag ))
+                ))
+                {
+                    LOG( "queue empty - quitting thread %p", state );
+                    pthread_mutex_unlock( &( workqueue_state->mutex ));
+                    goto handle_join_queue;
+                }
+                pthread_cond_wait(
+                    &( workqueue_state->condition ),
+                    &( workqueue_state->mutex )
+                );
+                if( WORKQUEUE_STOP == * ( run_flag =
+                    OPA_load_ptr( &( workqueue_state->run_flag ))
+                ))
+                {
+                    LOG(
+                        "workqueue processing thread %p ordered to stop",
+                        state
+                    );
+                    pthread_mutex_unlock( &( workqueue_state->mutex ));
+                    goto handle_stop_queue;
+                }
+            }
+            pthread_mutex_unlock( &( workqueue_state->mutex ));
+        }
+
+        action_replay_workqueue_t_item_t * item;
+
+        OPA_Queue_dequeue(
+            &( workqueue_state->queue ),
+            item,
+            action_replay_workqueue_t_item_t,
+            header
+        );
+
+        /* caller's item may be put again as soon as payload starts */
+        action_replay_workqueue_t_work_func_t const payload = item->payload;
+        void * const item_state = item->state;
+
+        free( item->allocation );
+        payload( item_state );
+    }
+
+handle_join_queue:
+handle_stop_queue:
+    /* flush queue */
+    while( 0 == OPA_Queue_is_empty( &( workqueue_state->queue )))
+    {
+        action_replay_workqueue_t_item_t * item;
+
+        OPA_Queue_dequeue(
+            &( workqueue_state->queue ),
+            item,
+            action_replay_workqueue_t_item_t,
+            header
+        );
+        free( item->allocation );
+    }
+
+    LOG( "workqueue processing thread %p exiting", state );
+    return NULL;
+}
+
+static void * action_replay_workqueue_t_process_ring( void * state )
+{
+    action_replay_workqueue_t_state_t * const workqueue_state = state;
+    action_replay_workqueue_t_ring_t * const ring =
+        &( workqueue_state->ring );
+    action_replay_workqueue_t_run_flag_t const * run_flag;
+    unsigned int spins = 0;
+
+    LOG( "workqueue processing thread %p started", state );
+    while(
+        WORKQUEUE_STOP !=
+            * ( run_flag = OPA_load_ptr( &( workqueue_state->run_flag )))
+    )
+    {
+        int const head = OPA_load_int( &( ring->head ));
+
+        if( head != OPA_load_acquire_int( &( ring->tail )))
+        {
+            action_replay_workqueue_t_slot_t const slot = ring->slots[ head ];
+
+            OPA_store_release_int(
+                &( ring->head ),
+                ( head + 1 ) % ring->size
+            );
+            action_replay_workqueue_t_unpark(
+                workqueue_state,
+                &( ring->producer_parked )
+            );
+            slot.payload( slot.state );
+            spins = 0;
+            continue;
+        }
+        if( WORKQUEUE_JOIN == * run_flag )
+        {
+            LOG( "queue empty - quitting thread %p", state );
+            break;
+        }
+        if( ring->spins > spins++ )
+        {
+            OPA_busy_wait();
+            continue;
+        }
+        OPA_store_int( &( ring->consumer_parked ), 1 );
+        OPA_read_write_barrier();
+        run_flag = OPA_load_ptr( &( workqueue_state->run_flag ));
+        if(
+            ( head == OPA_load_int( &( ring->tail )))
+            && ( WORKQUEUE_CONTINUE == * run_flag )
+        )
+        {
+            action_replay_workqueue_t_park(
+                workqueue_state,
+                &( ring->consumer_parked )
+            );
+        }
+        OPA_store_int( &( ring->consumer_parked ), 0 );
+        spins = 0;
+    }
+
+    /* flush ring, then let a producer waiting for room give up */
+    OPA_store_release_int(
+        &( ring->head ),
+        OPA_load_acquire_int( &( ring->tail ))
+    );
+    OPA_store_int( &( ring->running ), 0 );
+    action_replay_workqueue_t_unpark(
+        workqueue_state,
+        &( ring->producer_parked )
+    );
+
+    LOG( "workqueue processing thread %p exiting", state );
+    return NULL;
+}
+
+static void * action_replay_workqueue_t_process_pool( void * state )
+{
+    action_replay_workqueue_t_thread_t * const thread = state;
+    action_replay_workqueue_t_state_t * const workqueue_state =
+        thread->workqueue_state;
+    action_replay_workqueue_t_pool_t * const pool = &( workqueue_state->pool );
+    action_replay_workqueue_t_run_flag_t const * run_flag;
+    action_replay_workqueue_t_slot_t slot;
+
+    LOG( "workqueue processing thread %p started", state );
+    /* so items put by payloads land in this thread's deque */
+    if( thread_key_ready ) { pthread_setspecific( thread_key, thread ); }
+    while(
+        WORKQUEUE_STOP !=
+            * ( run_flag = OPA_load_ptr( &( workqueue_state->run_flag )))
+    )
+    {
+        if( action_replay_workqueue_t_pool_take( thread, &slot ))
+        {
+            slot.payload( slot.state );
+            /* payload's own puts were counted already, so 0 means done */
+            if( 1 == OPA_fetch_and_decr_int( &( pool->outstanding )))
+            {
+                OPA_read_write_barrier();
+                if( WORKQUEUE_JOIN == * ( action_replay_workqueue_t_run_flag_t
+                    const * ) OPA_load_ptr( &( workqueue_state->run_flag ))
+                )
+                {
+                    action_replay_workqueue_t_pool_wake(
+                        workqueue_state,
+                        0,
+                        pool->threads_count,
+                        pool->threads_count
+                    );
+                }
+            }
+            continue;
+        }
+        if(
+            ( WORKQUEUE_JOIN == * run_flag )
+            && ( 0 == OPA_load_int( &( pool->outstanding )))
+        )
+        {
+            LOG( "queue empty - quitting thread %p", state );
+            break;
+        }
+        action_replay_workqueue_t_pool_sleep( thread );
+    }
+
+    /* deques are flushed by finish(), payloads may put until all quit */
+    if( thread_key_ready ) { pthread_setspecific( thread_key, NULL ); }
+
+    LOG( "workqueue processing thread %p exiting", state );
+    return NULL;
+}
 
 action_replay_class_t const * action_replay_workqueue_t_class( void )
 {
@@ -483,6 +1748,8 @@ action_replay_class_t const * action_replay_workqueue_t_class( void )
         action_replay_object_t_class,
         NULL
     };
+    static action_replay_reflection_cache_t reflection_cache;
+    static action_replay_class_t_ancestry_t ancestry;
     static action_replay_class_t const result =
     {
         sizeof( action_replay_workqueue_t ),
@@ -490,12 +1757,67 @@ action_replay_class_t const * action_replay_workqueue_t_class( void )
         action_replay_workqueue_t_destructor,
         action_replay_workqueue_t_copier,
         action_replay_workqueue_t_reflector,
-        inheritance
+        &reflection_cache,
+        inheritance,
+        &ancestry,
+        NULL
     };
 
     return &result;
 }
 
-action_replay_args_t action_replay_workqueue_t_args( void )
-{ return action_replay_args_t_default_args(); }
+static action_replay_return_t
+action_replay_workqueue_t_args_t_destructor( void * const state )
+{
+    free( state );
+    return ( action_replay_return_t const ) { 0 };
+}
+
+static action_replay_stateful_return_t
+action_replay_workqueue_t_args_t_copier( void * const state )
+{
+    action_replay_stateful_return_t result;
+
+    result.state = calloc( 1, sizeof( action_replay_workqueue_t_args_t ));
+    if( NULL == result.state )
+    {
+        result.status = ENOMEM;
+        return result;
+    }
+    result.status = 0;
+
+    action_replay_workqueue_t_args_t * const workqueue_args = result.state;
+    action_replay_workqueue_t_args_t const * const original_workqueue_args =
+        state;
+
+    workqueue_args->backend = original_workqueue_args->backend;
+    workqueue_args->ring_capacity = original_workqueue_args->ring_capacity;
+    workqueue_args->threads = original_workqueue_args->threads;
+
+    return result;
+}
+
+action_replay_args_t action_replay_workqueue_t_args(
+    action_replay_workqueue_t_backend_t const backend,
+    size_t const ring_capacity,
+    unsigned int const threads
+)
+{
+    action_replay_args_t result = action_replay_args_t_default_args();
+    action_replay_workqueue_t_args_t args =
+    { backend, ring_capacity, threads };
+    action_replay_stateful_return_t const copy =
+        action_replay_workqueue_t_args_t_copier( &args );
+
+    if( 0 == copy.status )
+    {
+        result = ( action_replay_args_t const ) {
+            copy.state,
+            action_replay_workqueue_t_args_t_destructor,
+            action_replay_workqueue_t_args_t_copier
+        };
+    }
+
+    return result;
+}
 
@@ -0,0 +1,97 @@
+#ifndef ACTION_REPLAY_TEST_BENCHMARK_H__
+# define ACTION_REPLAY_TEST_BENCHMARK_H__
+
+/*
+ * helpers shared by benchmarks, kept in a header so each benchmark
+ * still builds from its own source; includer defines _POSIX_C_SOURCE
+ */
+
+# include <action_replay/assert.h>
+# include <action_replay/nanoseconds.h>
+# include <action_replay/object_oriented_programming.h>
+# include <action_replay/player.h>
+# include <action_replay/recorder_io.h>
+# include <action_replay/stdint.h>
+# include <action_replay/time.h>
+# include <linux/input.h>
+# include <stdio.h>
+
+/* ABS events per frame, each frame ends with SYN_REPORT */
+# define BENCHMARK_AXES 10
+
+/* start is from action_replay_nanoseconds_monotonic_now() */
+static inline double benchmark_seconds_since( uint64_t const start )
+{
+    return ( action_replay_nanoseconds_monotonic_now() - start )
+        / ( double ) ACTION_REPLAY_NANOSECONDS_IN_SECOND;
+}
+
+/*
+ * JSON recording of frames for /dev/null, all at zero time,
+ * so only frames split writes and replay doesn't sleep
+ */
+static inline void benchmark_write_frames(
+    char const * const path,
+    unsigned int const events
+)
+{
+    static action_replay_recorder_io_writer_t writer;
+    FILE * const output = fopen( path, "w" );
+
+    assert( NULL != output );
+    action_replay_recorder_io_writer_init(
+        &writer,
+        fileno( output ),
+        ACTION_REPLAY_RECORDER_IO_JSON
+    );
+    assert( 0 == action_replay_recorder_io_write_header(
+        "/dev/null",
+        &writer
+    ));
+
+    struct input_event event = { { 0, 0 }, EV_ABS, ABS_X, 0 };
+    uint64_t zero_time = 0;
+
+    for( unsigned int i = 0; i < events; ++i )
+    {
+        unsigned int const axis = i % ( BENCHMARK_AXES + 1 );
+
+        event.type = ( BENCHMARK_AXES == axis ) ? EV_SYN : EV_ABS;
+        event.code = ( BENCHMARK_AXES == axis )
+            ? SYN_REPORT
+            : ( uint16_t ) axis;
+        event.value = ( BENCHMARK_AXES == axis ) ? 0 : ( int32_t ) i;
+        assert( 0 == action_replay_recorder_io_write_event(
+            event,
+            &zero_time,
+            &writer
+        ));
+    }
+    assert( 0 == action_replay_recorder_io_writer_flush( &writer ));
+    assert( 0 == fclose( output ));
+}
+
+/* returns seconds of a whole replay, from opening to join */
+static inline double benchmark_replay(
+    char const * const path,
+    action_replay_time_t const * const zero_time
+)
+{
+    uint64_t const start = action_replay_nanoseconds_monotonic_now();
+    action_replay_player_t * const player = action_replay_new(
+        action_replay_player_t_class(),
+        action_replay_player_t_args( path, false )
+    );
+
+    assert( NULL != player );
+    assert( 0 == ( player->start(
+        ( void * const ) player,
+        action_replay_player_t_start_state( zero_time, 0, false, 0 )
+    )).status );
+    assert( 0 == player->join( player ).status );
+    assert( 0 == action_replay_delete( ( void * ) player ));
+
+    return benchmark_seconds_since( start );
+}
+
+#endif /* ACTION_REPLAY_TEST_BENCHMARK_H__ */
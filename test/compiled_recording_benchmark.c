@@ -0,0 +1,87 @@
+#define _POSIX_C_SOURCE 200809L /* fileno */
+
+#include "benchmark.h"
+#include <action_replay/assert.h>
+#include <action_replay/compiled_recording.h>
+#include <action_replay/nanoseconds.h>
+#include <action_replay/object_oriented_programming.h>
+#include <action_replay/stdint.h>
+#include <action_replay/time.h>
+#include <action_replay/time_converter.h>
+#include <stdio.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+
+/* events go to /dev/null, replay time is parsing and dispatch */
+#define RECORDING "compiled_recording_benchmark.json"
+#define COMPILED RECORDING ACTION_REPLAY_COMPILED_RECORDING_SUFFIX
+#define EVENTS 5000000
+
+typedef struct {
+    double wall; /* ms */
+    double cpu; /* ms, all threads */
+} times_t;
+
+static double cpu_ms( void )
+{
+    struct rusage usage;
+
+    assert( 0 == getrusage( RUSAGE_SELF, &usage ));
+    return ( usage.ru_utime.tv_sec + usage.ru_stime.tv_sec ) * 1e3
+        + ( usage.ru_utime.tv_usec + usage.ru_stime.tv_usec ) / 1e3;
+}
+
+static times_t replay( action_replay_time_t const * const zero_time )
+{
+    double const cpu_start = cpu_ms();
+    double const seconds = benchmark_replay( RECORDING, zero_time );
+
+    return ( times_t ) { seconds * 1e3, cpu_ms() - cpu_start };
+}
+
+int main()
+{
+    benchmark_write_frames( RECORDING, EVENTS );
+    remove( COMPILED );
+
+    action_replay_time_converter_t * const now = action_replay_new(
+        action_replay_time_converter_t_class(),
+        action_replay_time_converter_t_args(
+            action_replay_time_converter_t_now()
+        )
+    );
+    assert( NULL != now );
+    action_replay_time_t * const zero_time = action_replay_new(
+        action_replay_time_t_class(),
+        action_replay_time_t_args( now )
+    );
+    assert( NULL != zero_time );
+
+    /* page-ins are paid by the first replay */
+    replay( zero_time );
+
+    times_t const text = replay( zero_time );
+    uint64_t const compile_start = action_replay_nanoseconds_monotonic_now();
+
+    assert( 0 == action_replay_compiled_recording_compile( RECORDING ));
+
+    double const compile = benchmark_seconds_since( compile_start ) * 1e3;
+    times_t const compiled = replay( zero_time );
+
+    printf(
+        "%u events: compile %.1f ms, replay of JSON %.1f ms (cpu %.1f ms),"
+        " of compiled %.1f ms (cpu %.1f ms)\n",
+        EVENTS,
+        compile,
+        text.wall,
+        text.cpu,
+        compiled.wall,
+        compiled.cpu
+    );
+
+    assert( 0 == action_replay_delete( ( void * ) zero_time ));
+    assert( 0 == action_replay_delete( ( void * ) now ));
+    assert( 0 == remove( COMPILED ));
+    assert( 0 == remove( RECORDING ));
+    return 0;
+}
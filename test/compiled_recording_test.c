@@ -0,0 +1,238 @@
+#define _POSIX_C_SOURCE 200809L /* fileno, futimens */
+
+#include <action_replay/assert.h>
+#include <action_replay/binary_recording.h>
+#include <action_replay/compiled_recording.h>
+#include <action_replay/json_recording.h>
+#include <action_replay/recorder_io.h>
+#include <action_replay/stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define RECORDING "compiled_recording_test.json"
+#define COMPILED RECORDING ACTION_REPLAY_COMPILED_RECORDING_SUFFIX
+/* more than a chunk of compilation */
+#define EVENTS 1000
+/* writer starts each event with a newline */
+#define EXTRA_EVENT \
+    "\n{ \"time\": 1, \"type\": 3, \"code\": 0, \"value\": 0 }"
+
+typedef struct {
+    struct stat stat;
+    void const * buffer;
+    size_t length;
+} source_t;
+
+static void write_recording( void )
+{
+    static action_replay_recorder_io_writer_t writer;
+    FILE * const output = fopen( RECORDING, "w" );
+
+    assert( NULL != output );
+    action_replay_recorder_io_writer_init(
+        &writer,
+        fileno( output ),
+        ACTION_REPLAY_RECORDER_IO_JSON
+    );
+    assert( 0 == action_replay_recorder_io_write_header(
+        "/dev/null",
+        &writer
+    ));
+
+    struct input_event event = { { 0, 0 }, EV_ABS, ABS_X, 0 };
+    uint64_t zero_time = 0;
+
+    for( unsigned int i = 0; i < EVENTS; ++i )
+    {
+        event.time.tv_usec = ( long int ) i;
+        event.value = ( int32_t ) i;
+        assert( 0 == action_replay_recorder_io_write_event(
+            event,
+            &zero_time,
+            &writer
+        ));
+    }
+    assert( 0 == action_replay_recorder_io_writer_flush( &writer ));
+    assert( 0 == fclose( output ));
+}
+
+static source_t source_map( void )
+{
+    source_t result;
+    int const fd = open( RECORDING, O_RDONLY );
+
+    assert( -1 != fd );
+    assert( 0 == fstat( fd, &( result.stat )));
+    result.length = ( size_t ) result.stat.st_size;
+    result.buffer = mmap( NULL, result.length, PROT_READ, MAP_SHARED, fd, 0 );
+    assert( MAP_FAILED != result.buffer );
+    assert( 0 == close( fd ));
+    return result;
+}
+
+static void source_unmap( source_t const source )
+{
+    assert( 0 == munmap( ( void * ) source.buffer, source.length ));
+}
+
+static action_replay_compiled_recording_return_t
+compiled_open( source_t const * const source )
+{
+    return action_replay_compiled_recording_open(
+        RECORDING,
+        &( source->stat ),
+        source->buffer,
+        source->length
+    );
+}
+
+static void compiled_close(
+    action_replay_compiled_recording_return_t const compiled
+)
+{
+    assert( 0 == munmap(
+        ( void * ) compiled.mapping,
+        compiled.mapping_length
+    ));
+}
+
+static void test_missing( void )
+{
+    puts( "test missing sidecar is ENOENT" );
+    remove( COMPILED );
+
+    source_t const source = source_map();
+
+    assert( ENOENT == compiled_open( &source ).status );
+    source_unmap( source );
+}
+
+static void test_compiled_events( void )
+{
+    puts( "test sidecar has every event of source" );
+    assert( 0 == action_replay_compiled_recording_compile( RECORDING ));
+
+    source_t const source = source_map();
+    action_replay_compiled_recording_return_t const compiled =
+        compiled_open( &source );
+
+    assert( 0 == compiled.status );
+
+    action_replay_binary_recording_return_t const binary =
+        action_replay_binary_recording_read(
+            compiled.recording,
+            compiled.recording_length
+        );
+    action_replay_json_recording_header_return_t const header =
+        action_replay_json_recording_parse_header(
+            source.buffer,
+            source.length
+        );
+
+    assert( 0 == binary.status );
+    assert( 0 == header.status );
+    assert( 0 == strcmp( header.path, binary.path ));
+
+    action_replay_json_recording_lines_return_t const lines =
+        action_replay_json_recording_parse_lines(
+            ( char const * ) source.buffer + header.events_offset,
+            source.length - header.events_offset
+        );
+
+    assert( 0 == lines.status );
+    assert( EVENTS == lines.count );
+    assert( lines.count == binary.count );
+    assert( 0 == memcmp(
+        lines.records,
+        binary.records,
+        lines.count * sizeof( action_replay_binary_recording_record_t )
+    ));
+    free( lines.records );
+    free( header.path );
+    compiled_close( compiled );
+    source_unmap( source );
+}
+
+static void test_touched( void )
+{
+    puts( "test touched source with same hash updates sidecar mtime" );
+
+    struct timespec const times[ 2 ] = { { 1, 0 }, { 1, 0 } };
+    int const fd = open( RECORDING, O_RDONLY );
+
+    assert( -1 != fd );
+    assert( 0 == futimens( fd, times ));
+    assert( 0 == close( fd ));
+
+    source_t const source = source_map();
+    action_replay_compiled_recording_return_t compiled =
+        compiled_open( &source );
+
+    assert( 0 == compiled.status );
+    compiled_close( compiled );
+    compiled = compiled_open( &source );
+    assert( 0 == compiled.status );
+
+    action_replay_compiled_recording_header_t const * const header =
+        compiled.mapping;
+
+    assert( 1 == header->source_mtime_seconds );
+    assert( 0 == header->source_mtime_nanoseconds );
+    compiled_close( compiled );
+    source_unmap( source );
+}
+
+static void test_size_changed( void )
+{
+    puts( "test source of other size is ESTALE" );
+
+    FILE * const output = fopen( RECORDING, "a" );
+
+    assert( NULL != output );
+    assert( EOF != fputs( EXTRA_EVENT, output ));
+    assert( 0 == fclose( output ));
+
+    source_t const source = source_map();
+
+    assert( ESTALE == compiled_open( &source ).status );
+    source_unmap( source );
+}
+
+static void test_truncated( void )
+{
+    puts( "test truncated sidecar is ESTALE" );
+    assert( 0 == action_replay_compiled_recording_compile( RECORDING ));
+
+    source_t const source = source_map();
+    action_replay_compiled_recording_return_t const compiled =
+        compiled_open( &source );
+
+    assert( 0 == compiled.status );
+    compiled_close( compiled );
+    assert( 0 == truncate(
+        COMPILED,
+        sizeof( action_replay_compiled_recording_header_t ) - 1
+    ));
+    assert( ESTALE == compiled_open( &source ).status );
+    source_unmap( source );
+}
+
+int main()
+{
+    write_recording();
+    test_missing();
+    test_compiled_events();
+    test_touched();
+    test_size_changed();
+    test_truncated();
+    assert( 0 == remove( COMPILED ));
+    assert( 0 == remove( RECORDING ));
+    return 0;
+}
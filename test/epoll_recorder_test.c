@@ -0,0 +1,132 @@
+#define _POSIX_C_SOURCE 200809L /* nanosleep */
+
+#include <action_replay/assert.h>
+#include <action_replay/epoll_recorder.h>
+#include <action_replay/log.h>
+#include <action_replay/object_oriented_programming.h>
+#include <action_replay/stddef.h>
+#include <action_replay/time.h>
+#include <action_replay/time_converter.h>
+#include <linux/input.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+/* two pipes recorded together, one closed halfway through */
+#define EVENTS 16
+#define OUTPUT_A "/tmp/action_replay_epoll_recorder_test_a.json"
+#define OUTPUT_B "/tmp/action_replay_epoll_recorder_test_b.json"
+
+static void settle( void )
+{
+    struct timespec const pause = { 0, 200 * 1000 * 1000 };
+
+    nanosleep( &pause, NULL );
+}
+
+static void write_events( int const fd, unsigned int const count )
+{
+    for( unsigned int i = 0; i < count; ++i )
+    {
+        struct input_event event;
+
+        memset( &event, 0, sizeof( event ));
+        gettimeofday( &( event.time ), NULL );
+        event.type = EV_KEY;
+        event.code = KEY_A;
+        event.value = i % 2;
+        assert( sizeof( event ) == write( fd, &event, sizeof( event )));
+    }
+}
+
+static unsigned int count_lines( char const * const path )
+{
+    FILE * const file = fopen( path, "r" );
+    unsigned int lines = 0;
+    int c;
+
+    assert( NULL != file );
+    while( EOF != ( c = fgetc( file ))) { lines += ( '\n' == c ); }
+    assert( 0 == fclose( file ));
+    return lines;
+}
+
+int main()
+{
+    int a[ 2 ], b[ 2 ];
+    char input_a[ 32 ], input_b[ 32 ];
+
+    assert( 0 == action_replay_log_init( stderr ).status );
+    assert( 0 == pipe( a ));
+    assert( 0 == pipe( b ));
+    snprintf( input_a, sizeof( input_a ), "/dev/fd/%d", a[ 0 ] );
+    snprintf( input_b, sizeof( input_b ), "/dev/fd/%d", b[ 0 ] );
+
+    char const * const inputs[] = { input_a, input_b };
+    char const * const outputs[] = { OUTPUT_A, OUTPUT_B };
+    void * const recorder = action_replay_new(
+        action_replay_epoll_recorder_t_class(),
+        action_replay_epoll_recorder_t_args(
+            2,
+            inputs,
+            outputs,
+            ACTION_REPLAY_RECORDER_IO_JSON
+        )
+    );
+
+    assert( NULL != recorder );
+    /* the recorder holds its own descriptors of the read ends */
+    assert( 0 == close( a[ 0 ] ));
+    assert( 0 == close( b[ 0 ] ));
+
+    action_replay_time_converter_t * const now = action_replay_new(
+        action_replay_time_converter_t_class(),
+        action_replay_time_converter_t_args(
+            action_replay_time_converter_t_now()
+        )
+    );
+
+    assert( NULL != now );
+
+    action_replay_time_t * const zero_time = action_replay_new(
+        action_replay_time_t_class(),
+        action_replay_time_t_args( now )
+    );
+
+    assert( NULL != zero_time );
+    assert( 0 == ACTION_REPLAY_DYNAMIC(
+        action_replay_stoppable_t_start_func_t,
+        start,
+        recorder
+    )(
+        recorder,
+        action_replay_epoll_recorder_t_start_state( zero_time )
+    ).status );
+    assert( 0 == action_replay_delete( ( void * ) zero_time ));
+    assert( 0 == action_replay_delete( ( void * ) now ));
+
+    puts( "test closing one device keeps recording the other" );
+    write_events( a[ 1 ], EVENTS );
+    write_events( b[ 1 ], EVENTS );
+    settle();
+    assert( 0 == close( a[ 1 ] ));
+    settle();
+    write_events( b[ 1 ], EVENTS );
+    settle();
+    assert( 0 == ACTION_REPLAY_DYNAMIC(
+        action_replay_stoppable_t_stop_func_t,
+        stop,
+        recorder
+    )( recorder ).status );
+    assert( 0 == action_replay_delete( recorder ));
+    assert( 0 == close( b[ 1 ] ));
+    /* same header on both, b got the events written after a closed */
+    assert( count_lines( OUTPUT_A ) + EVENTS == count_lines( OUTPUT_B ));
+    assert( 0 == unlink( OUTPUT_A ));
+    assert( 0 == unlink( OUTPUT_B ));
+
+    assert( 0 == action_replay_log_close().status );
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <action_replay/assert.h>
+#include <action_replay/event_ring.h>
+#include <action_replay/stddef.h>
+#include <action_replay/stdint.h>
+#include <errno.h>
+#include <linux/input.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#define EVENTS 1000000
+#define CAPACITY 64
+#define BATCH 16
+
+static void * consume( void * const state )
+{
+    action_replay_event_ring_t * const ring = state;
+    struct input_event events[ BATCH ];
+    int32_t expected = 0;
+
+    for( ;; )
+    {
+        int const closed = action_replay_event_ring_t_is_closed( ring );
+        size_t const count =
+            action_replay_event_ring_t_pop( ring, events, BATCH );
+
+        /* producer retries on full ring, so nothing is lost */
+        for( size_t i = 0; i < count; ++i )
+        { assert( expected++ == events[ i ].value ); }
+        if( 0 < count ) { continue; }
+        if( closed ) { break; }
+        action_replay_event_ring_t_wait( ring, -1 );
+    }
+    assert( EVENTS == expected );
+
+    return NULL;
+}
+
+int main()
+{
+    action_replay_event_ring_t ring;
+    struct input_event event;
+
+    memset( &event, 0, sizeof( event ));
+    assert( EINVAL == action_replay_event_ring_t_init( &ring, 0 ).status );
+    assert( 0 == action_replay_event_ring_t_init( &ring, 2 ).status );
+
+    struct input_event events[ 3 ] = { event, event, event };
+
+    assert( 2 == action_replay_event_ring_t_push( &ring, events, 3 ));
+    assert( 1 == ring.dropped );
+    assert( 2 == ring.high_water_mark );
+    assert( 2 == action_replay_event_ring_t_pop( &ring, events, 3 ));
+    assert( 0 == action_replay_event_ring_t_pop( &ring, events, 3 ));
+    assert( ETIMEDOUT == action_replay_event_ring_t_wait( &ring, 1 ));
+    action_replay_event_ring_t_close( &ring );
+    assert( action_replay_event_ring_t_is_closed( &ring ));
+    assert( 0 == action_replay_event_ring_t_wait( &ring, -1 ));
+    action_replay_event_ring_t_reset( &ring );
+    assert( ! action_replay_event_ring_t_is_closed( &ring ));
+    assert( 0 == action_replay_event_ring_t_destroy( &ring ).status );
+
+    assert( 0 == action_replay_event_ring_t_init( &ring, CAPACITY ).status );
+
+    pthread_t consumer;
+
+    assert( 0 == pthread_create( &consumer, NULL, consume, &ring ));
+    for( int32_t i = 0; i < EVENTS; ++i )
+    {
+        event.value = i;
+        while( 0 == action_replay_event_ring_t_push( &ring, &event, 1 ));
+    }
+    action_replay_event_ring_t_close( &ring );
+    assert( 0 == pthread_join( consumer, NULL ));
+    printf(
+        "pushed: %llu, full ring retries: %llu, high-water mark: %llu\n",
+        ( unsigned long long int ) ring.pushed,
+        ( unsigned long long int ) ring.dropped,
+        ( unsigned long long int ) ring.high_water_mark
+    );
+    assert( EVENTS == ring.pushed );
+    assert( CAPACITY >= ring.high_water_mark );
+    assert( 0 == action_replay_event_ring_t_destroy( &ring ).status );
+
+    return 0;
+}
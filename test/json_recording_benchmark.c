@@ -0,0 +1,201 @@
+#define _POSIX_C_SOURCE 200809L /* fileno */
+
+#include "benchmark.h"
+#include <action_replay/assert.h>
+#include <action_replay/json_recording.h>
+#include <action_replay/nanoseconds.h>
+#include <action_replay/recorder_io.h>
+#include <action_replay/stdint.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define RECORDING "json_recording_benchmark.json"
+#define LINES 10000000
+#define EDGE_CASES 8
+
+typedef action_replay_json_recording_return_t ( * parse_func_t )(
+    char const * const buffer,
+    size_t const buffer_length
+);
+
+static void assert_same(
+    action_replay_json_recording_return_t const fast,
+    action_replay_json_recording_return_t const generic
+)
+{
+    assert( fast.status == generic.status );
+    assert( fast.delay == generic.delay );
+    assert( fast.type == generic.type );
+    assert( fast.code == generic.code );
+    assert( fast.value == generic.value );
+}
+
+/* lines the fast path doesn't take must still parse as before */
+static void check_edge_cases( void )
+{
+    static char const * const lines[ EDGE_CASES ] =
+    {
+        "{ \"time\": 0, \"type\": 0, \"code\": 0, \"value\": -2147483648 }",
+        "{\"time\":1,\"type\":3,\"code\":0,\"value\":-5}\n",
+        "{ \"type\": 3, \"time\": 7, \"code\": 0, \"value\": 1 }\n",
+        "{ \"time\": 18446744073709551615, \"type\": 1, \"code\": 2,"
+            " \"value\": 3 }",
+        "{ \"time\": 5, \"type\": 65536, \"code\": 2, \"value\": 3 }",
+        "{ \"time\": 5, \"type\": 1, \"code\": 2, \"value\": 2147483648 }",
+        "{ \"time\": 5, \"type\": 1, \"code\": 2 }",
+        "{ \"time\": 5, \"type\": 1, \"code\": 2, \"value\": 3 } x"
+    };
+
+    for( unsigned int i = 0; i < EDGE_CASES; ++i )
+    {
+        size_t const length = strlen( lines[ i ] );
+
+        assert_same(
+            action_replay_json_recording_parse_line( lines[ i ], length ),
+            action_replay_json_recording_parse_line_generic(
+                lines[ i ],
+                length
+            )
+        );
+    }
+}
+
+static void write_recording( void )
+{
+    static action_replay_recorder_io_writer_t writer;
+    FILE * const output = fopen( RECORDING, "w" );
+
+    assert( NULL != output );
+    action_replay_recorder_io_writer_init(
+        &writer,
+        fileno( output ),
+        ACTION_REPLAY_RECORDER_IO_JSON
+    );
+    assert( 0 == action_replay_recorder_io_write_header(
+        "/dev/input/event0",
+        &writer
+    ));
+
+    /* frames of 10 axes with changing values, a few ms apart */
+    uint64_t time = 0;
+    uint64_t zero_time = 0;
+    uint32_t random = 1;
+
+    for( unsigned int i = 0; i < LINES; ++i )
+    {
+        struct input_event event;
+        unsigned int const axis = i % 11;
+
+        random = random * 1103515245U + 12345U;
+        if( 0 == axis ) { time += 1000000 + random % 8000000; }
+        event.time.tv_sec = ( time_t ) ( time / 1000000000 );
+        event.time.tv_usec = ( suseconds_t ) ( time % 1000000000 / 1000 );
+        event.type = ( 10 == axis ) ? EV_SYN : EV_ABS;
+        event.code = ( 10 == axis ) ? SYN_REPORT : ( uint16_t ) axis;
+        event.value = ( 10 == axis )
+            ? 0
+            : ( int32_t ) ( random >> 8 ) - ( 1 << 23 );
+        assert( 0 == action_replay_recorder_io_write_event(
+            event,
+            &zero_time,
+            &writer
+        ));
+    }
+    assert( 0 == action_replay_recorder_io_writer_flush( &writer ));
+    assert( 0 == fclose( output ));
+}
+
+/* returns seconds, sum of fields keeps the calls from being optimized out */
+static double parse_all(
+    char const * const buffer,
+    size_t const length,
+    parse_func_t const parse,
+    uint64_t * const sum
+)
+{
+    char const * line = memchr( buffer, '\n', length ) + 1;
+    char const * const end = buffer + length;
+    unsigned int lines = 0;
+    uint64_t const start = action_replay_nanoseconds_monotonic_now();
+
+    while( end > line )
+    {
+        char const * const newline = memchr( line, '\n', end - line );
+        char const * const next = ( NULL == newline ) ? end : newline + 1;
+        action_replay_json_recording_return_t const result =
+            parse( line, next - line );
+
+        assert( 0 == result.status );
+        *sum += result.delay + result.type + result.code + result.value;
+        ++lines;
+        line = next;
+    }
+
+    double const result = benchmark_seconds_since( start );
+
+    assert( LINES == lines );
+    return result;
+}
+
+int main()
+{
+    check_edge_cases();
+    write_recording();
+
+    int const fd = open( RECORDING, O_RDONLY );
+    struct stat recording_stat;
+
+    assert( -1 != fd );
+    assert( 0 == fstat( fd, &recording_stat ));
+
+    size_t const length = ( size_t ) recording_stat.st_size;
+    char const * const buffer =
+        mmap( NULL, length, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+    assert( MAP_FAILED != buffer );
+
+    uint64_t generic_sum = 0;
+    uint64_t fast_sum = 0;
+    /* page-ins are paid by the first pass */
+    double const warm_up = parse_all(
+        buffer,
+        length,
+        action_replay_json_recording_parse_line,
+        &fast_sum
+    );
+    double const generic = parse_all(
+        buffer,
+        length,
+        action_replay_json_recording_parse_line_generic,
+        &generic_sum
+    );
+
+    fast_sum = 0;
+
+    double const fast = parse_all(
+        buffer,
+        length,
+        action_replay_json_recording_parse_line,
+        &fast_sum
+    );
+
+    ( void ) warm_up;
+    assert( fast_sum == generic_sum );
+    printf(
+        "%u lines: jsmn %.0f lines/s, fast path %.0f lines/s, %.1fx\n",
+        LINES,
+        LINES / generic,
+        LINES / fast,
+        generic / fast
+    );
+
+    assert( 0 == munmap( ( void * ) buffer, length ));
+    assert( 0 == close( fd ));
+    assert( 0 == remove( RECORDING ));
+    return 0;
+}
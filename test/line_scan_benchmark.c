@@ -0,0 +1,204 @@
+#include "benchmark.h"
+#include <action_replay/assert.h>
+#include <action_replay/line_scan.h>
+#include <action_replay/nanoseconds.h>
+#include <action_replay/stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BUFFER_LENGTH ( 64 * 1024 * 1024 )
+#define LONG_LINE_LENGTH 1024
+#define COMMENT_EVERY 100
+#define LINES_PER_CALL 256
+#define REPEATS 5
+
+typedef struct {
+    size_t lines;
+    size_t comments;
+    size_t bytes; /* sum of lengths, must cover buffer */
+} counts_t;
+
+/* lines as written by recorder, with a comment now and then */
+static size_t fill_recording( char * const buffer )
+{
+    uint32_t random = 1;
+    size_t length = 0;
+
+    for( unsigned int i = 0; ; ++i )
+    {
+        char line[ 128 ];
+        int written;
+
+        random = random * 1103515245U + 12345U;
+        if( 0 == i % COMMENT_EVERY )
+        { written = sprintf( line, "# comment %u\n", i ); }
+        else
+        {
+            written = sprintf(
+                line,
+                "{ \"time\": %u, \"type\": 3, \"code\": %u, \"value\": %d }\n",
+                random % 8000000,
+                i % 10,
+                ( int ) ( random >> 8 ) - ( 1 << 23 )
+            );
+        }
+        if( BUFFER_LENGTH < length + ( size_t ) written ) { break; }
+        memcpy( buffer + length, line, ( size_t ) written );
+        length += ( size_t ) written;
+    }
+
+    return length;
+}
+
+static size_t fill_long_lines( char * const buffer )
+{
+    size_t length = 0;
+
+    while( BUFFER_LENGTH >= length + LONG_LINE_LENGTH )
+    {
+        memset( buffer + length, 'x', LONG_LINE_LENGTH - 1 );
+        buffer[ length + LONG_LINE_LENGTH - 1 ] = '\n';
+        length += LONG_LINE_LENGTH;
+    }
+
+    return length;
+}
+
+static counts_t scan(
+    char const * const buffer,
+    size_t const length,
+    action_replay_line_scan_line_t * const lines
+)
+{
+    counts_t result = { 0, 0, 0 };
+    size_t offset = 0;
+
+    while( length > offset )
+    {
+        size_t const count = action_replay_line_scan_lines(
+            buffer + offset,
+            length - offset,
+            lines,
+            LINES_PER_CALL
+        );
+
+        assert( 0 < count );
+        for( size_t i = 0; i < count; ++i )
+        {
+            result.comments += lines[ i ].comment;
+            result.bytes += lines[ i ].length;
+        }
+        result.lines += count;
+        offset = ( size_t ) (
+            lines[ count - 1 ].start + lines[ count - 1 ].length - buffer
+        );
+    }
+
+    return result;
+}
+
+static void benchmark(
+    char const * const name,
+    char const * const buffer,
+    size_t const length
+)
+{
+    static action_replay_line_scan_line_t lines[ LINES_PER_CALL ];
+    counts_t expected = { 0, 0, 0 };
+
+    for(
+        int implementation = ACTION_REPLAY_LINE_SCAN_SCALAR;
+        ACTION_REPLAY_LINE_SCAN_IMPLEMENTATIONS_COUNT > implementation;
+        ++implementation
+    )
+    {
+        if( 0 != action_replay_line_scan_use(
+            ( action_replay_line_scan_implementation_t ) implementation
+        )) { continue; }
+
+        double best = 0;
+        counts_t counts;
+
+        for( unsigned int i = 0; i < REPEATS; ++i )
+        {
+            uint64_t const start = action_replay_nanoseconds_monotonic_now();
+            double seconds;
+
+            counts = scan( buffer, length, lines );
+            seconds = benchmark_seconds_since( start );
+            if(( 0 == i ) || ( best > seconds )) { best = seconds; }
+        }
+
+        assert( length == counts.bytes );
+        /* scalar runs first, everything else must agree with it */
+        if( ACTION_REPLAY_LINE_SCAN_SCALAR == implementation )
+        { expected = counts; }
+        assert( expected.lines == counts.lines );
+        assert( expected.comments == counts.comments );
+        printf(
+            "%s, %s: %zu lines, %zu comments, %.2f GB/s\n",
+            name,
+            action_replay_line_scan_implementation_name(
+                ( action_replay_line_scan_implementation_t ) implementation
+            ),
+            counts.lines,
+            counts.comments,
+            length / best / 1e9
+        );
+    }
+}
+
+/* unterminated last line and lines shorter than a vector */
+static void check_edge_cases( void )
+{
+    static char const text[] = "#a\n\n{}\n#\nxyz";
+    action_replay_line_scan_line_t lines[ 8 ];
+
+    for(
+        int implementation = ACTION_REPLAY_LINE_SCAN_SCALAR;
+        ACTION_REPLAY_LINE_SCAN_IMPLEMENTATIONS_COUNT > implementation;
+        ++implementation
+    )
+    {
+        if( 0 != action_replay_line_scan_use(
+            ( action_replay_line_scan_implementation_t ) implementation
+        )) { continue; }
+        assert( 0 == action_replay_line_scan_lines( text, 0, lines, 8 ));
+        assert( 5 == action_replay_line_scan_lines(
+            text,
+            sizeof( text ) - 1,
+            lines,
+            8
+        ));
+        assert( lines[ 0 ].comment && ( 3 == lines[ 0 ].length ));
+        assert(( ! lines[ 1 ].comment ) && ( 1 == lines[ 1 ].length ));
+        assert( lines[ 3 ].comment && ( 2 == lines[ 3 ].length ));
+        assert( 3 == lines[ 4 ].length );
+        assert( 2 == action_replay_line_scan_lines(
+            text,
+            sizeof( text ) - 1,
+            lines,
+            2
+        ));
+        assert( 2 == action_replay_line_scan_newline( text, sizeof( text ) - 1 ));
+        assert( 3 == action_replay_line_scan_newline( "xyz", 3 ));
+    }
+}
+
+int main()
+{
+    char * const buffer = malloc( BUFFER_LENGTH );
+
+    assert( NULL != buffer );
+    check_edge_cases();
+
+    size_t length = fill_recording( buffer );
+
+    benchmark( "recording", buffer, length );
+    length = fill_long_lines( buffer );
+    benchmark( "1 KiB lines", buffer, length );
+
+    free( buffer );
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include <action_replay/assert.h>
+#include <action_replay/nanoseconds.h>
+#include <action_replay/stdint.h>
+#include <errno.h>
+
+int main()
+{
+    action_replay_nanoseconds_return_t result;
+
+    result = action_replay_nanoseconds_add( 1, 2 );
+    assert( 0 == result.status );
+    assert( 3 == result.value );
+    result = action_replay_nanoseconds_add( UINT64_MAX - 1, 2 );
+    assert( E2BIG == result.status );
+    assert( UINT64_MAX == result.value );
+    result = action_replay_nanoseconds_sub( 3, 2 );
+    assert( 0 == result.status );
+    assert( 1 == result.value );
+    result = action_replay_nanoseconds_sub( 2, 3 );
+    assert( E2BIG == result.status );
+    assert( 0 == result.value );
+
+    uint64_t const now = action_replay_nanoseconds_now();
+    assert( 0 != now );
+    assert( now <= action_replay_nanoseconds_now() );
+#if HAVE_TIME_H
+    struct timespec const timespec =
+        action_replay_nanoseconds_to_timespec( 1500000001 );
+    assert( 1 == timespec.tv_sec );
+    assert( 500000001 == timespec.tv_nsec );
+    assert(
+        1500000001 == action_replay_nanoseconds_from_timespec( timespec )
+    );
+#endif /* HAVE_TIME_H */
+#if HAVE_SYS_TIME_H
+    struct timeval const timeval =
+        action_replay_nanoseconds_to_timeval( 1500000001 );
+    assert( 1 == timeval.tv_sec );
+    assert( 500000 == timeval.tv_usec );
+    assert( 1500000000 == action_replay_nanoseconds_from_timeval( timeval ));
+#endif /* HAVE_SYS_TIME_H */
+
+    return 0;
+}
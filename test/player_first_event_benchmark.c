@@ -0,0 +1,137 @@
+#define _POSIX_C_SOURCE 200809L /* mkfifo, fileno */
+
+#include <action_replay/assert.h>
+#include <action_replay/nanoseconds.h>
+#include <action_replay/object_oriented_programming.h>
+#include <action_replay/player.h>
+#include <action_replay/recorder_io.h>
+#include <action_replay/stdint.h>
+#include <action_replay/time.h>
+#include <action_replay/time_converter.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* replayed device is a FIFO, so the first write can be timed */
+#define RECORDING "player_first_event_benchmark.json"
+#define FIFO "player_first_event_benchmark.fifo"
+#define EVENTS 5000000
+
+typedef struct {
+    int fd;
+    uint64_t first_event; /* monotonic */
+    uint64_t bytes;
+} reader_t;
+
+static void * read_output( void * const state )
+{
+    reader_t * const reader = state;
+    struct pollfd descriptor = { reader->fd, POLLIN, 0 };
+    static char buffer[ 65536 ];
+
+    for( ;; )
+    {
+        assert( 1 == poll( &descriptor, 1, -1 ));
+
+        ssize_t const count = read( reader->fd, buffer, sizeof( buffer ));
+
+        /* player closed the device */
+        if( 0 == count ) { return NULL; }
+        if( 0 > count ) { continue; }
+        if( 0 == reader->bytes )
+        { reader->first_event = action_replay_nanoseconds_monotonic_now(); }
+        reader->bytes += ( uint64_t ) count;
+    }
+}
+
+static void write_recording( void )
+{
+    static action_replay_recorder_io_writer_t writer;
+    FILE * const output = fopen( RECORDING, "w" );
+
+    assert( NULL != output );
+    action_replay_recorder_io_writer_init(
+        &writer,
+        fileno( output ),
+        ACTION_REPLAY_RECORDER_IO_JSON
+    );
+    assert( 0 == action_replay_recorder_io_write_header( FIFO, &writer ));
+
+    /* all events at zero time, so replay doesn't sleep */
+    struct input_event event = { { 0, 0 }, EV_ABS, ABS_X, 0 };
+    uint64_t zero_time = 0;
+
+    for( unsigned int i = 0; i < EVENTS; ++i )
+    {
+        event.value = ( int32_t ) i;
+        assert( 0 == action_replay_recorder_io_write_event(
+            event,
+            &zero_time,
+            &writer
+        ));
+    }
+    assert( 0 == action_replay_recorder_io_writer_flush( &writer ));
+    assert( 0 == fclose( output ));
+}
+
+int main()
+{
+    write_recording();
+    assert( 0 == mkfifo( FIFO, 0600 ));
+
+    /* opened first, so player's open for writing doesn't block */
+    reader_t reader = { open( FIFO, O_RDONLY | O_NONBLOCK ), 0, 0 };
+    pthread_t reader_thread;
+
+    assert( -1 != reader.fd );
+
+    action_replay_time_converter_t * const now = action_replay_new(
+        action_replay_time_converter_t_class(),
+        action_replay_time_converter_t_args(
+            action_replay_time_converter_t_now()
+        )
+    );
+    assert( NULL != now );
+    action_replay_time_t * const zero_time = action_replay_new(
+        action_replay_time_t_class(),
+        action_replay_time_t_args( now )
+    );
+    assert( NULL != zero_time );
+
+    uint64_t const start = action_replay_nanoseconds_monotonic_now();
+    action_replay_player_t * const player = action_replay_new(
+        action_replay_player_t_class(),
+        action_replay_player_t_args( RECORDING, false )
+    );
+    assert( NULL != player );
+    /* until player opens the device, reads would see end of file */
+    assert( 0 == pthread_create( &reader_thread, NULL, read_output, &reader ));
+    assert( 0 == ( player->start(
+        ( void * const ) player,
+        action_replay_player_t_start_state( zero_time, 0, false, 0 )
+    )).status );
+    assert( 0 == player->join( player ).status );
+
+    uint64_t const end = action_replay_nanoseconds_monotonic_now();
+
+    assert( 0 == action_replay_delete( ( void * ) player ));
+    assert( 0 == pthread_join( reader_thread, NULL ));
+    assert( EVENTS * sizeof( struct input_event ) == reader.bytes );
+    printf(
+        "%u events: first event after %.3f ms, all after %.3f ms\n",
+        EVENTS,
+        ( reader.first_event - start ) / 1e6,
+        ( end - start ) / 1e6
+    );
+
+    assert( 0 == close( reader.fd ));
+    assert( 0 == action_replay_delete( ( void * ) zero_time ));
+    assert( 0 == action_replay_delete( ( void * ) now ));
+    assert( 0 == remove( FIFO ));
+    assert( 0 == remove( RECORDING ));
+    return 0;
+}
@@ -0,0 +1,49 @@
+#define _POSIX_C_SOURCE 200809L /* fileno */
+
+#include "benchmark.h"
+#include <action_replay/assert.h>
+#include <action_replay/object_oriented_programming.h>
+#include <action_replay/time.h>
+#include <action_replay/time_converter.h>
+#include <stdio.h>
+
+/* frames of 10 axes and SYN_REPORT, replayed to /dev/null */
+#define RECORDING "player_frame_benchmark.json"
+#define FRAMES 500000
+#define EVENTS ( FRAMES * ( BENCHMARK_AXES + 1 ))
+
+int main()
+{
+    benchmark_write_frames( RECORDING, EVENTS );
+
+    action_replay_time_converter_t * const now = action_replay_new(
+        action_replay_time_converter_t_class(),
+        action_replay_time_converter_t_args(
+            action_replay_time_converter_t_now()
+        )
+    );
+    assert( NULL != now );
+    action_replay_time_t * const zero_time = action_replay_new(
+        action_replay_time_t_class(),
+        action_replay_time_t_args( now )
+    );
+    assert( NULL != zero_time );
+
+    /* page-ins are paid by the first replay */
+    benchmark_replay( RECORDING, zero_time );
+
+    double const seconds = benchmark_replay( RECORDING, zero_time );
+
+    printf(
+        "%u events in %u frames: %.1f ms, %.0f events/s\n",
+        EVENTS,
+        FRAMES,
+        seconds * 1e3,
+        EVENTS / seconds
+    );
+
+    assert( 0 == action_replay_delete( ( void * ) zero_time ));
+    assert( 0 == action_replay_delete( ( void * ) now ));
+    assert( 0 == remove( RECORDING ));
+    return 0;
+}
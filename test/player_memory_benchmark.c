@@ -0,0 +1,62 @@
+#define _POSIX_C_SOURCE 200809L /* fileno */
+
+#include "benchmark.h"
+#include <action_replay/assert.h>
+#include <action_replay/object_oriented_programming.h>
+#include <action_replay/time.h>
+#include <action_replay/time_converter.h>
+#include <stdio.h>
+#include <sys/resource.h>
+
+/* peak memory of replays to /dev/null, growing recordings in turn */
+#define RECORDING "player_memory_benchmark.json"
+#define SMALLEST_EVENTS 1000000
+#define SIZES 3
+
+static long int peak_kilobytes( void )
+{
+    struct rusage usage;
+
+    assert( 0 == getrusage( RUSAGE_SELF, &usage ));
+    return usage.ru_maxrss;
+}
+
+int main()
+{
+    action_replay_time_converter_t * const now = action_replay_new(
+        action_replay_time_converter_t_class(),
+        action_replay_time_converter_t_args(
+            action_replay_time_converter_t_now()
+        )
+    );
+    assert( NULL != now );
+    action_replay_time_t * const zero_time = action_replay_new(
+        action_replay_time_t_class(),
+        action_replay_time_t_args( now )
+    );
+    assert( NULL != zero_time );
+
+    /* peak only grows, so a bounded replay keeps it where it was */
+    for(
+        unsigned int events = SMALLEST_EVENTS, i = 0;
+        i < SIZES;
+        events *= 4, ++i
+    )
+    {
+        benchmark_write_frames( RECORDING, events );
+
+        double const seconds = benchmark_replay( RECORDING, zero_time );
+
+        printf(
+            "%u events: %.1f ms, peak resident memory %ld KiB\n",
+            events,
+            seconds * 1e3,
+            peak_kilobytes()
+        );
+    }
+
+    assert( 0 == action_replay_delete( ( void * ) zero_time ));
+    assert( 0 == action_replay_delete( ( void * ) now ));
+    assert( 0 == remove( RECORDING ));
+    return 0;
+}
@@ -0,0 +1,203 @@
+#define _POSIX_C_SOURCE 200809L /* fileno */
+
+#include "benchmark.h"
+#include <action_replay/assert.h>
+#include <action_replay/json_recording.h>
+#include <action_replay/line_scan.h>
+#include <action_replay/nanoseconds.h>
+#include <action_replay/recorder_io.h>
+#include <action_replay/stdint.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* parse phase as player runs it, parts end after a newline */
+#define RECORDING "player_parse_scaling_benchmark.json"
+#define LINES 20000000
+#define MAX_THREADS 64
+
+typedef struct {
+    pthread_t thread;
+    char const * buffer;
+    size_t buffer_length;
+    action_replay_json_recording_lines_return_t lines;
+} part_t;
+
+static void write_recording( void )
+{
+    static action_replay_recorder_io_writer_t writer;
+    FILE * const output = fopen( RECORDING, "w" );
+
+    assert( NULL != output );
+    action_replay_recorder_io_writer_init(
+        &writer,
+        fileno( output ),
+        ACTION_REPLAY_RECORDER_IO_JSON
+    );
+    assert( 0 == action_replay_recorder_io_write_header(
+        "/dev/input/event0",
+        &writer
+    ));
+
+    uint64_t time = 0;
+    uint64_t zero_time = 0;
+    uint32_t random = 1;
+
+    for( unsigned int i = 0; i < LINES; ++i )
+    {
+        struct input_event event;
+        unsigned int const axis = i % 11;
+
+        random = random * 1103515245U + 12345U;
+        if( 0 == axis ) { time += 1000000 + random % 8000000; }
+        event.time.tv_sec = ( time_t ) ( time / 1000000000 );
+        event.time.tv_usec = ( suseconds_t ) ( time % 1000000000 / 1000 );
+        event.type = ( 10 == axis ) ? EV_SYN : EV_ABS;
+        event.code = ( 10 == axis ) ? SYN_REPORT : ( uint16_t ) axis;
+        event.value = ( 10 == axis )
+            ? 0
+            : ( int32_t ) ( random >> 8 ) - ( 1 << 23 );
+        assert( 0 == action_replay_recorder_io_write_event(
+            event,
+            &zero_time,
+            &writer
+        ));
+    }
+    assert( 0 == action_replay_recorder_io_writer_flush( &writer ));
+    assert( 0 == fclose( output ));
+}
+
+static void * parse_part( void * const state )
+{
+    part_t * const part = state;
+
+    part->lines = action_replay_json_recording_parse_lines(
+        part->buffer,
+        part->buffer_length
+    );
+    return NULL;
+}
+
+/* returns seconds, sum of delays checks all threads counts agree */
+static double parse(
+    char const * const buffer,
+    size_t const length,
+    unsigned int const threads,
+    uint64_t * const delays
+)
+{
+    static part_t parts[ MAX_THREADS ];
+    char const * const end = buffer + length;
+    char const * part_end = buffer;
+    uint64_t const start = action_replay_nanoseconds_monotonic_now();
+
+    for( unsigned int i = 0; i < threads; ++i )
+    {
+        char const * const target = buffer + ( i + 1 ) * ( length / threads );
+
+        parts[ i ].buffer = part_end;
+        if(( threads - 1 == i ) || ( part_end > target )) { part_end = end; }
+        else
+        {
+            part_end = target + action_replay_line_scan_newline(
+                target,
+                ( size_t ) ( end - target )
+            ) + 1;
+        }
+        parts[ i ].buffer_length = ( size_t ) ( part_end - parts[ i ].buffer );
+        assert( 0 == pthread_create(
+            &( parts[ i ].thread ),
+            NULL,
+            parse_part,
+            parts + i
+        ));
+    }
+
+    size_t count = 0;
+
+    for( unsigned int i = 0; i < threads; ++i )
+    {
+        assert( 0 == pthread_join( parts[ i ].thread, NULL ));
+        assert( 0 == parts[ i ].lines.status );
+        count += parts[ i ].lines.count;
+    }
+
+    double const result = benchmark_seconds_since( start );
+
+    assert( LINES == count );
+    *delays = 0;
+    for( unsigned int i = 0; i < threads; ++i )
+    {
+        for( size_t j = 0; j < parts[ i ].lines.count; ++j )
+        { *delays += parts[ i ].lines.records[ j ].delay; }
+        free( parts[ i ].lines.records );
+    }
+
+    return result;
+}
+
+/* optional argument is the most threads to try, default is online CPUs */
+int main( int argc, char ** argv )
+{
+    long const online = sysconf( _SC_NPROCESSORS_ONLN );
+    unsigned int max_threads = ( 1 < argc )
+        ? ( unsigned int ) strtoul( argv[ 1 ], NULL, 10 )
+        : (( 0 < online ) ? ( unsigned int ) online : 1 );
+
+    if( MAX_THREADS < max_threads ) { max_threads = MAX_THREADS; }
+    if( 1 > max_threads ) { max_threads = 1; }
+    write_recording();
+
+    int const fd = open( RECORDING, O_RDONLY );
+    struct stat recording_stat;
+
+    assert( -1 != fd );
+    assert( 0 == fstat( fd, &recording_stat ));
+
+    size_t const length = ( size_t ) recording_stat.st_size;
+    char const * const buffer =
+        mmap( NULL, length, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+    assert( MAP_FAILED != buffer );
+
+    /* player skips header before splitting */
+    size_t const header_length =
+        action_replay_line_scan_newline( buffer, length ) + 1;
+    char const * const events = buffer + header_length;
+    size_t const events_length = length - header_length;
+    uint64_t expected;
+    double single;
+
+    /* page-ins are paid by the first pass */
+    parse( events, events_length, 1, &expected );
+    for( unsigned int threads = 1; threads <= max_threads; ++threads )
+    {
+        uint64_t delays;
+        double const seconds = parse(
+            events,
+            events_length,
+            threads,
+            &delays
+        );
+
+        assert( expected == delays );
+        if( 1 == threads ) { single = seconds; }
+        printf(
+            "%u threads (%ld CPUs): %.0f lines/s, %.2fx\n",
+            threads,
+            online,
+            LINES / seconds,
+            single / seconds
+        );
+    }
+
+    assert( 0 == munmap( ( void * ) buffer, length ));
+    assert( 0 == close( fd ));
+    assert( 0 == remove( RECORDING ));
+    return 0;
+}
@@ -17,7 +17,7 @@ int main(int argc, char ** args)
     assert( 0 == action_replay_log_init( stderr ).status );
     action_replay_player_t * const player = action_replay_new(
         action_replay_player_t_class(),
-        action_replay_player_t_args( args[ 1 ] )
+        action_replay_player_t_args( args[ 1 ], false )
     );
     assert( NULL != player );
     action_replay_time_t * const zero_time = action_replay_new(
@@ -27,7 +27,7 @@ int main(int argc, char ** args)
     assert( NULL != zero_time );
     assert( 0 == ( player->start(
         ( void * const ) player,
-        action_replay_player_t_start_state( zero_time )
+        action_replay_player_t_start_state( zero_time, 0, false, 0 )
     )).status );
     assert( 0 == action_replay_delete( ( void * ) zero_time ));
     puts( "sleeping for 10 s" );
@@ -0,0 +1,76 @@
+#include <action_replay/assert.h>
+#include <action_replay/object.h>
+#include <action_replay/object_oriented_programming.h>
+#include <action_replay/pool.h>
+#include <action_replay/time_converter.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+
+#define ROUNDS 10000
+
+static void * churn( void * const unused )
+{
+    ( void ) unused;
+    for( unsigned int i = 0; i < ROUNDS; ++i )
+    {
+        action_replay_time_converter_t * const converter = action_replay_new(
+            action_replay_time_converter_t_class(),
+            action_replay_time_converter_t_args( i )
+        );
+        assert( NULL != converter );
+        assert( i == converter->nanoseconds( converter ).value );
+        assert( 0 == action_replay_delete( ( void * ) converter ));
+    }
+
+    return NULL;
+}
+
+int main()
+{
+    action_replay_pool_t pool =
+        ACTION_REPLAY_POOL_T_INITIALIZER( sizeof( uint64_t ));
+    uint64_t * block = action_replay_pool_t_alloc( &pool );
+    assert( NULL != block );
+    *block = 42;
+    action_replay_pool_t_free( &pool, block );
+    block = action_replay_pool_t_alloc( &pool );
+    assert( NULL != block );
+    assert( 0 == *block );
+    action_replay_pool_t_free( &pool, block );
+
+    action_replay_pool_t_stats_return_t stats =
+        action_replay_pool_t_stats( &pool );
+    assert( 0 == stats.status );
+    assert( 2 == stats.allocations );
+    assert( 1 == stats.recycled );
+    assert( 2 == stats.releases );
+
+    assert( 0 != action_replay_allocation_stats(
+        action_replay_object_t_class()
+    ).status );
+
+    pthread_t threads[ 4 ];
+
+    for( unsigned int i = 0; i < 4; ++i )
+    { assert( 0 == pthread_create( threads + i, NULL, churn, NULL )); }
+    for( unsigned int i = 0; i < 4; ++i )
+    { assert( 0 == pthread_join( threads[ i ], NULL )); }
+
+    stats = action_replay_allocation_stats(
+        action_replay_time_converter_t_class()
+    );
+    assert( 0 == stats.status );
+    printf(
+        "time_converter_t allocations: %" PRIu64 ", recycled: %" PRIu64
+        ", releases: %" PRIu64 "\n",
+        stats.allocations,
+        stats.recycled,
+        stats.releases
+    );
+    assert( 4 * ROUNDS == stats.allocations );
+    assert( stats.allocations == stats.releases );
+    assert( stats.allocations - stats.recycled <= 4 ); /* one block per thread */
+
+    return 0;
+}
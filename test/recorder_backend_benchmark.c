@@ -0,0 +1,276 @@
+#define _POSIX_C_SOURCE 200809L /* mkfifo, nanosleep */
+
+#include <action_replay/assert.h>
+#include <action_replay/binary_recording.h>
+#include <action_replay/epoll_recorder.h>
+#include <action_replay/object_oriented_programming.h>
+#include <action_replay/recorder.h>
+#include <action_replay/stdint.h>
+#include <action_replay/time.h>
+#include <action_replay/time_converter.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * synthetic device on a FIFO, fed by a child process;
+ * /proc/self/io counts read and write syscalls only, recorders
+ * count their poll, epoll_wait and io_uring_enter calls, and waits
+ * of writer thread along with the wakeups they take
+ */
+
+#define FIFO "recorder_backend_benchmark.fifo"
+#define OUTPUT "recorder_backend_benchmark.bin"
+#define AXES 10
+#define BURST_FRAMES 100000
+#define PACED_FRAMES 4000
+#define PACE_NANOSECONDS 250000
+#define NANOSECONDS_IN_MICROSECOND 1000
+#define NANOSECONDS_IN_SECOND 1000000000
+/* not a recorder_t backend, selects epoll_recorder_t */
+#define EPOLL (( action_replay_recorder_t_backend_t ) -1 )
+
+static void feed( unsigned int const frames, long int const pace )
+{
+    int const fd = open( FIFO, O_WRONLY );
+    struct input_event frame[ AXES + 1 ];
+    struct timespec const startup = { 0, 100 * 1000 * 1000 };
+    struct timespec const interval = { 0, pace };
+
+    assert( -1 != fd );
+    memset( frame, 0, sizeof( frame ));
+    for( unsigned int axis = 0; axis < AXES; ++axis )
+    {
+        frame[ axis ].type = EV_ABS;
+        frame[ axis ].code = ( uint16_t ) axis;
+    }
+    frame[ AXES ].type = EV_SYN;
+    frame[ AXES ].code = SYN_REPORT;
+    /* events mustn't predate recording start */
+    nanosleep( &startup, NULL );
+    for( unsigned int i = 0; i < frames; ++i )
+    {
+        struct timeval now;
+
+        gettimeofday( &now, NULL );
+        for( unsigned int event = 0; event <= AXES; ++event )
+        {
+            frame[ event ].time = now;
+            frame[ event ].value = ( int32_t ) i;
+        }
+        assert( sizeof( frame ) == write( fd, frame, sizeof( frame )));
+        if( 0 < pace ) { nanosleep( &interval, NULL ); }
+    }
+
+    int unread;
+
+    /* closing early would make recorder quit before reading it all */
+    do { nanosleep( &startup, NULL ); }
+    while(( 0 == ioctl( fd, FIONREAD, &unread )) && ( 0 < unread ));
+    close( fd );
+    _exit( 0 );
+}
+
+typedef struct { unsigned long long int reads, writes; } io_counters_t;
+
+static io_counters_t io_counters( void )
+{
+    FILE * const io = fopen( "/proc/self/io", "r" );
+    io_counters_t result = { 0, 0 };
+    char line[ 64 ];
+
+    assert( NULL != io );
+    while( NULL != fgets( line, sizeof( line ), io ))
+    {
+        sscanf( line, "syscr: %llu", &( result.reads ));
+        sscanf( line, "syscw: %llu", &( result.writes ));
+    }
+    fclose( io );
+    return result;
+}
+
+static uint64_t cpu_nanoseconds( struct rusage const * const usage )
+{
+    return (
+        ( uint64_t ) ( usage->ru_utime.tv_sec + usage->ru_stime.tv_sec )
+            * NANOSECONDS_IN_SECOND
+    ) + (
+        ( uint64_t ) ( usage->ru_utime.tv_usec + usage->ru_stime.tv_usec )
+            * NANOSECONDS_IN_MICROSECOND
+    );
+}
+
+static void benchmark(
+    char const * const name,
+    action_replay_recorder_t_backend_t const backend,
+    size_t const ring_capacity,
+    unsigned int const frames,
+    long int const pace
+)
+{
+    pid_t const feeder = fork();
+
+    assert( -1 != feeder );
+    if( 0 == feeder ) { feed( frames, pace ); }
+
+    char const * const input = FIFO;
+    char const * const output = OUTPUT;
+    /* opening blocks until feeder opens the other end */
+    void * const recorder = ( EPOLL == backend )
+        ? action_replay_new(
+            action_replay_epoll_recorder_t_class(),
+            action_replay_epoll_recorder_t_args(
+                1,
+                &input,
+                &output,
+                ACTION_REPLAY_RECORDER_IO_BINARY
+            )
+        )
+        : action_replay_new(
+            action_replay_recorder_t_class(),
+            action_replay_recorder_t_args(
+                input,
+                output,
+                ACTION_REPLAY_RECORDER_IO_BINARY,
+                ring_capacity,
+                backend
+            )
+        );
+    assert( NULL != recorder );
+    action_replay_time_converter_t * const now = action_replay_new(
+        action_replay_time_converter_t_class(),
+        action_replay_time_converter_t_args(
+            action_replay_time_converter_t_now()
+        )
+    );
+    assert( NULL != now );
+    action_replay_time_t * const zero_time = action_replay_new(
+        action_replay_time_t_class(),
+        action_replay_time_t_args( now )
+    );
+    assert( NULL != zero_time );
+
+    struct rusage before;
+    struct rusage after;
+    siginfo_t feeder_exit;
+    io_counters_t const io_before = io_counters();
+
+    assert( 0 == getrusage( RUSAGE_SELF, &before ));
+    assert( 0 == ACTION_REPLAY_DYNAMIC(
+        action_replay_stoppable_t_start_func_t,
+        start,
+        recorder
+    )(
+        recorder,
+        ( EPOLL == backend )
+            ? action_replay_epoll_recorder_t_start_state( zero_time )
+            : action_replay_recorder_t_start_state( zero_time )
+    ).status );
+    /* reaping would add feeder's syscalls to ours */
+    assert( 0 == waitid( P_PID, feeder, &feeder_exit, WEXITED | WNOWAIT ));
+    assert( 0 == ACTION_REPLAY_DYNAMIC(
+        action_replay_stoppable_t_stop_func_t,
+        stop,
+        recorder
+    )( recorder ).status );
+    assert( 0 == getrusage( RUSAGE_SELF, &after ));
+
+    io_counters_t const io_after = io_counters();
+    action_replay_recorder_t_stats_return_t stats = { 0, 0, 0, 0 };
+
+    if( EPOLL == backend )
+    {
+        action_replay_epoll_recorder_t_stats_return_t const epoll_stats =
+            action_replay_epoll_recorder_t_stats( recorder );
+
+        assert( 0 == epoll_stats.status );
+        stats.waits = epoll_stats.waits;
+    }
+    else
+    {
+        stats = action_replay_recorder_t_stats( recorder );
+        assert( 0 == stats.status );
+    }
+
+    assert( feeder == waitpid( feeder, NULL, 0 ));
+    assert( 0 == action_replay_delete( recorder ));
+    assert( 0 == action_replay_delete( ( void * ) zero_time ));
+    assert( 0 == action_replay_delete( ( void * ) now ));
+
+    struct stat output_stat;
+    uint64_t const events = ( uint64_t ) frames * ( AXES + 1 );
+
+    assert( 0 == stat( OUTPUT, &output_stat ));
+    uint64_t const reads = io_after.reads - io_before.reads;
+    uint64_t const writes = io_after.writes - io_before.writes;
+    uint64_t const waits =
+        stats.waits + stats.writer_sleeps + stats.writer_wakes;
+
+    printf(
+        "%s: %llu of %llu events recorded, per event:"
+        " %.3f syscalls (%.3f reads, %.3f writes, %.3f waits and wakeups),"
+        " %.3f voluntary context switches, %.0f ns of CPU time\n",
+        name,
+        ( unsigned long long int ) (
+            (
+                output_stat.st_size
+                - action_replay_binary_recording_records_offset(
+                    strlen( FIFO )
+                )
+            ) / sizeof( action_replay_binary_recording_record_t )
+        ),
+        ( unsigned long long int ) events,
+        ( double ) ( reads + writes + waits ) / events,
+        ( double ) reads / events,
+        ( double ) writes / events,
+        ( double ) waits / events,
+        ( double ) ( after.ru_nvcsw - before.ru_nvcsw ) / events,
+        ( double ) ( cpu_nanoseconds( &after ) - cpu_nanoseconds( &before ))
+            / events
+    );
+    assert( 0 == remove( OUTPUT ));
+}
+
+static void benchmark_backends(
+    char const * const name,
+    unsigned int const frames,
+    long int const pace
+)
+{
+    printf( "%s, %u frames of %u events\n", name, frames, AXES + 1 );
+    benchmark( "poll", ACTION_REPLAY_RECORDER_T_POLL, 0, frames, pace );
+    benchmark(
+        "poll with writer thread",
+        ACTION_REPLAY_RECORDER_T_POLL,
+        ACTION_REPLAY_RECORDER_T_RING_CAPACITY,
+        frames,
+        pace
+    );
+    benchmark(
+        "io_uring",
+        ACTION_REPLAY_RECORDER_T_IO_URING,
+        0,
+        frames,
+        pace
+    );
+    benchmark( "epoll", EPOLL, 0, frames, pace );
+}
+
+int main()
+{
+    assert( 0 == mkfifo( FIFO, 0600 ));
+    benchmark_backends( "burst", BURST_FRAMES, 0 );
+    benchmark_backends( "paced", PACED_FRAMES, PACE_NANOSECONDS );
+    assert( 0 == remove( FIFO ));
+    return 0;
+}
@@ -0,0 +1,179 @@
+#define _POSIX_C_SOURCE 200809L /* fileno */
+#define __STDC_FORMAT_MACROS
+
+#include "benchmark.h"
+#include <action_replay/assert.h>
+#include <action_replay/inttypes.h>
+#include <action_replay/nanoseconds.h>
+#include <action_replay/recorder_io.h>
+#include <action_replay/stdint.h>
+#include <linux/input.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EVENTS 10000000
+#define EDGE_CASES 6
+
+/* what recorder wrote before it got its own writer */
+static char const * const json =
+    "\n{ \"time\": %"PRIu64
+    ", \"type\": %hu, \"code\": %hu, \"value\": %d }";
+
+static struct input_event event_at(
+    uint64_t const nanoseconds,
+    uint16_t const type,
+    uint16_t const code,
+    int32_t const value
+)
+{
+    struct input_event result;
+
+    memset( &result, 0, sizeof( result ));
+    result.time.tv_sec = nanoseconds / 1000000000;
+    result.time.tv_usec = ( nanoseconds % 1000000000 ) / 1000;
+    result.type = type;
+    result.code = code;
+    result.value = value;
+    return result;
+}
+
+static void fprintf_event(
+    FILE * const restrict output,
+    struct input_event const event,
+    uint64_t * const restrict zero_time
+)
+{
+    uint64_t const event_time = event.time.tv_sec * 1000000000ULL
+        + event.time.tv_usec * 1000ULL;
+
+    fprintf(
+        output,
+        json,
+        event_time - *zero_time,
+        event.type,
+        event.code,
+        event.value
+    );
+    *zero_time = event_time;
+}
+
+static char * read_file( FILE * const file, size_t * const length )
+{
+    fseek( file, 0, SEEK_END );
+    *length = ( size_t ) ftell( file );
+    rewind( file );
+
+    char * const result = malloc( *length );
+    assert( NULL != result );
+    assert( *length == fread( result, 1, *length, file ));
+    return result;
+}
+
+static void check_identical_output( void )
+{
+    struct input_event const events[ EDGE_CASES ] =
+    {
+        event_at( 0, 0, 0, 0 ),
+        event_at( 9000, 1, 9, -1 ),
+        event_at( 1000000000, 3, 53, 2147483647 ),
+        event_at( 1000000000, 65535, 65535, -2147483647 - 1 ),
+        event_at( 18446744073000000000ULL, 4, 4, 458756 ),
+        event_at( 18446744073709551000ULL, 2, 100, -99 )
+    };
+    FILE * const expected = tmpfile();
+    FILE * const actual = tmpfile();
+    static action_replay_recorder_io_writer_t writer;
+    uint64_t expected_zero_time = 0;
+    uint64_t actual_zero_time = 0;
+
+    assert(( NULL != expected ) && ( NULL != actual ));
+    fprintf( expected, "{ \"file\": \"%s\" }", "/dev/input/event0" );
+    action_replay_recorder_io_writer_init(
+        &writer,
+        fileno( actual ),
+        ACTION_REPLAY_RECORDER_IO_JSON
+    );
+    assert( 0 == action_replay_recorder_io_write_header(
+        "/dev/input/event0",
+        &writer
+    ));
+    for( unsigned int i = 0; i < EDGE_CASES; ++i )
+    {
+        fprintf_event( expected, events[ i ], &expected_zero_time );
+        assert( 0 == action_replay_recorder_io_write_event(
+            events[ i ],
+            &actual_zero_time,
+            &writer
+        ));
+    }
+    assert( 0 == fflush( expected ));
+    assert( 0 == action_replay_recorder_io_writer_flush( &writer ));
+
+    size_t expected_length;
+    size_t actual_length;
+    char * const expected_buffer = read_file( expected, &expected_length );
+    char * const actual_buffer = read_file( actual, &actual_length );
+
+    assert( expected_length == actual_length );
+    assert( 0 == memcmp( expected_buffer, actual_buffer, actual_length ));
+    free( expected_buffer );
+    free( actual_buffer );
+    fclose( expected );
+    fclose( actual );
+}
+
+int main()
+{
+    check_identical_output();
+
+    FILE * const output = fopen( "/dev/null", "w" );
+    assert( NULL != output );
+
+    static action_replay_recorder_io_writer_t writer;
+    struct input_event event = event_at( 0, EV_ABS, ABS_X, 0 );
+    uint64_t zero_time = 0;
+    uint64_t start;
+
+    start = action_replay_nanoseconds_monotonic_now();
+    for( unsigned int i = 0; i < EVENTS; ++i )
+    {
+        event.time.tv_usec = i % 1000000;
+        event.value = ( int32_t ) i - EVENTS / 2;
+        zero_time = 0;
+        fprintf_event( output, event, &zero_time );
+    }
+    fflush( output );
+
+    double const fprintf_seconds = benchmark_seconds_since( start );
+
+    action_replay_recorder_io_writer_init(
+        &writer,
+        fileno( output ),
+        ACTION_REPLAY_RECORDER_IO_JSON
+    );
+    start = action_replay_nanoseconds_monotonic_now();
+    for( unsigned int i = 0; i < EVENTS; ++i )
+    {
+        event.time.tv_usec = i % 1000000;
+        event.value = ( int32_t ) i - EVENTS / 2;
+        zero_time = 0;
+        assert( 0 == action_replay_recorder_io_write_event(
+            event,
+            &zero_time,
+            &writer
+        ));
+    }
+    assert( 0 == action_replay_recorder_io_writer_flush( &writer ));
+
+    double const writer_seconds = benchmark_seconds_since( start );
+
+    printf(
+        "fprintf: %.0f events/s\n"
+        "writer:  %.0f events/s\n",
+        EVENTS / fprintf_seconds,
+        EVENTS / writer_seconds
+    );
+    fclose( output );
+    return 0;
+}
@@ -20,7 +20,13 @@ int main(int argc, char ** args)
     assert( 0 == action_replay_log_init( stderr ).status );
     action_replay_recorder_t * recorder = action_replay_new(
         action_replay_recorder_t_class(),
-        action_replay_recorder_t_args( args[ 1 ], args[ 2 ] )
+        action_replay_recorder_t_args(
+            args[ 1 ],
+            args[ 2 ],
+            ACTION_REPLAY_RECORDER_IO_JSON,
+            ACTION_REPLAY_RECORDER_T_RING_CAPACITY,
+            ACTION_REPLAY_RECORDER_T_POLL
+        )
     );
     assert( NULL != recorder );
     action_replay_time_t * const zero_time = action_replay_new(
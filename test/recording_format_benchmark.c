@@ -0,0 +1,132 @@
+#define _POSIX_C_SOURCE 200809L /* stat, fileno */
+
+#include "benchmark.h"
+#include <action_replay/assert.h>
+#include <action_replay/nanoseconds.h>
+#include <action_replay/object_oriented_programming.h>
+#include <action_replay/player.h>
+#include <action_replay/recorder_io.h>
+#include <action_replay/stdint.h>
+#include <action_replay/time.h>
+#include <action_replay/time_converter.h>
+#include <linux/input.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+#define EVENTS 1000000
+
+static double write_recording(
+    char const * const restrict path,
+    char const * const restrict path_to_output_device,
+    action_replay_recorder_io_format_t const format
+)
+{
+    static action_replay_recorder_io_writer_t writer;
+    FILE * const output = fopen( path, "w" );
+    assert( NULL != output );
+    action_replay_recorder_io_writer_init( &writer, fileno( output ), format );
+    assert( 0 == action_replay_recorder_io_write_header(
+        path_to_output_device,
+        &writer
+    ));
+
+    /* all events at zero time, so replay doesn't sleep */
+    struct input_event event = { { 0, 0 }, EV_ABS, ABS_X, 0 };
+    uint64_t zero_time = 0;
+    uint64_t const start = action_replay_nanoseconds_monotonic_now();
+
+    for( unsigned int i = 0; i < EVENTS; ++i )
+    {
+        event.value = ( int32_t ) i;
+        assert( 0 == action_replay_recorder_io_write_event(
+            event,
+            &zero_time,
+            &writer
+        ));
+    }
+    assert( 0 == action_replay_recorder_io_writer_flush( &writer ));
+    assert( 0 == fclose( output ));
+    return benchmark_seconds_since( start );
+}
+
+static double replay_recording( char const * const path )
+{
+    action_replay_time_converter_t * const now = action_replay_new(
+        action_replay_time_converter_t_class(),
+        action_replay_time_converter_t_args(
+            action_replay_time_converter_t_now()
+        )
+    );
+    assert( NULL != now );
+    action_replay_time_t * const zero_time = action_replay_new(
+        action_replay_time_t_class(),
+        action_replay_time_t_args( now )
+    );
+    assert( NULL != zero_time );
+
+    uint64_t const start = action_replay_nanoseconds_monotonic_now();
+    action_replay_player_t * const player = action_replay_new(
+        action_replay_player_t_class(),
+        action_replay_player_t_args( path, false )
+    );
+    assert( NULL != player );
+    assert( 0 == ( player->start(
+        ( void * const ) player,
+        action_replay_player_t_start_state( zero_time, 0, false, 0 )
+    )).status );
+    assert( 0 == player->join( player ).status );
+    assert( 0 == action_replay_delete( ( void * ) player ));
+
+    double const result = benchmark_seconds_since( start );
+
+    assert( 0 == action_replay_delete( ( void * ) zero_time ));
+    assert( 0 == action_replay_delete( ( void * ) now ));
+    return result;
+}
+
+static void benchmark(
+    char const * const restrict name,
+    char const * const restrict path,
+    char const * const restrict path_to_output_device,
+    action_replay_recorder_io_format_t const format
+)
+{
+    double const write = write_recording(
+        path,
+        path_to_output_device,
+        format
+    );
+    double const replay = replay_recording( path );
+    struct stat path_stat;
+
+    assert( 0 == stat( path, &path_stat ));
+    printf(
+        "%s: %lld bytes, write %.0f events/s, replay %.0f events/s\n",
+        name,
+        ( long long int ) path_stat.st_size,
+        EVENTS / write,
+        EVENTS / replay
+    );
+    assert( 0 == remove( path ));
+}
+
+int main( int argc, char ** args )
+{
+    /* replayed events are thrown away unless a device is given */
+    char const * const path_to_output_device =
+        ( 1 < argc ) ? args[ 1 ] : "/dev/null";
+
+    benchmark(
+        "json",
+        "recording_format_benchmark.json",
+        path_to_output_device,
+        ACTION_REPLAY_RECORDER_IO_JSON
+    );
+    benchmark(
+        "binary",
+        "recording_format_benchmark.bin",
+        path_to_output_device,
+        ACTION_REPLAY_RECORDER_IO_BINARY
+    );
+    return 0;
+}
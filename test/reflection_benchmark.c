@@ -0,0 +1,62 @@
+#define _POSIX_C_SOURCE 199309L /* clock_gettime */
+
+#include "benchmark.h"
+#include <action_replay/assert.h>
+#include <action_replay/class.h>
+#include <action_replay/nanoseconds.h>
+#include <action_replay/object_oriented_programming.h>
+#include <action_replay/time.h>
+#include <action_replay/time_converter.h>
+#include <stdio.h>
+
+#define ITERATIONS 10000000
+
+int main()
+{
+    action_replay_time_converter_t * const converter = action_replay_new(
+        action_replay_time_converter_t_class(),
+        action_replay_time_converter_t_args( 0 )
+    );
+    assert( NULL != converter );
+    action_replay_time_t * const time = action_replay_new(
+        action_replay_time_t_class(),
+        action_replay_time_t_args( converter )
+    );
+    assert( NULL != time );
+
+    /* stringified same way ACTION_REPLAY_DYNAMIC does it */
+    char const * const type = "action_replay_time_t_func_t";
+    char const * const name = "sub";
+    action_replay_class_t const * const _class = time->_class;
+    size_t volatile sink = 0;
+    uint64_t start;
+
+    start = action_replay_nanoseconds_monotonic_now();
+    for( unsigned int i = 0; i < ITERATIONS; ++i )
+    { sink += _class->reflector( type, name ).offset; }
+
+    double const uncached = benchmark_seconds_since( start );
+
+    start = action_replay_nanoseconds_monotonic_now();
+    for( unsigned int i = 0; i < ITERATIONS; ++i )
+    {
+        sink += ( size_t ) ACTION_REPLAY_DYNAMIC(
+            action_replay_time_t_func_t,
+            sub,
+            time
+        );
+    }
+
+    double const cached = benchmark_seconds_since( start );
+
+    printf(
+        "reflector: %.0f accesses/s\n"
+        "cached:    %.0f accesses/s\n",
+        ITERATIONS / uncached,
+        ITERATIONS / cached
+    );
+
+    assert( 0 == action_replay_delete( ( void * ) time ));
+    assert( 0 == action_replay_delete( ( void * ) converter ));
+    return 0;
+}
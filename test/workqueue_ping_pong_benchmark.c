@@ -0,0 +1,112 @@
+#include <action_replay/assert.h>
+#include <action_replay/inttypes.h>
+#include <action_replay/nanoseconds.h>
+#include <action_replay/object_oriented_programming.h>
+#include <action_replay/stdint.h>
+#include <action_replay/workqueue.h>
+#include <opa_primitives.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/*
+ * one item at a time, put only once previous one ran,
+ * so each put finds processing thread idle
+ */
+#define ROUNDS 200000
+#define SPINS_BEFORE_YIELD 1000
+
+typedef struct {
+    uint64_t put; /* before put() */
+    uint64_t latencies[ ROUNDS ]; /* put() to payload start */
+    OPA_int_t ran;
+} ping_pong_t;
+
+static ping_pong_t ping_pong;
+static unsigned int spins_before_yield;
+
+static void pong( void * const state )
+{
+    ping_pong_t * const ping = state;
+    int const round = OPA_load_int( &( ping->ran ));
+
+    ping->latencies[ round ] =
+        action_replay_nanoseconds_monotonic_now() - ping->put;
+    OPA_store_release_int( &( ping->ran ), round + 1 );
+}
+
+static void wait_for( int const target )
+{
+    for(
+        unsigned int spins = 0;
+        target != OPA_load_acquire_int( &( ping_pong.ran ));
+        ++spins
+    )
+    {
+        if( spins_before_yield > spins ) { OPA_busy_wait(); }
+        else { sched_yield(); }
+    }
+}
+
+static int compare( void const * const a, void const * const b )
+{
+    uint64_t const left = * ( uint64_t const * ) a;
+    uint64_t const right = * ( uint64_t const * ) b;
+
+    return ( left > right ) - ( left < right );
+}
+
+static void benchmark(
+    char const * const name,
+    action_replay_workqueue_t_backend_t const backend
+)
+{
+    action_replay_workqueue_t * const queue = action_replay_new(
+        action_replay_workqueue_t_class(),
+        action_replay_workqueue_t_args(
+            backend,
+            ACTION_REPLAY_WORKQUEUE_T_RING_CAPACITY,
+            1
+        )
+    );
+
+    assert( NULL != queue );
+    assert( 0 == queue->start( queue ).status );
+    OPA_store_int( &( ping_pong.ran ), 0 );
+
+    uint64_t const start = action_replay_nanoseconds_monotonic_now();
+
+    for( int round = 0; round < ROUNDS; ++round )
+    {
+        ping_pong.put = action_replay_nanoseconds_monotonic_now();
+        assert( 0 == queue->put( queue, pong, &ping_pong ).status );
+        wait_for( round + 1 );
+    }
+
+    double const seconds =
+        ( action_replay_nanoseconds_monotonic_now() - start ) / 1e9;
+
+    assert( 0 == queue->join( queue ).status );
+    assert( 0 == action_replay_delete( ( void * ) queue ));
+    qsort( ping_pong.latencies, ROUNDS, sizeof( uint64_t ), compare );
+    printf(
+        "%s: %.0f round trips/s, put to run median %" PRIu64
+        " ns, 99%% %" PRIu64 " ns\n",
+        name,
+        ROUNDS / seconds,
+        ping_pong.latencies[ ROUNDS / 2 ],
+        ping_pong.latencies[ ROUNDS / 100 * 99 ]
+    );
+}
+
+int main()
+{
+    /* with one CPU, processing thread only runs once we yield */
+    spins_before_yield =
+        ( 1 < sysconf( _SC_NPROCESSORS_ONLN )) ? SPINS_BEFORE_YIELD : 0;
+    benchmark( "locked", ACTION_REPLAY_WORKQUEUE_T_LOCKED );
+    benchmark( "spsc", ACTION_REPLAY_WORKQUEUE_T_SPSC );
+    benchmark( "pool of 1", ACTION_REPLAY_WORKQUEUE_T_POOL );
+    return 0;
+}
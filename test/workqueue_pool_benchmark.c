@@ -0,0 +1,180 @@
+#include <action_replay/assert.h>
+#include <action_replay/nanoseconds.h>
+#include <action_replay/object_oriented_programming.h>
+#include <action_replay/stdint.h>
+#include <action_replay/workqueue.h>
+#include <stdio.h>
+#include <unistd.h>
+
+/* CPU-bound items on pools of 1 to 16 threads */
+#define ITEMS 20000
+#define PUTS_PER_BATCH 64
+#define WORK_ROUNDS 20000
+/* binary tree of items, each putting its two children from the pool */
+#define TREE_ITEMS (( 1 << 15 ) - 1 )
+#define KEYS 64
+#define MAX_THREADS 16
+
+typedef struct {
+    uint64_t result;
+    unsigned int index;
+    unsigned int * next; /* key's index expected to run next */
+} work_t;
+
+static work_t works[ ITEMS > TREE_ITEMS ? ITEMS : TREE_ITEMS ];
+static unsigned int next[ KEYS ];
+static action_replay_workqueue_t * queue;
+
+static uint64_t work( uint64_t x )
+{
+    for( unsigned int i = 0; i < WORK_ROUNDS; ++i )
+    {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+    }
+
+    return x;
+}
+
+static void independent( void * const state )
+{
+    work_t * const item = state;
+
+    item->result = work( item->index + 1 );
+}
+
+static void spawn( void * const state )
+{
+    work_t * const item = state;
+    unsigned int const child = 2 * item->index + 1;
+
+    item->result = work( item->index + 1 );
+    if( TREE_ITEMS > child )
+    {
+        void * const children[] = { works + child, works + child + 1 };
+
+        assert( 0 == queue->put_many( queue, spawn, children, 2 ).status );
+    }
+}
+
+static void keyed( void * const state )
+{
+    work_t * const item = state;
+
+    assert( item->index / KEYS == * ( item->next ));
+    ++( * ( item->next ));
+    item->result = work( item->index + 1 );
+}
+
+static double run(
+    unsigned int const threads,
+    void ( * const put )( void )
+)
+{
+    queue = action_replay_new(
+        action_replay_workqueue_t_class(),
+        action_replay_workqueue_t_args(
+            ACTION_REPLAY_WORKQUEUE_T_POOL,
+            ACTION_REPLAY_WORKQUEUE_T_RING_CAPACITY,
+            threads
+        )
+    );
+    assert( NULL != queue );
+    assert( 0 == queue->start( queue ).status );
+
+    uint64_t const start = action_replay_nanoseconds_monotonic_now();
+
+    put();
+    assert( 0 == queue->join( queue ).status );
+
+    double const seconds =
+        ( action_replay_nanoseconds_monotonic_now() - start ) / 1e9;
+
+    assert( 0 == action_replay_delete( ( void * ) queue ));
+    return seconds;
+}
+
+static void put_independent( void )
+{
+    static void * states[ PUTS_PER_BATCH ];
+
+    for( unsigned int i = 0; i < ITEMS; i += PUTS_PER_BATCH )
+    {
+        unsigned int const count =
+            ( ITEMS - i < PUTS_PER_BATCH ) ? ITEMS - i : PUTS_PER_BATCH;
+
+        for( unsigned int j = 0; j < count; ++j )
+        {
+            works[ i + j ].index = i + j;
+            states[ j ] = works + i + j;
+        }
+        assert( 0 == queue->put_many(
+            queue,
+            independent,
+            states,
+            count
+        ).status );
+    }
+}
+
+static void put_tree( void )
+{
+    for( unsigned int i = 0; i < TREE_ITEMS; ++i ) { works[ i ].index = i; }
+    assert( 0 == queue->put( queue, spawn, works ).status );
+}
+
+static void put_keyed( void )
+{
+    for( unsigned int key = 0; key < KEYS; ++key ) { next[ key ] = 0; }
+    for( unsigned int i = 0; i < ITEMS; ++i )
+    {
+        works[ i ].index = i;
+        works[ i ].next = next + i % KEYS;
+        assert( 0 == queue->put_ordered(
+            queue,
+            i % KEYS,
+            keyed,
+            works + i
+        ).status );
+    }
+}
+
+int main()
+{
+    double first[ 3 ] = { 0 };
+
+    printf( "%ld online CPUs\n", sysconf( _SC_NPROCESSORS_ONLN ));
+    puts(
+        "threads  independent/s  speedup  tree/s  speedup"
+        "  keyed/s  speedup"
+    );
+    for( unsigned int threads = 1; threads <= MAX_THREADS; threads *= 2 )
+    {
+        double const seconds[ 3 ] = {
+            run( threads, put_independent ),
+            run( threads, put_tree ),
+            run( threads, put_keyed )
+        };
+
+        for( unsigned int key = 0; key < KEYS; ++key )
+        { assert( ITEMS / KEYS + ( ITEMS % KEYS > key ) == next[ key ] ); }
+        if( 1 == threads )
+        {
+            for( unsigned int i = 0; i < 3; ++i )
+            { first[ i ] = seconds[ i ]; }
+        }
+        printf(
+            "%7u  %13.0f  %7.2f  %6.0f  %7.2f  %7.0f  %7.2f\n",
+            threads,
+            ITEMS / seconds[ 0 ],
+            first[ 0 ] / seconds[ 0 ],
+            TREE_ITEMS / seconds[ 1 ],
+            first[ 1 ] / seconds[ 1 ],
+            ITEMS / seconds[ 2 ],
+            first[ 2 ] / seconds[ 2 ]
+        );
+    }
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include <action_replay/assert.h>
+#include <action_replay/nanoseconds.h>
+#include <action_replay/object_oriented_programming.h>
+#include <action_replay/stdint.h>
+#include <action_replay/workqueue.h>
+#include <opa_primitives.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* puts of an empty payload, in rounds so caller's items can be reused */
+#define PUTS 4000000
+#define ITEMS_PER_ROUND 4096
+#define PUTS_PER_BATCH 64
+#define REPEATS 3
+
+typedef enum { PUT, PUT_ITEM, PUT_MANY, PUT_MANY_ITEMS } put_t;
+
+static OPA_int_t ran = OPA_INT_T_INITIALIZER( 0 );
+
+static void count( void * const state )
+{
+    ( void ) state;
+    OPA_store_release_int( &ran, OPA_load_int( &ran ) + 1 );
+}
+
+static void wait_for( int const target )
+{ while( target != OPA_load_acquire_int( &ran )) { sched_yield(); } }
+
+static double benchmark( put_t const put_type )
+{
+    static action_replay_workqueue_t_item_t items[ ITEMS_PER_ROUND ];
+    static void * states[ PUTS_PER_BATCH ];
+    action_replay_workqueue_t * const queue = action_replay_new(
+        action_replay_workqueue_t_class(),
+        action_replay_workqueue_t_args(
+            ACTION_REPLAY_WORKQUEUE_T_LOCKED,
+            ACTION_REPLAY_WORKQUEUE_T_RING_CAPACITY,
+            1
+        )
+    );
+
+    assert( NULL != queue );
+    assert( 0 == queue->start( queue ).status );
+    OPA_store_int( &ran, 0 );
+
+    uint64_t const start = action_replay_nanoseconds_monotonic_now();
+
+    for( int put = 0; put < PUTS; put += ITEMS_PER_ROUND )
+    {
+        for( int i = 0; i < ITEMS_PER_ROUND; ++i )
+        {
+            if( PUT_MANY == put_type )
+            {
+                if( 0 != i % PUTS_PER_BATCH ) { continue; }
+                assert( 0 == queue->put_many(
+                    queue,
+                    count,
+                    states,
+                    PUTS_PER_BATCH
+                ).status );
+                continue;
+            }
+            if( PUT_MANY_ITEMS == put_type )
+            {
+                if( 0 != i % PUTS_PER_BATCH ) { continue; }
+                assert( 0 == queue->put_many_items(
+                    queue,
+                    items + i,
+                    count,
+                    states,
+                    PUTS_PER_BATCH
+                ).status );
+                continue;
+            }
+            assert( 0 == (( PUT_ITEM == put_type )
+                ? queue->put_item( queue, items + i, count, NULL )
+                : queue->put( queue, count, NULL )
+            ).status );
+        }
+        wait_for( put + ITEMS_PER_ROUND );
+    }
+
+    double const seconds =
+        ( action_replay_nanoseconds_monotonic_now() - start ) / 1e9;
+
+    assert( 0 == queue->join( queue ).status );
+    assert( 0 == action_replay_delete( ( void * ) queue ));
+    return seconds;
+}
+
+int main()
+{
+    for( unsigned int i = 0; i < REPEATS; ++i )
+    {
+        double const allocated = benchmark( PUT );
+        double const intrusive = benchmark( PUT_ITEM );
+        double const batched = benchmark( PUT_MANY );
+        double const batched_intrusive = benchmark( PUT_MANY_ITEMS );
+
+        printf(
+            "put: %.2f M puts/s, put_item: %.2f M puts/s,"
+            " put_many: %.2f M puts/s, put_many_items: %.2f M puts/s\n",
+            PUTS / allocated / 1e6,
+            PUTS / intrusive / 1e6,
+            PUTS / batched / 1e6,
+            PUTS / batched_intrusive / 1e6
+        );
+    }
+
+    return 0;
+}
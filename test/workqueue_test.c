@@ -2,6 +2,8 @@
 #include <action_replay/log.h>
 #include <action_replay/object_oriented_programming.h>
 #include <action_replay/workqueue.h>
+#include <opa_primitives.h>
+#include <sched.h>
 #include <stdio.h>
 #include <unistd.h>
 
@@ -40,12 +42,60 @@ static void print_five( void * const state )
     sleep( 1 );
 }
 
-int main()
+static void count( void * const state )
+{ OPA_incr_int( state ); }
+
+/* ring smaller than puts, so producer has to wait for room */
+#define RING_CAPACITY 2
+#define BATCH 10
+#define THREADS 4
+#define KEYS 3
+#define ORDERED 100
+
+typedef struct {
+    unsigned int * next; /* key's index expected to run next */
+    unsigned int index;
+} ordered_t;
+
+static void check_order( void * const state )
+{
+    ordered_t const * const ordered = state;
+
+    assert( ordered->index == * ( ordered->next ));
+    ++( * ( ordered->next ));
+}
+
+static action_replay_workqueue_t * late_wq;
+static OPA_int_t late_started;
+
+/* runs while stop() waits for it, other threads have quit by then */
+static void put_late( void * const state )
+{
+    OPA_store_int( &late_started, 1 );
+    sleep( 1 );
+    for( size_t key = 0; key < THREADS; ++key )
+    {
+        assert( 0 == late_wq->put_ordered(
+            late_wq,
+            key,
+            count,
+            state
+        ).status );
+    }
+}
+
+static void run(
+    action_replay_workqueue_t_backend_t const backend,
+    unsigned int const threads
+)
 {
-    assert( 0 == action_replay_log_init( stderr ).status );
     action_replay_workqueue_t * wq = action_replay_new(
         action_replay_workqueue_t_class(),
-        action_replay_workqueue_t_args()
+        action_replay_workqueue_t_args(
+            backend,
+            RING_CAPACITY,
+            threads
+        )
     );
     assert( NULL != wq );
     assert( 0 == wq->start( wq ).status );
@@ -62,12 +112,121 @@ int main()
     puts( "test with empty workqueue" );
     wq = action_replay_new(
         action_replay_workqueue_t_class(),
-        action_replay_workqueue_t_args()
+        action_replay_workqueue_t_args(
+            backend,
+            RING_CAPACITY,
+            threads
+        )
     );
     assert( 0 == wq->start( wq ).status );
     assert( 0 == action_replay_delete( ( void * ) wq ));
+    puts( "test batch larger than ring" );
+
+    OPA_int_t counted;
+    void * states[ BATCH ];
+
+    OPA_store_int( &counted, 0 );
+    for( unsigned int i = 0; i < BATCH; ++i ) { states[ i ] = &counted; }
+    wq = action_replay_new(
+        action_replay_workqueue_t_class(),
+        action_replay_workqueue_t_args(
+            backend,
+            RING_CAPACITY,
+            threads
+        )
+    );
+    assert( 0 == wq->start( wq ).status );
+    assert( 0 == wq->put_many( wq, count, states, BATCH ).status );
+    assert( 0 == wq->join( wq ).status );
+    assert( BATCH == OPA_load_int( &counted ));
+    assert( 0 == action_replay_delete( ( void * ) wq ));
+    puts( "test batch into caller's items" );
+
+    static action_replay_workqueue_t_item_t items[ BATCH ];
+
+    OPA_store_int( &counted, 0 );
+    wq = action_replay_new(
+        action_replay_workqueue_t_class(),
+        action_replay_workqueue_t_args(
+            backend,
+            RING_CAPACITY,
+            threads
+        )
+    );
+    assert( 0 == wq->start( wq ).status );
+    assert( 0 == wq->put_many_items(
+        wq,
+        items,
+        count,
+        states,
+        BATCH
+    ).status );
+    assert( 0 == wq->join( wq ).status );
+    assert( BATCH == OPA_load_int( &counted ));
+    assert( 0 == action_replay_delete( ( void * ) wq ));
+    puts( "test items with the same key run in order" );
+
+    static ordered_t ordered[ KEYS * ORDERED ];
+    unsigned int next[ KEYS ] = { 0 };
+
+    wq = action_replay_new(
+        action_replay_workqueue_t_class(),
+        action_replay_workqueue_t_args(
+            backend,
+            RING_CAPACITY,
+            threads
+        )
+    );
+    assert( 0 == wq->start( wq ).status );
+    for( unsigned int i = 0; i < KEYS * ORDERED; ++i )
+    {
+        ordered[ i ].next = next + i % KEYS;
+        ordered[ i ].index = i / KEYS;
+        assert( 0 == wq->put_ordered(
+            wq,
+            i % KEYS,
+            check_order,
+            ordered + i
+        ).status );
+    }
+    assert( 0 == wq->join( wq ).status );
+    for( unsigned int key = 0; key < KEYS; ++key )
+    { assert( ORDERED == next[ key ] ); }
+    assert( 0 == action_replay_delete( ( void * ) wq ));
+}
+
+int main()
+{
+    assert( 0 == action_replay_log_init( stderr ).status );
+    run( ACTION_REPLAY_WORKQUEUE_T_LOCKED, 1 );
+    puts( "test with single producer ring" );
+    run( ACTION_REPLAY_WORKQUEUE_T_SPSC, 1 );
+    puts( "test with pool of threads" );
+    run( ACTION_REPLAY_WORKQUEUE_T_POOL, THREADS );
+    puts( "test pool drops items put while stopping" );
+
+    OPA_int_t counted;
+
+    OPA_store_int( &counted, 0 );
+    late_wq = action_replay_new(
+        action_replay_workqueue_t_class(),
+        action_replay_workqueue_t_args(
+            ACTION_REPLAY_WORKQUEUE_T_POOL,
+            RING_CAPACITY,
+            THREADS
+        )
+    );
+    assert( NULL != late_wq );
+    assert( 0 == late_wq->start( late_wq ).status );
+    assert( 0 == late_wq->put( late_wq, put_late, &counted ).status );
+    while( 0 == OPA_load_int( &late_started )) { sched_yield(); }
+    assert( 0 == late_wq->stop( late_wq ).status );
+    assert( 0 == late_wq->start( late_wq ).status );
+    assert( 0 == late_wq->put( late_wq, count, &counted ).status );
+    assert( 0 == late_wq->join( late_wq ).status );
+    assert( 1 == OPA_load_int( &counted ));
+    assert( 0 == action_replay_delete( ( void * ) late_wq ));
     puts( "test passed" );
     assert( 0 == action_replay_log_close().status );
     return 0;
 }
-